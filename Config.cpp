@@ -110,6 +110,9 @@ STATE CFGSdHotSwapTask(void)
                         Serial.println(fr, 10);
                     }
 
+                    // storage locations have changed
+                    respCacheVersion++;
+
                     state = CFGUSBInserted;
                 }
                 break;
@@ -123,6 +126,7 @@ STATE CFGSdHotSwapTask(void)
 
                     // SD card removed
                     Serial.println("SD card removed");
+                    respCacheVersion++;
 
                     state = Idle;
                 }
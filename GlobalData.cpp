@@ -35,7 +35,11 @@ bool fModeJSON = false;
 // the JSON command structure
 PJCMD pjcmd = PJCMD();
 UICMD uicmd = UICMD();
-OSPAR oslex = OSPAR();
+OSPAR rgOSPar[COSPAR];
+OSPAR& oslex = rgOSPar[0];
+
+// bumped when something a cached response depends on changes; 0 is never current
+uint32_t respCacheVersion = 1;
 
 /************************************************************************/
 /*    block IO                                                          */
@@ -115,6 +119,7 @@ static const HINSTR hDLOG1 = HINSTRFromInstr(dlog1Data);
 DFILE                   dGFile;              // Create a File handle to use to open files with
 DFILE                   dLFile1;             // Create a File handle to use with Logging
 DFILE                   dLFile2;             // Create a File handle to use with Logging
+DFILE                   dLFile3;             // Create a File handle to use with digital Logging
 
 static const INSTR_ATT  rgUsage[INSTR_END_ID]       = {instrIDNone, instrIDCal,  instrIDCal, instrIDCal, instrIDCal, instrIDCalSrc, instrIDCal,     instrIDCalSrc,  instrIDNone,    instrIDNone,    instrIDNone,    instrIDNone};
 const HINSTR            rgInstr[INSTR_END_ID]       = {NULL,        hDC1Volt,    hDC2Volt,   hAWG,       hOSC1,      hDC1Volt,      hOSC2,          hDC2Volt,       hLA,            hALOG1,         hALOG2,         hDLOG1};
@@ -281,6 +281,12 @@ STATE InitInstruments(void)
   
     // Turn on the pullup for the SD DET
     CNPUDbits.CNPUD1 = 1;
+
+    // SD sector transfers are DMA driven; DCH2 drains the receive buffer
+    // and DCH1 is shared with the serial transmit, only taken when it is idle.
+    // While a sector is moving, keep the network stack serviced.
+    dSDSpi.setDMA(&DCH1CON, &DCH2CON);
+    dSDVol.setYield(DEIPcK::periodicTasks);
     
     //**************************************************************************
     //***************************  MRF24 SPI Port  *****************************
@@ -867,6 +873,9 @@ STATE InitInstruments(void)
     IPC35bits.DMA6IP    = 4;
     IPC35bits.DMA6IS    = 0;
 
+    IPC35bits.DMA7IP    = 4;
+    IPC35bits.DMA7IS    = 0;
+
     // slow Log sample timers
     IPC6bits.T5IP       = 5;
     IPC6bits.T5IS       = 0;
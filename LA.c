@@ -13,6 +13,7 @@
 /*  Revision History:                                                   */
 /*                                                                      */
 /*    3/20/2017 (KeithV): Created                                        */
+/*    10/19/2026 (KeithV): Added the digital data logger                */
 /************************************************************************/
 #include <OpenScope.h>
 
@@ -92,7 +93,8 @@ STATE LAReset(HINSTR hLA)
 {
     LA * pLA = (LA *) hLA;
     
-    if(IsLALocked())
+    // a running digital logger owns the timer and DMA
+    if(IsLALocked() && !IsDLOGRunning())
     {
         T7CONbits.ON        = 0;                // turn off trigger timer
         DCH7CONbits.CHEN    = 0;                // turn off DMA
@@ -108,4 +110,137 @@ STATE LAReset(HINSTR hLA)
     return(Idle);
 }
 
+//**************************************************************************
+//**************************************************************************
+//*******************    Digital Data Logger       *************************
+//**************************************************************************
+//**************************************************************************
 
+// The digital logger uses the LA timer and DMA, but runs the DMA 
+// circularly with a roll interrupt so we know how many samples have 
+// been taken; just like the analog logger.
+STATE DLOGRun(IDLOG * pidlog)
+{
+    DLOG *  pDLOG;
+    LA *    pLA;
+    
+    ASSERT(pidlog != NULL);
+
+    pDLOG   = (DLOG *) rgInstr[pidlog->id];
+    pLA     = (LA *) pDLOG->pla;
+
+    if(!(pDLOG->comhdr.activeFunc == DLogFnRun || pDLOG->comhdr.activeFunc == SMFnNone))
+    {
+        return (Waiting);
+    }
+
+    switch(pDLOG->comhdr.state)
+    {
+        case Idle:
+
+            pDLOG->comhdr.activeFunc        = DLogFnRun;
+
+            // turn off the sampler and DMA
+            pLA->pTMR->TxCON.ON             = 0;
+            pLA->pDMA->DCHxCON.CHEN         = 0;
+            while(pLA->pDMA->DCHxCON.CHBUSY);
+            IEC4CLR                         = _IEC4_DMA7IE_MASK;    // clear the roll interrupt
+            IFS4CLR                         = _IFS4_DMA7IF_MASK;    // clear the flag    
+
+            // DMA setup, this is shared with the AWG, so we have to set it up each time
+            LockLA();
+            pLA->pDMA->DCHxDSIZ             = pLA->cbDst;       // destination size of our target buffer
+            pLA->pDMA->DCHxSSA              = pLA->addPhySrc;   // physical address of the source PORT E
+            pLA->pDMA->DCHxSSIZ             = 2;                // how many bytes (not items) of the source buffer
+            pLA->pDMA->DCHxINTClr           = 0xFFFFFFFF;       // clear all interrupts   
+            pLA->pDMA->DCHxINT.CHBCIE       = 1;                // say we want Channel Block Transfer Complete set
+
+            pLA->pTMR->PRx                  = PeriodToPRx(pidlog->bidx.tmrPeriod);
+            pLA->pTMR->TxCON.TCKPS          = pidlog->bidx.tmrPreScalar;
+            pLA->pTMR->TMRx                 = 0;
+
+             // number of rolls the DMA block transfer had
+            pidlog->bidx.cTotalSamples      = 0;    // total number of samples taken
+            pidlog->bidx.iDMAEnd            = 0;    // Logging: end of valid data in DMA buffer
+            pidlog->bidx.iDMAStart          = 0;    // Logging: start of unsaved samples in DMA buffer
+            pidlog->bidx.cDMARoll           = 0;    // Logging, this is the roll count
+            pidlog->bidx.cSavedRoll         = 0;    // Logging, this is the saved roll count
+
+            // enable the roll interrupt and start sampling
+            IEC4SET                         = _IEC4_DMA7IE_MASK;
+            pLA->pDMA->DCHxCON.CHEN         = 1;
+            pLA->pTMR->TxCON.ON             = 1;
+
+            // add in how long to run, -1 means never stop
+            if(pidlog->maxSamples > 0)
+            {
+                TOInstrumentAdd(GetPicoSec(pidlog->maxSamples, pidlog->bidx.xsps, 1000000), pidlog->id);
+                TOStart();
+            }
+
+            pDLOG->comhdr.state             = Armed;
+            break;
+
+        case Armed:
+            if(!pLA->pTMR->TxCON.ON)
+            {
+                // turn off the DMA channel
+                pLA->pDMA->DCHxCON.CHEN     = 0;
+                while(pLA->pDMA->DCHxCON.CHBUSY);
+
+                // clear the roll interrupt
+                IEC4CLR                     = _IEC4_DMA7IE_MASK;
+                IFS4CLR                     = _IFS4_DMA7IF_MASK;
+                pLA->pDMA->DCHxINTClr       = 0xFFFFFFFF;
+
+                // set the DMA completion pointer
+                pidlog->bidx.iDMAEnd        = pLA->pDMA->DCHxDPTR / sizeof(uint16_t);
+
+                // give the DMA back to the AWG, we must not be running for LAReset to release it
+                pDLOG->comhdr.state         = Idle;
+                pDLOG->comhdr.activeFunc    = SMFnNone;  
+                LAReset((HINSTR) pLA);
+            }
+            break;
+
+        default:
+            ASSERT(NEVER_SHOULD_GET_HERE);
+            break;
+    }
+
+    return(pDLOG->comhdr.state);
+}
+
+STATE DLOGStop(IDLOG * pidlog)
+{
+    DLOG *  pDLOG;
+   
+    ASSERT(pidlog != NULL);
+
+    pDLOG   = (DLOG *) rgInstr[pidlog->id];
+
+    if(pDLOG->comhdr.state == Armed && pDLOG->pla->pTMR->TxCON.ON)
+    {
+        // if it is in the timer list, clear it from the timer list
+        TONullInstrument(pidlog->id);
+
+        // turn off the sampler, the run state machine will clean up
+        pDLOG->pla->pTMR->TxCON.ON = 0;
+
+        pidlog->stcd          = STCDForce;
+
+        return(Idle);
+    }
+
+    return(InstrumentNotArmed);
+}
+
+void __attribute__((nomips16, at_vector(_DMA7_VECTOR),interrupt(IPL4SRS))) DLog1RollISR(void)
+{
+    // clear the IF flag
+    IFS4CLR     = _IFS4_DMA7IF_MASK;
+    DCH7INTCLR  = _DCH7INT_CHBCIF_MASK;
+
+    // say we rolled.
+    pjcmd.iDLog1.bidx.cDMARoll++; 
+}
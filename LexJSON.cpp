@@ -10,6 +10,7 @@
 /************************************************************************/
 /*  Revision History:                                                   */
 /*    7/11/2016(KeithV): Created                                        */
+/*    10/19/2026(KeithV): Lex in place on the input buffer              */
 /************************************************************************/
 #include    <OpenScope.h>
 
@@ -51,20 +52,51 @@ GCMD::ACTION  JSON::LexJSON(char const * szInput, int32_t cbInput, int32_t& cbCo
 
     while(true)
     {
-        szMoveInput = szTokenBuff;
+        char const *    pchLex;     // where the current token starts
+        int32_t         cbLex;      // how many chars we have from the token start
 
-        if(cbTokenBuff < (int32_t) sizeof(szTokenBuff) && iInput < cbInput)
+        // lex in place on the input, unless we are holding a token that straddled the last read
+        if(fLexInPlace && cbTokenBuff == 0)
         {
-            uint32_t cbCopy = min((int32_t) sizeof(szTokenBuff) - cbTokenBuff, cbInput - iInput);
-            memcpy(&szTokenBuff[cbTokenBuff], &szInput[iInput], cbCopy);
-            iInput += cbCopy;
-            cbTokenBuff += cbCopy;
+            pchLex  = &szInput[iInput];
+            cbLex   = cbInput - iInput;
         }
 
+        else 
+        {
+            if(cbTokenBuff < (int32_t) sizeof(szTokenBuff) && iInput < cbInput)
+            {
+                uint32_t cbCopy = min((int32_t) sizeof(szTokenBuff) - cbTokenBuff, cbInput - iInput);
+                memcpy(&szTokenBuff[cbTokenBuff], &szInput[iInput], cbCopy);
+                iInput += cbCopy;
+                cbTokenBuff += cbCopy;
+            }
+
+            pchLex  = szTokenBuff;
+            cbLex   = cbTokenBuff;
+        }
+
+        szMoveInput = pchLex;
+
         // this should never happen on a state of Idle 
         // as cbToken == 0 at Idle
-        if(cbToken > cbTokenBuff) 
+        if(cbToken > cbLex) 
         {
+            // if in place, save what we have of the token; it will be completed by the next read
+            if(pchLex != szTokenBuff)
+            {
+                // the token is bigger than we can hold
+                if(cbLex >= (int32_t) sizeof(szTokenBuff))
+                {
+                    cbToken = 0;
+                    state = JSONSyntaxError;
+                    continue;
+                }
+
+                memcpy(szTokenBuff, pchLex, cbLex);
+                cbTokenBuff = cbLex;
+            }
+
             iInput = 0;
             return(GCMD::READ);
         }
@@ -79,17 +111,17 @@ GCMD::ACTION  JSON::LexJSON(char const * szInput, int32_t cbInput, int32_t& cbCo
             case JSONSkipWhite:
                 {
                     cbToken = 0;
-                    szMoveInput = SkipWhite(szMoveInput, cbTokenBuff - (szMoveInput - szTokenBuff));
+                    szMoveInput = SkipWhite(szMoveInput, cbLex - (szMoveInput - pchLex));
 
                     // Depleated our buffer, so continue to look for white space
-                    if(cbTokenBuff == 0)
+                    if(cbLex == 0)
                     {
                         iInput = 0;
                         return(GCMD::READ);                    
                     }
                     
                     // found the start of a token
-                    else if(szMoveInput == szTokenBuff)
+                    else if(szMoveInput == pchLex)
                     {
                         state = JSONToken;
                         break;
@@ -100,7 +132,7 @@ GCMD::ACTION  JSON::LexJSON(char const * szInput, int32_t cbInput, int32_t& cbCo
                 break;
 
             case JSONToken:
-                switch(szTokenBuff[0])
+                switch(pchLex[0])
                 {
 
                     //VALUES
@@ -258,7 +290,7 @@ GCMD::ACTION  JSON::LexJSON(char const * szInput, int32_t cbInput, int32_t& cbCo
                             break;
                         }
 
-                        if(szTokenBuff[0] == '0') cZero = 0;
+                        if(pchLex[0] == '0') cZero = 0;
                         else cZero = cAny;
 
                         // normal case
@@ -339,24 +371,24 @@ GCMD::ACTION  JSON::LexJSON(char const * szInput, int32_t cbInput, int32_t& cbCo
                 break;
 
             case JSONfalse:
-                if(memcmp(szTokenBuff, "false", 5) == 0) state = JSONCallOSLex;
+                if(memcmp(pchLex, "false", 5) == 0) state = JSONCallOSLex;
                 else state = JSONSyntaxError;
                 break;
 
             case JSONnull:
-                if(memcmp(szTokenBuff, "null", 4) == 0) state = JSONCallOSLex;
+                if(memcmp(pchLex, "null", 4) == 0) state = JSONCallOSLex;
                 else state = JSONSyntaxError;
                 break;
 
             case JSONtrue:
-                if(memcmp(szTokenBuff, "true", 4) == 0) state = JSONCallOSLex;
+                if(memcmp(pchLex, "true", 4) == 0) state = JSONCallOSLex;
                 else state = JSONSyntaxError;
                 break;
 
             case JSONString:
-                for(; cbToken <= cbTokenBuff; cbToken++)
+                for(; cbToken <= cbLex; cbToken++)
                 {
-                    if(szTokenBuff[cbToken-1] == '"' && szTokenBuff[cbToken-2] != '\\')
+                    if(pchLex[cbToken-1] == '"' && pchLex[cbToken-2] != '\\')
                     {
                         // the question is, should the underlying code
                         // get escape sequences, or should they somehow be stripped
@@ -370,9 +402,9 @@ GCMD::ACTION  JSON::LexJSON(char const * szInput, int32_t cbInput, int32_t& cbCo
 
                 // what if the number is the last in the file
             case JSONNumber:
-                for(; cbToken <= cbTokenBuff; cbToken++)
+                for(; cbToken <= cbLex; cbToken++)
                 {
-                    char cch = szTokenBuff[cbToken-1];
+                    char cch = pchLex[cbToken-1];
 
                     if(cch == '0')
                     {
@@ -423,11 +455,11 @@ GCMD::ACTION  JSON::LexJSON(char const * szInput, int32_t cbInput, int32_t& cbCo
                             cZero = 0;
                         }
                     }
-                    else if(cch == '+' && fExponent && (szTokenBuff[cbToken-2] == 'e' || szTokenBuff[cbToken-2] == 'E'))
+                    else if(cch == '+' && fExponent && (pchLex[cbToken-2] == 'e' || pchLex[cbToken-2] == 'E'))
                     {
                             cZero = 0;
                     }
-                    else if(cch == '-' && fExponent && (szTokenBuff[cbToken-2] == 'e' || szTokenBuff[cbToken-2] == 'E'))
+                    else if(cch == '-' && fExponent && (pchLex[cbToken-2] == 'e' || pchLex[cbToken-2] == 'E'))
                     {
                             fNegativeExponent = true;
                             cZero = 0;
@@ -459,7 +491,7 @@ GCMD::ACTION  JSON::LexJSON(char const * szInput, int32_t cbInput, int32_t& cbCo
 
                 // call the OpenScope lexer here
                 // LexOpenScope(char const * szJSON, uint32_t cbJSON);
-                if((tokenLexState = ParseToken(szTokenBuff, cbToken, jsonToken)) == Idle)
+                if((tokenLexState = ParseToken(pchLex, cbToken, jsonToken)) == Idle)
                 {
                     state = JSONNextToken;
 
@@ -477,7 +509,7 @@ GCMD::ACTION  JSON::LexJSON(char const * szInput, int32_t cbInput, int32_t& cbCo
            case JSONNextToken:
 
                 // consume the token
-                szMoveInput =  szTokenBuff + cbToken;
+                szMoveInput =  pchLex + cbToken;
 
                 if(jsonToken == tokEndOfJSON)
                 {
@@ -561,14 +593,34 @@ GCMD::ACTION  JSON::LexJSON(char const * szInput, int32_t cbInput, int32_t& cbCo
                 break;
         }
 
+        // lexing in place, just move up in the input
+        if(szMoveInput > pchLex && pchLex != szTokenBuff)
+        {
+            int32_t cbMove = (szMoveInput - pchLex);
+            iInput      += cbMove;
+            cbConsumed  += cbMove;
+            cbToken = 0;
+        }
+
         // shift the token buffer if needed
-        if(szMoveInput > szTokenBuff)
+        else if(szMoveInput > pchLex)
         {
             int32_t cbMove = (szMoveInput - szTokenBuff);
             cbTokenBuff -= cbMove;
             cbConsumed  += cbMove;
-            memcpy(szTokenBuff, szMoveInput, cbTokenBuff);
             cbToken = 0;
+
+            // the straddling token is done, what is left in the token buffer
+            // was copied from the input, so back up and go back to lexing in place
+            if(fLexInPlace)
+            {
+                iInput      -= cbTokenBuff;
+                cbTokenBuff = 0;
+            }
+            else
+            {
+                memcpy(szTokenBuff, szMoveInput, cbTokenBuff);
+            }
         }
     }
 
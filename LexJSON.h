@@ -42,6 +42,7 @@
 /************************************************************************/
 /*  Revision History:                                                   */
 /*    7/11/2016(KeithV): Created                                        */
+/*    10/19/2026(KeithV): Lex in place on the input buffer              */
 /************************************************************************/
 
 #ifndef JSONLex_h
@@ -111,7 +112,8 @@ private:
     int32_t         iInput;
     int32_t         cbTokenBuff;
     int32_t         iTokenBuff;
-    char            szTokenBuff[0x100];         // for tokens
+    char            szTokenBuff[0x100];         // for tokens that straddle an input read, or all tokens if not lexing in place
+    bool            fLexInPlace;                // tokens are passed directly out of the callers input buffer
 
     char const *    SkipWhite(char const * sz, uint32_t cbsz);
 
@@ -126,9 +128,17 @@ public:
     {
         szMoveInput = NULL;
         cbToken     = 0;
+        fLexInPlace = true;
         Init();
     }
 
+    // The input buffer must not change between LexJSON calls until GCMD::READ is returned
+    // if it can, turn off lexing in place so every token is copied to szTokenBuff
+    void LexInPlace(bool fInPlace)
+    {
+        fLexInPlace = fInPlace;
+    }
+
     void Init(void)
     {
         state               = Idle;
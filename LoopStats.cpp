@@ -14,6 +14,9 @@
 /************************************************************************/
 /*  Revision History:                                                   */
 /*    9/28/2017(KeithV): Created                                        */
+/*    10/19/2026(KeithV): Added the SD log write time and headroom       */
+/*    10/19/2026(KeithV): Per command latency histograms                */
+/*    10/19/2026(KeithV): TCP transmit throughput                       */
 /************************************************************************/
 #include    <OpenScope.h>
 
@@ -27,6 +30,10 @@ uint32_t            maxLogWrittenCnt    = 0;
 uint32_t            aveLogWrite         = 0;
 uint32_t            cLogWrite           = 0;  
 
+uint32_t            rgCmdStats[CMDSTATTYPES][CMDSTATPHASES][CMDSTATBUCKETS];
+
+uint32_t            tTCPStats           = 0;            // msec when the TCP transmit counters were last reported and cleared
+
 static  uint32_t    tSLoop              = ReadCoreTimer();
 static  uint32_t    cAve                = 0;
 
@@ -51,3 +58,19 @@ STATE LoopStatsTask(void)
     return(Idle);
 }
 
+// bucket i counts times from 2^i to 2^(i+1) usec, bucket 0 also takes 0
+static void CmdStatBucket(uint32_t rgBuckets[CMDSTATBUCKETS], uint32_t usec)
+{
+    uint32_t iBucket = 31 - __builtin_clz(usec | 1);
+
+    rgBuckets[min(iBucket, (uint32_t) (CMDSTATBUCKETS-1))]++;
+}
+
+void CmdStatsRecord(uint32_t iCmd, uint32_t usParse, uint32_t usProcess, uint32_t usOutput)
+{
+    if(iCmd >= CMDSTATTYPES) iCmd = CMDSTATTYPES-1;
+
+    CmdStatBucket(rgCmdStats[iCmd][0], usParse);
+    CmdStatBucket(rgCmdStats[iCmd][1], usProcess);
+    CmdStatBucket(rgCmdStats[iCmd][2], usOutput);
+}
@@ -11,6 +11,7 @@
 /************************************************************************/
 /*  Revision History:                                                   */
 /*    2/1/2013(KeithV): Created                                         */
+/*    10/19/2026(KeithV): Decimal formatting by digit pairs             */
 /************************************************************************/
 #include <OpenScope.h>
 
@@ -193,11 +194,116 @@ bool OSDivide(int8_t m1[], uint32_t cm1, int64_t d1, int8_t r[], uint32_t cr)
     return(true);
 }
 
+// "00" "01" ... "99"; 2 digits per lookup
+static const char rgDigitPairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static uint32_t CountDigits(uint32_t val)
+{
+    if(val < 10)            return(1);
+    if(val < 100)           return(2);
+    if(val < 1000)          return(3);
+    if(val < 10000)         return(4);
+    if(val < 100000)        return(5);
+    if(val < 1000000)       return(6);
+    if(val < 10000000)      return(7);
+    if(val < 100000000)     return(8);
+    if(val < 1000000000)    return(9);
+    return(10);
+}
+
+// write exactly cDigits, leading zeros included, ending just before pchEnd
+static void PutDigits(uint32_t val, char * pchEnd, uint32_t cDigits)
+{
+    while(cDigits >= 2)
+    {
+        uint32_t i = (val % 100) * 2;
+
+        val /= 100;
+        *--pchEnd = rgDigitPairs[i + 1];
+        *--pchEnd = rgDigitPairs[i];
+        cDigits -= 2;
+    }
+
+    if(cDigits == 1) *--pchEnd = '0' + val;
+}
+
+uint32_t OSU32ToDec(uint32_t val, char * buf)
+{
+    uint32_t cDigits = CountDigits(val);
+
+    PutDigits(val, &buf[cDigits], cDigits);
+    buf[cDigits] = '\0';
+    return(cDigits);
+}
+
+// split into 8 digit pieces that fit in 32 bits, so only the split itself is 64 bit math
+uint32_t OSU64ToDec(uint64_t val, char * buf)
+{
+    uint32_t    lo, mid, hi;
+    uint32_t    cDigits;
+
+    if(val <= 0xFFFFFFFFull) return(OSU32ToDec((uint32_t) val, buf));
+
+    lo = (uint32_t) (val % 100000000ull);
+    val /= 100000000ull;
+
+    // up to 17 digits
+    if(val <= 0xFFFFFFFFull)
+    {
+        hi = (uint32_t) val;
+        cDigits = CountDigits(hi);
+        PutDigits(hi, &buf[cDigits], cDigits);
+    }
+
+    // 18 to 20 digits
+    else
+    {
+        mid = (uint32_t) (val % 100000000ull);
+        hi = (uint32_t) (val / 100000000ull);
+        cDigits = CountDigits(hi);
+        PutDigits(hi, &buf[cDigits], cDigits);
+        cDigits += 8;
+        PutDigits(mid, &buf[cDigits], 8);
+    }
+
+    cDigits += 8;
+    PutDigits(lo, &buf[cDigits], 8);
+    buf[cDigits] = '\0';
+    return(cDigits);
+}
+
+uint32_t OSI64ToDec(int64_t val, char * buf)
+{
+    if(val < 0) 
+    {
+        *buf = '-';
+        return(OSU64ToDec(0 - (uint64_t) val, &buf[1]) + 1);
+    }
+    return(OSU64ToDec((uint64_t) val, buf));
+}
+
 char * ulltoa(uint64_t val, char * buf, uint32_t base)
 {
 	uint64_t	v;
 	char		c;
 
+	// almost everything we print is decimal
+	if(base == 10)
+	{
+		OSU64ToDec(val, buf);
+		return(buf);
+	}
+
 	v = val;
 	do {
 		v /= base;
@@ -408,6 +514,58 @@ bool ScrollBuffer(uint16_t rgBuff[], int32_t cBuff, int32_t iNew, int32_t iCur)
     return(true);
 }
 
+// Run length encode a buffer as {value, count} uint16_t pairs, values are masked with bitMask
+// returns the number of runs, or 0 if the runs will not fit in cRunsMax
+uint32_t RLEBuffer(uint16_t const rgBuff[], int32_t cBuff, uint16_t bitMask, uint16_t rgRuns[], uint32_t cRunsMax)
+{
+    uint32_t    cRuns   = 0;
+    uint16_t    value;
+    uint16_t    cSamples;
+    int32_t     i;
+
+    // a run count must fit in a uint16_t
+    ASSERT(cBuff < 0x10000);
+
+    if(cBuff <= 0 || cRunsMax == 0)
+    {
+        return(0);
+    }
+
+    value       = rgBuff[0] & bitMask;
+    cSamples    = 1;
+
+    for(i=1; i<cBuff; i++)
+    {
+        uint16_t cur = rgBuff[i] & bitMask;
+
+        if(cur == value)
+        {
+            cSamples++;
+            continue;
+        }
+
+        // close out this run; 0 says it won't fit
+        if(cRuns == (cRunsMax - 1))
+        {
+            return(0);
+        }
+
+        rgRuns[2*cRuns]     = value;
+        rgRuns[2*cRuns+1]   = cSamples;
+        cRuns++;
+
+        value       = cur;
+        cSamples    = 1;
+    }
+
+    // the last run
+    rgRuns[2*cRuns]     = value;
+    rgRuns[2*cRuns+1]   = cSamples;
+    cRuns++;
+
+    return(cRuns);
+}
+
 bool CalculateBufferIndexes(BIDX * pbidx)
 {
     int64_t absTrig2POI;
@@ -57,6 +57,7 @@
 #define WFVER   8   // wifi file format version
 #define LOGFMT  1   // log file format version
 #define LOGREV  1   // log header revision number
+#define DLOGFMT 2   // digital log file format version, run length encoded
 
 /************************************************************************/ 
 /************************************************************************/
@@ -133,6 +134,7 @@
 #define CORE_TMR_TICKS_PER_SEC (F_CPU / 2ul)
 #define CORE_TMR_TICKS_PER_MSEC (CORE_TMR_TICKS_PER_SEC / 1000ul)
 #define CORE_TMR_TICKS_PER_USEC (CORE_TMR_TICKS_PER_SEC / 1000000ul)
+#define MAXTICKSWHENREADY (10 * CORE_TMR_TICKS_PER_SEC)    // how long a readWhenReady will wait on the trigger
 
 static inline uint32_t ReadCoreTimer(void)
 {
@@ -262,6 +264,7 @@ static inline void __attribute__((nomips16))  OSRestoreInterrupts(uint32_t st)
 #define LAMAXmSPS       (10000000000ll)             // How fast can the LA run in mSPS
 #define LAMINmSPS       (5961ll)                    // How slow can the LA run, 100,000,000 / 256 / 65536 => PB / peScalar / PRx in mSPS
 #define LAPBCLK         100000000l                  // how fast is the LA PBclk
+#define LARLEMAXRUNS    2048                        // max {value, count} runs in an RLE encoded LA read, if more are needed the read is returned raw
 #define LAOVERSHOOT     5                           // how many samples to over shoot in our timing, just to make sure we get valid data at the end, this must fit in the 128 sample slop
 
 /************************************************************************/
@@ -282,9 +285,19 @@ static inline void __attribute__((nomips16))  OSRestoreInterrupts(uint32_t st)
 //#define LOGMAXSMPTORWRT 32768                       // something bigger than the number of samples in RAM
 #define LOGMAXSECTORWRT 5                               // How many sectors to write to the log file in one write.
 #define LOGMAXSMPTORWRT ((LOGMAXSECTORWRT * _FATFS_CBSECTOR_)/sizeof(uint16_t)) // how many samples we can write to a file in one shot
+#define LOGSMPPERSECTOR (_FATFS_CBSECTOR_/sizeof(uint16_t))                 // how many samples fit in a sector
+#define LOGMAXSECTORADP 64                              // the most sectors the write scheduler will write in one pass when catching up; must fit in LOGMAXBUFFSIZE
+#define LOGMAXTICKSPERWRT (10 * CORE_TMR_TICKS_PER_MSEC) // how long we let a write take when we are keeping up
+#define LOGCATCHUPBACKLOG (LOGMAXBACKLOG / 4)           // once the back log is past this, ignore the time budget and catch up
 #define LOGMAXFILESAMP  2147483136                      // FAT32 limits the File size to 4GB (2^^32) less our header divide by 2 (byts per sample).  (2^^32 - 512) / 2 == 2^^31 - 256 == 2147483392; less 256, a page, for just a little slop; this is used in the enum, do not put ull on it
 #define LOGMAXSECDELAY  18446744                        // used for limits check on how big our picoseconds can be and fit in an uint64 2^^64 / 10^^12 == 18,446,744
 
+#define DLOGuSPS        100000000000ll                  // max digital log rate, 100KS/s; every sample is run length encoded by the CPU
+#define DLOGDMASIZE     LADMASIZE                       // # of elements in the circular LA buffer
+#define DLOGMAXBACKLOG  (DLOGDMASIZE - DLOGDMASIZE/6)   // if we are this far behind we probably overran the LA buffer
+#define DLOGRUNSECTORS  8                               // how many sectors of encoded runs we buffer before writing
+#define DLOGMAXFILERUNS ((0xFFFFFFFF - _FATFS_CBSECTOR_) / sizeof(DLogRun)) // FAT32 limits the file size to 4GB
+
 /************************************************************************/
 /********************** TMR9 Completion Vectors *************************/
 /************************************************************************/
@@ -411,6 +424,9 @@ typedef const void * HINSTR;
     extern bool fModeJSON;
     extern bool fBlockIOBus;
 
+    // cached responses are rebuilt when this changes
+    extern uint32_t respCacheVersion;
+
     // Loop status variables
     extern uint32_t     tLoop;
     extern uint32_t     aveLoopTime;
@@ -420,6 +436,16 @@ typedef const void * HINSTR;
     extern uint32_t     aveLogWrite;
     extern uint32_t     cLogWrite;  
     extern uint32_t     maxLogWrittenCnt;
+
+    // per command latency histograms, log2 buckets in usec for the parse, process and output phases
+    #define CMDSTATTYPES        13          // one for each end point, and one for anything else
+    #define CMDSTATPHASES       3
+    #define CMDSTATBUCKETS      24          // the last bucket holds everything at or over 2^23 usec
+    extern uint32_t     rgCmdStats[CMDSTATTYPES][CMDSTATPHASES][CMDSTATBUCKETS];
+    extern void CmdStatsRecord(uint32_t iCmd, uint32_t usParse, uint32_t usProcess, uint32_t usOutput);
+
+    // the TCP transmit counters, g_tcpTxStats, are reported since this core timer value
+    extern uint32_t     tTCPStats;
  
     // static buffers used by the instruments
     extern uint32_t                                 trigAcqCount;
@@ -511,6 +537,12 @@ typedef enum
     OSJBOutputJSON,
     OSJBWriteChunkSize,
     OSJBWriteOData,
+    OSJBTLVLength,
+    OSJBTLVRead,
+    OSJBTLVValueSep,
+    OSJBTLVToken,
+    OSJBTLVNameSep,
+    OSJBTLVEnd,
 
     // Buffer lock states
     LOCKAvailable,
@@ -736,6 +768,8 @@ typedef enum
     OSPARErrArrayEnd,
     OSPARTopEndArray,
     OSPARTopObjEnd,
+    OSPARBatchObject,
+    OSPARBatchNext,
 
     // Endpoint
     OSPARLoadEndPoint,
@@ -906,6 +940,7 @@ typedef enum
     OSPAROscSetBufferSize,
     OSPAROscSetTrigDelay,
     OSPAROscRead,
+    OSPAROscReadWhenReady,
     OSPAROscSetAcqCount,
     OSPAROscGetCurrentState,
     OSPAROscObjectEnd,
@@ -918,6 +953,7 @@ typedef enum
     OSPARLaChArrayEnd,
     OSPARLaSetParm,
     OSPARLaRead,
+    OSPARLaReadWhenReady,
     OSPARLaGetCurrentState,
     OSPARLaRun,
     OSPARLaStop,
@@ -926,6 +962,7 @@ typedef enum
     OSPARLaSetAcqCount,
     OSPARLaSetTrigDelay,
     OSPARLaBitMask,
+    OSPARLaEncoding,
     OSPARLaObjectEnd,
 
     // data logging
@@ -961,6 +998,17 @@ typedef enum
     OSPARLogRun,
     OSPARLogStop,
 
+    OSPARLogDigitalCmd,
+    OSPARLogDigitalChEnd,
+    OSPARLogDigitalObjectEnd,
+    OSPARLogDigitalSetParams,
+    OSPARLogDigitalCompleteParams,
+    OSPARLogDigitalMaxSampleCount,
+    OSPARLogDigitalSampleFreq,
+    OSPARLogDigitalStorageLocation,
+    OSPARLogDigitalURI,
+    OSPARLogDigitalBitMask,
+
     // common JSPAR
     JSPARSetParm,
             
@@ -987,9 +1035,11 @@ typedef enum
     JSPARAwgRunArbitraryWaveform,
 
     JSPAROscRead,
+    JSPAROscReadWhenReady,
     JSPAROscGetCurrentState,
 
     JSPARLaRead,
+    JSPARLaReadWhenReady,
     JSPARLaGetCurrentState,
     JSPARLaRun,
     JSPARLaStop,
@@ -1136,6 +1186,8 @@ typedef enum
     NoDataAvailable                 = (STATEError | STATEPredefined | 0x00000021),  // 0xA0000021, --> 2684354593
     DirectoryDoesNotExist           = (STATEError | STATEPredefined | 0x00000022),  // 0xA0000022, --> 2684354594
     StartIndexDoesNotExist          = (STATEError | STATEPredefined | 0x00000023),  // 0xA0000023, --> 2684354595
+    ResponseTooLarge                = (STATEError | STATEPredefined | 0x00000024),  // 0xA0000024, --> 2684354596
+    InvalidParameter                = (STATEError | STATEPredefined | 0x00000025),  // 0xA0000025, --> 2684354597
 } OPEN_SCOPE_STATES;
 
 /************************************************************************/
@@ -1165,6 +1217,7 @@ typedef enum
     LAFnRun,
 
     ALogFnRun,
+    DLogFnRun,
 
     WIFIFnManConnect,
     WIFIFnAutoConnect,
@@ -1679,12 +1732,20 @@ typedef struct _LogHeader
     const uint8_t rgSize[512-sizeof(struct _AHdr)];
 
 #ifdef __cplusplus
-    _LogHeader() : AHdr({LogLittleEndian, sizeof(uint16_t), sizeof(struct _AHdr), sizeof(struct _LogHeader), LOGFMT, LOGREV, 1000ul, STCDError, 0, 0, 1000000ull, 1000000000, 1000000000000ull, 0}), rgSize{0}
+    _LogHeader(uint8_t cbEntry = sizeof(uint16_t), uint16_t fmt = LOGFMT) : AHdr({LogLittleEndian, cbEntry, sizeof(struct _AHdr), sizeof(struct _LogHeader), fmt, LOGREV, 1000ul, STCDError, 0, 0, 1000000ull, 1000000000, 1000000000000ull, 0}), rgSize{0}
     {     
     }
 #endif
 } __attribute__((packed)) LogHeader;
 
+// a digital log file is a LogHeader followed by runs
+// a run is how many samples in a row had the same (masked) value
+typedef struct _DLogRun
+{
+    uint16_t    value;              // the PORTE bits, masked with the bitmask
+    uint32_t    cSamples;           // how many samples in a row had this value
+} __attribute__((packed)) DLogRun;
+
 #ifdef __cplusplus
 
     typedef struct _INSTRGRP
@@ -1710,6 +1771,7 @@ typedef struct _LogHeader
     extern uint8_t          uartBuff[512];
     extern INSTRGRP         instrGrp;
     extern FLASHVOL         flashVol;
+    extern DSPI             dSDSpi;
     extern DSDVOL           dSDVol;
     extern STATE            MState;
 
@@ -1719,7 +1781,9 @@ typedef struct _LogHeader
     #include <ParseOpenScope.h>   // OpenScope token parsing
 
 #ifdef __cplusplus
-    extern OSPAR    oslex;
+    #define COSPAR  2           // JSON parsers; the serial port uses oslex, the first one. HTTP clients take any free one.
+    extern OSPAR    rgOSPar[COSPAR];
+    extern OSPAR&   oslex;
 #endif
 
     #include <ProcessJSONCmd.h>
@@ -1779,6 +1843,9 @@ extern "C" {
     extern bool OSMult(int8_t m1[], uint32_t cm1, int8_t m2[], uint32_t cm2, int8_t r[], uint32_t cr);
     extern bool OSDivide(int8_t m1[], uint32_t cm1, int64_t d1, int8_t r[], uint32_t cr);
 
+    extern uint32_t OSU32ToDec(uint32_t val, char * buf);
+    extern uint32_t OSU64ToDec(uint64_t val, char * buf);
+    extern uint32_t OSI64ToDec(int64_t val, char * buf);
     extern char * ulltoa(uint64_t val, char * buf, uint32_t base);
     extern char * illtoa(int64_t val, char * buf, uint32_t base);
     extern char * GetPercent(int32_t diff, int32_t ideal, int32_t cbD, char * pchOut, int32_t cbOut);
@@ -1826,9 +1893,13 @@ extern "C" {
     extern STATE ALOGRun(IALOG * pialog);
     extern STATE ALOGStop(IALOG * pialog);
 
+    extern STATE DLOGRun(IDLOG * pidlog);
+    extern STATE DLOGStop(IDLOG * pidlog);
+
     extern bool CalculateBufferIndexes(BIDX * pbidx);
     extern uint64_t CalculatePreScalarAndPeriod(uint64_t xsps, uint32_t scaleSPS, uint32_t const pbClk, uint16_t * pPreScalar, uint32_t * pPeriod, uint32_t * pCnt);
     extern bool ScrollBuffer(uint16_t rgBuff[], int32_t cBuff, int32_t iNew, int32_t iCur);
+    extern uint32_t RLEBuffer(uint16_t const rgBuff[], int32_t cBuff, uint16_t bitMask, uint16_t rgRuns[], uint32_t cRunsMax);
     
     #define OSCPWM(_pOSC, _gain, _mVOff) ((((_mVOff) * 1000l) + (_pOSC)->rgGCal[_gain].C + ((_pOSC)->rgGCal[_gain].B / 2)) / (_pOSC)->rgGCal[_gain].B)
     #define OSCBandC(_pOSC, _gain, _pwm) (((int32_t) _pwm) * (_pOSC)->rgGCal[_gain].B - (_pOSC)->rgGCal[_gain].C)
@@ -1851,6 +1922,9 @@ extern "C" {
     #define UnLockLA()      (DCH7DSA = KVA_2_PA(&LATH))
     #define IsLALocked()    (DCH7DSA == KVA_2_PA(rgLOGICBuff))
 
+    // the digital logger also holds the LA lock, only its own run state machine may release it
+    #define IsDLOGRunning() (((DLOG *) rgInstr[DLOG1_ID])->comhdr.state == Armed)
+
     // Instrument Idle macros
     #define IsDCxIdle(a)  ((a).state.processing == Idle)
     #define IsDCIdle()  (IsDCxIdle(pjcmd.idcCh1) && IsDCxIdle(pjcmd.idcCh2))
@@ -1860,7 +1934,7 @@ extern "C" {
     #define IsOSCIdle()  (IsOSCxIdle(pjcmd.ioscCh1) &&  IsOSCxIdle(pjcmd.ioscCh2))
     #define IsTrgIdle() (pjcmd.trigger.state.processing == Idle || pjcmd.trigger.state.processing == Waiting || pjcmd.trigger.state.processing == Triggered)
     #define IsLogxIdle(a) ((a).state.processing == Idle || (a).state.processing == Waiting || (a).state.processing == Stopped)
-    #define IsLogIdle() (IsLogxIdle(pjcmd.iALog1) && IsLogxIdle(pjcmd.iALog2))
+    #define IsLogIdle() (IsLogxIdle(pjcmd.iALog1) && IsLogxIdle(pjcmd.iALog2) && IsLogxIdle(pjcmd.iDLog1))
     #define AreInstrumentsIdle()  (IsDCIdle() && IsLAIdle() && IsAWGIdle() && IsOSCIdle() && IsTrgIdle() && IsLogIdle())
  
     extern STATE HTTPSetup(void);
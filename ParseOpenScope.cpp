@@ -10,6 +10,10 @@
 /************************************************************************/
 /*  Revision History:                                                   */
 /*    7/11/2016(KeithV): Created                                        */
+/*    10/19/2026(KeithV): Temp structures per parser                   */
+/*    10/19/2026(KeithV): TCP transmit throughput in loopStats          */
+/*    10/19/2026(KeithV): LA RLE runs per parser, reject bad encodings  */
+/*    10/19/2026(KeithV): TLV types mapped from fixed wire values       */
 /************************************************************************/
 #include    <OpenScope.h>
 
@@ -36,6 +40,7 @@ static const char szNewLine[]       = "\r\n";
 static const char szValueSep[]      = ",";
 
 static const char szStartObject[]   = "{";
+static const char szStartArray[]    = "[";
 static const char szEndObject[]     = "}";
 static const char szEndArray[]      = "]";
 static const char szStartChArray[]   = ":[";
@@ -78,6 +83,8 @@ static const char szBitMask[]           = ",\"bitmask\":";
 static const char szBufferSize[]        = ",\"actualBufferSize\":";
 static const char szBinaryLength[]      = ",\"binaryLength\":";
 static const char szBinaryOffset[]      = ",\"binaryOffset\":";
+static const char szEncodingRaw[]       = ",\"encoding\":\"raw\"";
+static const char szEncodingRLE[]       = ",\"encoding\":\"rle\"";
 static const char szTriggerIndex[]      = ",\"triggerIndex\":";
 static const char szActualTriggerDelay[] = ",\"actualTriggerDelay\":";
 static const char szPointOfInterest[]   = ",\"pointOfInterest\":";
@@ -355,16 +362,29 @@ static const char szLoopStats[] = "\
 \"command\":\"loopStats\",\
 \"uSecAveTime\":";
 
+static const char szLoopStatsStatusCode[] = "{\"command\":\"loopStats\",\"statusCode\":";
 static const char szMinLoopTime[] = ",\"uSecMinLoopTime\":";
 static const char szMaxLoopTime[] = ",\"uSecMaxLoopTime\":";
 static const char szLastCommandTime[] = ",\"uSecLastCommandTime\":";
 static const char szAveLogCnt[] = ",\"aveLogWrite\":";
 static const char szMaxLogCnt[] = ",\"maxLogBackLog\":";
 static const char szMaxLogWrittenCnt[] = ",\"maxLogWrite\":";
+static const char szLogSectorTime[] = ",\"uSecLogSectorWrite\":";
+static const char szLogHeadroom[] = ",\"logHeadroom\":";
 
 
 static const char szMaxSDBusyTime[] = ",\"uSecMaxSDBusy\":";
 static const char szMaxInARowBusy[] = ",\"maxBusyInARow\":";
+static const char szTCPBytesSent[] = ",\"tcpBytesSent\":";
+static const char szTCPBytesPerSec[] = ",\"tcpBytesPerSec\":";
+static const char szTCPCyclesPerKB[] = ",\"tcpCyclesPerKB\":";
+static const char szTCPSegments[] = ",\"tcpSegments\":";
+static const char szTCPRetransmits[] = ",\"tcpRetransmits\":";
+static const char szTCPFastRetransmits[] = ",\"tcpFastRetransmits\":";
+static const char szCmdLatency[] = ",\"cmdLatencyLog2uSec\":{";
+static const char szCmdOther[] = "other";
+static char const * const rgszCmdPhases[CMDSTATPHASES] = {"\":{\"parse\":[", "],\"process\":[", "],\"output\":["};
+static const char szCmdPhasesEnd[] = "]}";
 
 static const char szStatus0Wait0[] = "\
 ,\"statusCode\":0,\
@@ -407,15 +427,30 @@ static const char szNicList[] = "\
 // these are temp structures, we only need to initialize them
 // to make the compiler happy about const in them. We memcpy
 // in the code thus bypassing the const assignment issue.
-static ITRG     triggerT    = pjcmd.trigger;
-static IDC      idcT        = pjcmd.idcCh1;
-static IAWG     iawgT       = pjcmd.iawg;
-static IOSC     ioscT       = pjcmd.ioscCh1;
-static ILA      ilaT        = pjcmd.ila;
-static IWIFI    iWiFiT      = pjcmd.iWiFi;
-static IALOG    iALogT      = pjcmd.iALog1;
-static IFILE    iFileT      = uicmd.iFile;
-static uint32_t iBinOffset = 0;
+// Each parser has its own set, a readWhenReady keeps its command in them while other parsers run
+typedef struct OSPARTMP_T
+{
+    ITRG        triggerT;
+    IDC         idcT;
+    IAWG        iawgT;
+    IOSC        ioscT;
+    ILA         ilaT;
+    IWIFI       iWiFiT;
+    IALOG       iALogT;
+    IDLOG       iDLogT;
+    IFILE       iFileT;
+    uint32_t    iBinOffset;
+    uint16_t    rgLARLEBuff[2*LARLEMAXRUNS];    // {value, count} runs of an RLE la read, held until the binary is written out
+
+    OSPARTMP_T() : triggerT(pjcmd.trigger), idcT(pjcmd.idcCh1), iawgT(pjcmd.iawg), ioscT(pjcmd.ioscCh1), ilaT(pjcmd.ila), 
+                    iWiFiT(pjcmd.iWiFi), iALogT(pjcmd.iALog1), iDLogT(pjcmd.iDLog1), iFileT(uicmd.iFile), iBinOffset(0) {}
+} OSPARTMP;
+static OSPARTMP rgParTmp[COSPAR];
+
+// Only one parser at a time may be in ParseToken, the temp structures of
+// a command are copied in and out of pjcmd and the response cache is shared.
+// Output and binary input run concurrently, each instrument buffer lock arbitrates its own instrument.
+static OSPAR *  pParseOwner = NULL;
 
 // token mapping
 // end points
@@ -433,6 +468,11 @@ static const OSPAR::STRU32 rgStrU32Endpoint[] = {
                                                     {"debugPrint",  OSPARDebugPrint},
                                                     {"test",        OSPARTestArray},
                                                 };
+static_assert(sizeof(rgStrU32Endpoint) / sizeof(OSPAR::STRU32) == CMDSTATTYPES-1, "CMDSTATTYPES does not match the end points");
+
+// a readWhenReady gives up ParseToken while it waits and holds its end point instead;
+// other parsers naming that end point wait for it
+static OSPAR *  rgpEndpointOwner[sizeof(rgStrU32Endpoint) / sizeof(OSPAR::STRU32)];
 
 // mode
 static const OSPAR::STRU32 rgStrU32Mode[]  = {{"JSON", true}, {"menu", false}};
@@ -607,6 +647,8 @@ static const OSPAR::STRU32 rgStrU32logDigitalChannel[]  = {{"1", OSPARLogDigital
 static const OSPAR::STRU32 rgStrU32logAnalog[]          = {{"command", OSPARLogAnalogCmd}, {"maxSampleCount", OSPARLogMaxSampleCount}, {"gain", OSPARLogSetGain}, {"vOffset", OSPARLogSetOffset}, {"sampleFreq", OSPARLogSetSampleFreq}, {"startDelay", OSPARLogStartDelay}, {"overflow", OSPARLogOverflow}, {"storageLocation", OSPARLogStorageLocation}, {"uri", OSPARLogURI}, {"startIndex", OSPARLogStartIndex}, {"count", OSPARLogCount}};
 static const OSPAR::STRU32 rgStrU32LogCmd[]             = {{"setParameters", OSPARLogAnalogSetParams}, {"getCurrentState", OSPARLogGetCurrentState}, {"run", OSPARLogRun}, {"read", OSPARLogRead}, {"stop", OSPARLogStop}};
 static const OSPAR::STRU32 rgStrU32LogOverflow[]        = {{"circular", OVFCircular}, {"stop", OVFStop}};
+static const OSPAR::STRU32 rgStrU32logDigital[]         = {{"command", OSPARLogDigitalCmd}, {"maxSampleCount", OSPARLogDigitalMaxSampleCount}, {"sampleFreq", OSPARLogDigitalSampleFreq}, {"storageLocation", OSPARLogDigitalStorageLocation}, {"uri", OSPARLogDigitalURI}, {"bitmask", OSPARLogDigitalBitMask}};
+static const OSPAR::STRU32 rgStrU32LogDigitalCmd[]      = {{"setParameters", OSPARLogDigitalSetParams}, {"getCurrentState", OSPARLogGetCurrentState}, {"run", OSPARLogRun}, {"stop", OSPARLogStop}};
 static const char szLogObject[]                         = "\"log\":{";
 static const char szLogAnalogObject[]                   = "\"analog\":{";
 static const char szLogDigitalObject[]                  = "\"digital\":{";
@@ -617,7 +659,7 @@ static const char szOscObject[]             = "\"osc\":{";
 // osc
 static const OSPAR::STRU32 rgStrU32OscChannel[] = {{"1", OSPAROscCh1}, {"2", OSPAROscCh2}};
 static const OSPAR::STRU32 rgStrU32Osc[] = {{"command", OSPAROscCmd}, {"offset", OSPAROscSetOffset}, {"vOffset", OSPAROscSetOffset}, {"gain", OSPAROscSetGain}, {"sampleFreq", OSPAROscSetSampleFreq}, {"bufferSize", OSPAROscSetBufferSize}, {"triggerDelay", OSPAROscSetTrigDelay}, {"acqCount", OSPAROscSetAcqCount}};
-static const OSPAR::STRU32 rgStrU32OscCmd[] = {{"setParameters", OSPAROscSetParm}, {"read", OSPAROscRead}, {"getCurrentState", OSPAROscGetCurrentState}};
+static const OSPAR::STRU32 rgStrU32OscCmd[] = {{"setParameters", OSPAROscSetParm}, {"read", OSPAROscRead}, {"readWhenReady", OSPAROscReadWhenReady}, {"getCurrentState", OSPAROscGetCurrentState}};
 
 /// TRG Strings
 static const char szTrgObject[]             = "\"trigger\":{";
@@ -631,8 +673,12 @@ static const char szTrgTargets[]            = ",\"targets\":{";
 
 // Logic Analyzer
 static const OSPAR::STRU32 rgStrU32LaChannel[]  = {{"1", OSPARLaCh1}};
-static const OSPAR::STRU32 rgStrU32La[]         = {{"command", OSPARLaCmd}, {"sampleFreq", OSPARLaSetSampleFreq}, {"bufferSize", OSPARLaSetBufferSize}, {"triggerDelay", OSPARLaSetTrigDelay}, {"bitmask", OSPARLaBitMask}, {"acqCount", OSPARLaSetAcqCount}};
-static const OSPAR::STRU32 rgStrU32LaCmd[]      = {{"setParameters", OSPARLaSetParm}, {"read", OSPARLaRead}, {"getCurrentState", OSPARLaGetCurrentState}, {"run", OSPARLaRun}, {"stop", OSPARLaStop}};
+static const OSPAR::STRU32 rgStrU32La[]         = {{"command", OSPARLaCmd}, {"sampleFreq", OSPARLaSetSampleFreq}, {"bufferSize", OSPARLaSetBufferSize}, {"triggerDelay", OSPARLaSetTrigDelay}, {"bitmask", OSPARLaBitMask}, {"acqCount", OSPARLaSetAcqCount}, {"encoding", OSPARLaEncoding}};
+static const OSPAR::STRU32 rgStrU32LaEncoding[] = {{"raw", false}, {"rle", true}};
+
+// binary TLV type to the token it stands for, indexed by OSPAR::TLVTYPE
+static const JSONTOKEN rgTokFromTLV[OSPAR::TLVEnd] = {tokNone, tokObject, tokEndObject, tokArray, tokEndArray, tokMemberName, tokStringValue, tokNumber, tokTrue, tokFalse, tokNull};
+static const OSPAR::STRU32 rgStrU32LaCmd[]      = {{"setParameters", OSPARLaSetParm}, {"read", OSPARLaRead}, {"readWhenReady", OSPARLaReadWhenReady}, {"getCurrentState", OSPARLaGetCurrentState}, {"run", OSPARLaRun}, {"stop", OSPARLaStop}};
 static const char szLaObject[]                  = "\"la\":{";
 static const char szLaRun[]                     = " {\"command\":\"run\",\"statusCode\":";
 static const char szLaStop[]                    = " {\"command\":\"stop\",\"statusCode\":";
@@ -671,12 +717,162 @@ static const OSPAR::STRU32 rgStrU32TestCmd[]        = {{"run", OSPARTestRun}};
 static const char szTest[]            = "\"test\":[";
 static const char szTestRun[]         = "{\"command\":\"run\",\"statusCode\":0,\"wait\":0,\"returnNbr\":";
 
+/************************************************************************/
+/*    OSRESP integer fields                                             */
+/************************************************************************/
+OSRESP& OSRESP::AppendU32(uint32_t u)
+{
+    char    sz[12];
+    return(Append(sz, OSU32ToDec(u, sz)));
+}
+
+OSRESP& OSRESP::AppendI32(int32_t i)
+{
+    char    sz[12];
+    return(Append(sz, OSI64ToDec(i, sz)));
+}
+
+OSRESP& OSRESP::AppendU64(uint64_t u)
+{
+    char    sz[24];
+    return(Append(sz, OSU64ToDec(u, sz)));
+}
+
+OSRESP& OSRESP::AppendI64(int64_t i)
+{
+    char    sz[24];
+    return(Append(sz, OSI64ToDec(i, sz)));
+}
+
+/************************************************************************/
+/*    Response cache                                                    */
+/*                                                                      */
+/*    Replies that only change on a calibration or SD card change are   */
+/*    built once and copied out until respCacheVersion moves on.        */
+/************************************************************************/
+typedef struct _RESPCACHE
+{
+    uint32_t        version;
+    uint32_t        cb;
+    uint32_t const  cbMax;
+    char * const    pch;
+} RESPCACHE;
+
+static char rgchCacheEnumerate[0x1000];
+static char rgchCacheCalRead[0x1000];
+static char rgchCacheLocations[0x100];
+static RESPCACHE rgRespCache[OSPAR::RCEND] = 
+{
+    {0, 0, sizeof(rgchCacheEnumerate), rgchCacheEnumerate},     // RCEnumerate
+    {0, 0, sizeof(rgchCacheCalRead), rgchCacheCalRead},         // RCCalibrationRead
+    {0, 0, sizeof(rgchCacheLocations), rgchCacheLocations}      // RCStorageGetLocations
+};
+
+bool OSPAR::RespFromCache(RCID rcid)
+{
+    RESPCACHE& rc = rgRespCache[rcid];
+
+    if(rc.version != respCacheVersion || rc.cb > (sizeof(pchJSONRespBuff) - odata[0].cb)) return(false);
+
+    memcpy(&pchJSONRespBuff[odata[0].cb], rc.pch, rc.cb);
+    odata[0].cb += rc.cb;
+    return(true);
+}
+
+// keep what was just built from iStart on; if it does not fit it just won't be cached
+void OSPAR::RespToCache(RCID rcid, uint32_t iStart)
+{
+    RESPCACHE&  rc  = rgRespCache[rcid];
+    uint32_t    cb  = odata[0].cb - iStart;
+
+    if(cb > rc.cbMax)
+    {
+        rc.version = 0;
+        return;
+    }
+
+    memcpy(rc.pch, &pchJSONRespBuff[iStart], cb);
+    rc.cb = cb;
+    rc.version = respCacheVersion;
+}
+
+/************************************************************************/
+/*    Command latency stats                                             */
+/*                                                                      */
+/*    parse is the time in the lexer and ParseToken, process is the     */
+/*    rest of the time until the output starts (waiting on instruments  */
+/*    and input), and output is from there to the end of the command.   */
+/************************************************************************/
+void OSPAR::RecordCmdStats(void)
+{
+    uint32_t tIn;
+
+    if(!fCmdOutput) return;
+    fCmdOutput = false;
+
+    tIn = tOutputCmd - tStartCmd;
+    CmdStatsRecord(iCmdStat, 
+                    tParseCmd / CORE_TMR_TICKS_PER_USEC, 
+                    ((tIn > tParseCmd) ? (tIn - tParseCmd) : 0) / CORE_TMR_TICKS_PER_USEC, 
+                    (ReadCoreTimer() - tOutputCmd) / CORE_TMR_TICKS_PER_USEC);
+}
+
+// give up ParseToken and any end point we hold
+void OSPAR::ReleaseParse(void)
+{
+    if(pParseOwner == this) pParseOwner = NULL;
+    ReleaseEndpoints();
+}
+
+void OSPAR::ReleaseEndpoints(void)
+{
+    for(uint32_t i = 0; i < sizeof(rgpEndpointOwner) / sizeof(rgpEndpointOwner[0]); i++)
+    {
+        if(rgpEndpointOwner[i] == this) rgpEndpointOwner[i] = NULL;
+    }
+}
+
+// hold an end point while waiting outside of ParseToken
+void OSPAR::ClaimEndpoint(STATE stateEndpoint)
+{
+    for(uint32_t i = 0; i < sizeof(rgpEndpointOwner) / sizeof(rgpEndpointOwner[0]); i++)
+    {
+        if(rgStrU32Endpoint[i].u32 == (uint32_t) stateEndpoint)
+        {
+            rgpEndpointOwner[i] = this;
+            break;
+        }
+    }
+}
+
 #ifndef JUST_LEX_JSON
 
 STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonToken)
 {
     STATE   curState = state;
     bool    fContinue = false;
+    OSRESP  resp(pchJSONRespBuff, odata[0].cb, sizeof(pchJSONRespBuff));
+    int32_t const  cODataStart = cOData;        // so a read that did not fit can give back its binary
+
+    // this parser's temp structures
+    OSPARTMP&   parTmp      = rgParTmp[this - rgOSPar];
+    ITRG&       triggerT    = parTmp.triggerT;
+    IDC&        idcT        = parTmp.idcT;
+    IAWG&       iawgT       = parTmp.iawgT;
+    IOSC&       ioscT       = parTmp.ioscT;
+    ILA&        ilaT        = parTmp.ilaT;
+    IWIFI&      iWiFiT      = parTmp.iWiFiT;
+    IALOG&      iALogT      = parTmp.iALogT;
+    IDLOG&      iDLogT      = parTmp.iDLogT;
+    IFILE&      iFileT      = parTmp.iFileT;
+    uint32_t&   iBinOffset  = parTmp.iBinOffset;
+    uint16_t *  rgLARLEBuff = parTmp.rgLARLEBuff;
+
+    ASSERT(rgOSPar <= this && this < &rgOSPar[COSPAR]);
+
+    // another parser is in the middle of a command, come back with the same token
+    if(pParseOwner != NULL && pParseOwner != this) return(Waiting);
+    pParseOwner = this;
 
     switch(jsonToken)
     {
@@ -696,8 +892,9 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
             cbToken -= 2;
             break;
 
+        // only a batch has tokens after the end of the command object
         default:
-            if(curState == OSPAREnd) curState = OSPARSyntaxError;
+            if(curState == OSPAREnd && !fBatch) curState = OSPARSyntaxError;
             break;
     }
 
@@ -1654,8 +1851,414 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                 break;
 
             case OSPARLogDigital:
+                if(jsonToken == tokObject)
+                {
+                    rgStrU32 = rgStrU32logDigitalChannel;
+                    cStrU32 = sizeof(rgStrU32logDigitalChannel) / sizeof(STRU32);
+                    memcpy(&pchJSONRespBuff[odata[0].cb], szLogDigitalObject, sizeof(szLogDigitalObject)-1); 
+                    odata[0].cb += sizeof(szLogDigitalObject)-1;
+                    stateEndObject = OSPARLogObjectEnd;
+                    state = OSPARMemberName;
+                }
+                break;
+
             case OSPARLogDigitalCh1:
-                state = OSPARSyntaxError;
+                if(jsonToken == tokArray)
+                {
+                    memcpy(&iDLogT, &pjcmd.iDLog1, sizeof(iDLogT)); 
+                    memcpy(&pchJSONRespBuff[odata[0].cb], szCh1Array, sizeof(szCh1Array)-1); 
+                    odata[0].cb += sizeof(szCh1Array)-1;
+
+                    iDLogT.state.parsing = Idle;
+                    rgStrU32 = rgStrU32logDigital;
+                    cStrU32 = sizeof(rgStrU32logDigital) / sizeof(STRU32);
+                    stateEndArray = OSPARLogDigitalChEnd;
+                    stateEndObject = OSPARLogDigitalObjectEnd;
+                    state = OSPARSkipObject;
+                }
+                break;
+
+            case OSPARLogDigitalCmd:
+                if(jsonToken == tokStringValue)
+                {
+                    iDLogT.state.parsing = (STATE) Uint32FromStr(rgStrU32LogDigitalCmd, sizeof(rgStrU32LogDigitalCmd) / sizeof(STRU32), szToken, cbToken);
+                    if(iDLogT.state.parsing != OSPARSyntaxError) state = OSPARSkipValueSep;
+                }
+                break;
+
+            case OSPARLogDigitalMaxSampleCount:
+                if(jsonToken == tokNumber && cbToken < 32)
+                {
+                    char szT[32];
+                    memcpy(szT, szToken, cbToken);
+                    szT[cbToken] = '\0';
+                    iDLogT.maxSamples = atoll(szT);
+                    state = OSPARSkipValueSep;
+                }
+                break;
+
+            case OSPARLogDigitalSampleFreq:
+                if(jsonToken == tokNumber && cbToken <= 20)
+                {
+                    char szT[32];
+                    memcpy(szT, szToken, cbToken);
+                    szT[cbToken] = '\0';
+                    iDLogT.bidx.xsps = atoll(szT);
+                    state = OSPARSkipValueSep;
+                }
+                break;
+
+            case OSPARLogDigitalStorageLocation:
+                if(jsonToken == tokStringValue)
+                {
+                    iDLogT.vol = (VOLTYPE) Uint32FromStr(rgStrU32FileVol, sizeof(rgStrU32FileVol) / sizeof(STRU32), szToken, cbToken, VOLSD);
+                    state = OSPARSkipValueSep;
+                }
+                break;
+
+            case OSPARLogDigitalURI:
+                if(jsonToken == tokStringValue)
+                {
+                    if(cbToken > MAX_PATH) cbToken = MAX_PATH;
+                    memcpy(iDLogT.szURI, szToken, cbToken);
+                    iDLogT.szURI[cbToken] = '\0';
+                    state = OSPARSkipValueSep;
+                }
+                break;
+
+            case OSPARLogDigitalBitMask:
+                if(jsonToken == tokNumber && cbToken < 32)
+                {
+                    char szT[32];
+                    memcpy(szT, szToken, cbToken);
+                    szT[cbToken] = '\0';
+                    iDLogT.bitMask = atoi(szT);
+                    state = OSPARSkipValueSep;
+                }
+                break;
+
+            case OSPARLogDigitalObjectEnd:
+                if(jsonToken == tokEndObject)
+                {  
+                    int i = 0;
+
+                    stateValueSep = OSPARSeparatedObject;
+                    state = OSPARSkipValueSep;
+
+                    switch(iDLogT.state.parsing)
+                    {
+                        case OSPARLogDigitalSetParams:
+                            {
+                                FRESULT     fr      = FR_INVALID_NAME;
+                                IDLOG&      idlog   = pjcmd.iDLog1;
+                                DFILE&      dFile   = *((DFILE *) idlog.pdFile);
+                                LogHeader   logHdr  = LogHeader(sizeof(DLogRun), DLOGFMT);
+                                uint32_t    cbHdr   = 0;  
+
+                                // set parameters
+                                memcpy(&pchJSONRespBuff[odata[0].cb], szSetParmStatusCode, sizeof(szSetParmStatusCode)-1); 
+                                odata[0].cb += sizeof(szSetParmStatusCode)-1;
+
+                                // calculate actual usps, the LA timer can not count rolls so very slow rates are out
+                                if(iDLogT.bidx.xsps > 0 && iDLogT.bidx.xsps <= DLOGuSPS)
+                                {
+                                    iDLogT.bidx.xsps = CalculatePreScalarAndPeriod(iDLogT.bidx.xsps, 1000000, iDLogT.bidx.pbClkSampTmr, &iDLogT.bidx.tmrPreScalar, &iDLogT.bidx.tmrPeriod, &iDLogT.bidx.tmrCnt);
+                                }
+
+                                // some parameter checks
+                                if( iDLogT.bidx.xsps == 0 || iDLogT.bidx.xsps > DLOGuSPS || iDLogT.bidx.tmrCnt > 1 || iDLogT.bitMask == 0     || 
+                                    iDLogT.vol != VOLSD || iDLogT.maxSamples < -1 || iDLogT.maxSamples == 0                                     ||
+                                    (iDLogT.maxSamples > 0 && ((iDLogT.maxSamples * 1000000) / iDLogT.bidx.xsps) >= LOGMAXSECDELAY)              )
+                                {
+                                    utoa(ValueOutOfRange, &pchJSONRespBuff[odata[0].cb], 10);
+                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                }
+
+                                // see if we are in use, we share the LA DMA with the AWG
+                                else if(!(IsLogxIdle(idlog) && IsLAIdle() && IsAWGIdle()))
+                                {
+                                    // put out an error
+                                    utoa(InstrumentInUse, &pchJSONRespBuff[odata[0].cb], 10);
+                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                }
+
+                                // create the file
+                                else if(iDLogT.szURI[0] == 0 || dFile ||
+                                        (fr = DFATFS::fschdrive(DFATFS::szFatFsVols[iDLogT.vol]))                               != FR_OK    || 
+                                        (fr = DFATFS::fschdir(DFATFS::szRoot))                                                  != FR_OK    ||
+                                        (fr = dFile.fsopen(iDLogT.szURI, FA_CREATE_ALWAYS | FA_WRITE))                          != FR_OK    ||
+                                        (fr = dFile.fswrite(&logHdr, sizeof(logHdr), &cbHdr, DFILE::FS_INFINITE_SECTOR_CNT))    != FR_OK    )
+                                {                                   
+                                    utoa((CFGFileSystemError | fr), &pchJSONRespBuff[odata[0].cb], 10);
+                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+
+                                    // close the file if it got opened.
+                                    if(dFile) dFile.fsclose();
+                                }
+
+                                else 
+                                {
+                                    dFile.fsclose();
+
+                                    // put in status code
+                                    pchJSONRespBuff[odata[0].cb++] = '0';
+
+                                    // we want to set this to the Waiting state so we 
+                                    // know to set up the instrument.
+                                    iDLogT.state.processing = Waiting;
+
+                                    // just kill competing instruments
+                                    pjcmd.ila.state.processing      = Idle;
+
+                                    // copy over the current state into the object
+                                    memcpy(&idlog, &iDLogT, sizeof(iDLogT)); 
+
+                                    iDLogT.state.parsing = OSPARLogDigitalCompleteParams;
+
+                                    // returning a non Idle, non-error will cause the parent
+                                    // state machines to yield and continue with no change in input stream parsing.
+                                    return(OSPARLogDigitalCompleteParams);
+                                }
+
+                                // wait time
+                                memcpy(&pchJSONRespBuff[odata[0].cb], szWait0, sizeof(szWait0)-1); 
+                                odata[0].cb += sizeof(szWait0)-1;
+                            }
+                            break;
+
+                        case OSPARLogGetCurrentState:
+                            {
+                                IDLOG&      idlog   = pjcmd.iDLog1;
+
+                                // get current state
+                                memcpy(&pchJSONRespBuff[odata[0].cb], szGetCurrentStateStatusCode, sizeof(szGetCurrentStateStatusCode)-1); 
+                                odata[0].cb += sizeof(szGetCurrentStateStatusCode)-1;
+
+                                // put in status code
+                                pchJSONRespBuff[odata[0].cb++] = '0';
+
+                                // the running  state 
+                                memcpy(&pchJSONRespBuff[odata[0].cb], szState, sizeof(szState)-1); 
+                                odata[0].cb += sizeof(szState)-1;
+
+                                // put out the instrument state
+                                switch(idlog.state.processing)
+                                {
+                                    case Idle:
+                                    case Stopped:
+                                    case Running:
+                                        strcpy(&pchJSONRespBuff[odata[0].cb], rgInstrumentStates[idlog.state.processing]); 
+                                        break;
+
+                                    case Waiting:
+                                        strcpy(&pchJSONRespBuff[odata[0].cb], rgInstrumentStates[Idle]); 
+                                        break;
+
+                                    // otherwise unknown states are just busy
+                                    default:
+                                        strcpy(&pchJSONRespBuff[odata[0].cb], rgInstrumentStates[Busy]); 
+                                        break;
+                                }
+                                odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]); 
+
+                                // the stopped reason 
+                                if (idlog.state.processing == Stopped)
+                                {
+                                    memcpy(&pchJSONRespBuff[odata[0].cb], szStopReason, sizeof(szStopReason)-1); 
+                                    odata[0].cb += sizeof(szStopReason)-1;
+                                    strcpy(&pchJSONRespBuff[odata[0].cb], rgszSTCD[idlog.stcd]); 
+                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]); 
+                                }
+
+                                // put out how many samples have been encoded
+                                memcpy(&pchJSONRespBuff[odata[0].cb], szActualCount, sizeof(szActualCount)-1); 
+                                odata[0].cb += sizeof(szActualCount)-1;
+                                illtoa((idlog.state.processing == Running || idlog.state.processing == Stopped) ? ((int64_t) idlog.bidx.cSavedRoll) * DLOGDMASIZE + idlog.bidx.iDMAStart : 0, &pchJSONRespBuff[odata[0].cb], 10);
+                                odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+
+                                // fill out the rest of the parameters
+                                memcpy(&iDLogT, &idlog, sizeof(iDLogT)); 
+                                iDLogT.state.parsing = OSPARLogDigitalCompleteParams;
+
+                                // returning a non Idle, non-error will cause the parent
+                                // state machines to yield and continue with no change in input stream parsing.
+                                return(OSPARLogDigitalCompleteParams);
+                            }
+                            break;
+
+                        case OSPARLogDigitalCompleteParams:
+
+                            // put out max sample count
+                            memcpy(&pchJSONRespBuff[odata[0].cb], szMaxSampleCount, sizeof(szMaxSampleCount)-1); 
+                            odata[0].cb += sizeof(szMaxSampleCount)-1;
+                            illtoa(iDLogT.maxSamples, &pchJSONRespBuff[odata[0].cb], 10);
+                            odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+
+                            // put out the sps Freq
+                            memcpy(&pchJSONRespBuff[odata[0].cb], szActualSampleFreq, sizeof(szActualSampleFreq)-1); 
+                            odata[0].cb += sizeof(szActualSampleFreq)-1;
+                            ulltoa(iDLogT.bidx.xsps, &pchJSONRespBuff[odata[0].cb], 10);
+                            odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+
+                            // put out the bitmask
+                            memcpy(&pchJSONRespBuff[odata[0].cb], szBitMask, sizeof(szBitMask)-1); 
+                            odata[0].cb += sizeof(szBitMask)-1;
+                            utoa(iDLogT.bitMask, &pchJSONRespBuff[odata[0].cb], 10);
+                            odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+
+                            // put out the storage location
+                            memcpy(&pchJSONRespBuff[odata[0].cb], szStorageLocation, sizeof(szStorageLocation)-1); 
+                            odata[0].cb += sizeof(szStorageLocation)-1;
+                            i = strlen(rgVOLNames[iDLogT.vol]);
+                            memcpy(&pchJSONRespBuff[odata[0].cb], rgVOLNames[iDLogT.vol], i); 
+                            odata[0].cb += i;
+                            pchJSONRespBuff[odata[0].cb++] = '\"';
+ 
+                            // put out the uri
+                            memcpy(&pchJSONRespBuff[odata[0].cb], szURI, sizeof(szURI)-1); 
+                            odata[0].cb += sizeof(szURI)-1;
+                            i = strlen(iDLogT.szURI);
+                            memcpy(&pchJSONRespBuff[odata[0].cb], iDLogT.szURI, i); 
+                            odata[0].cb += i;
+                            pchJSONRespBuff[odata[0].cb++] = '\"';
+
+                            // wait time
+                            memcpy(&pchJSONRespBuff[odata[0].cb], szWait0, sizeof(szWait0)-1); 
+                            odata[0].cb += sizeof(szWait0)-1;
+                            break;
+
+                        case OSPARLogRun:
+                            {
+                                FRESULT fr = FR_INVALID_NAME;
+                                IDLOG&  idlog = pjcmd.iDLog1;
+                                DFILE&  dFile = *((DFILE *) idlog.pdFile);
+
+                                // run
+                                memcpy(&pchJSONRespBuff[odata[0].cb], szRunStatus, sizeof(szRunStatus)-1); 
+                                odata[0].cb += sizeof(szRunStatus)-1;
+
+                                if(idlog.state.processing == Idle)
+                                {
+                                    utoa(InstrumentNotConfigured, &pchJSONRespBuff[odata[0].cb], 10);
+                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+
+                                    // wait time
+                                    memcpy(&pchJSONRespBuff[odata[0].cb], szWait0, sizeof(szWait0)-1); 
+                                    odata[0].cb += sizeof(szWait0)-1;
+                                }
+
+                                else if(!(IsLAIdle() && IsAWGIdle() && (idlog.state.processing == Waiting || idlog.state.processing == Stopped) && idlog.buffLock == LOCKAvailable))
+                                {
+                                    utoa(InstrumentInUse, &pchJSONRespBuff[odata[0].cb], 10);
+                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+
+                                    // wait time
+                                    memcpy(&pchJSONRespBuff[odata[0].cb], szWait0, sizeof(szWait0)-1); 
+                                    odata[0].cb += sizeof(szWait0)-1;
+                                }
+
+                                else if(dFile ||
+                                        (fr = DFATFS::fschdrive(DFATFS::szFatFsVols[idlog.vol]))        != FR_OK    || 
+                                        (fr = DFATFS::fschdir(DFATFS::szRoot))                          != FR_OK    ||
+                                        (fr = dFile.fsopen(idlog.szURI, FA_OPEN_EXISTING | FA_WRITE))   != FR_OK    ||
+                                        (fr = dFile.fslseek(sizeof(LogHeader)))                         != FR_OK    )
+                                {                                   
+                                    if(dFile) dFile.fsclose();
+                                    utoa((CFGFileSystemError | fr), &pchJSONRespBuff[odata[0].cb], 10);
+                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+
+                                    // wait time
+                                    memcpy(&pchJSONRespBuff[odata[0].cb], szWait0, sizeof(szWait0)-1); 
+                                    odata[0].cb += sizeof(szWait0)-1;
+                                }
+
+                                else 
+                                {
+                                    // put in status code
+                                    pchJSONRespBuff[odata[0].cb++] = '0';
+
+                                    idlog.state.processing = (idlog.state.processing == Waiting) ? Queued : Working;
+                                    idlog.buffLock = LOCKAcq;
+
+                                    // truncate the file just past the header; close it
+                                    dFile.fstruncate();
+                                    dFile.fsclose();
+
+                                    // wait time
+                                    memcpy(&pchJSONRespBuff[odata[0].cb], szWaitUntil, sizeof(szWaitUntil)-1); 
+                                    odata[0].cb += sizeof(szWaitUntil)-1;
+                                }                               
+                            }
+                            break;
+
+                        case OSPARLogStop:
+                            {
+                                IDLOG&      idlog   = pjcmd.iDLog1;
+                                char const * szTime = szWait0;
+                                uint32_t    cbTime;
+                            
+                                // stop
+                                memcpy(&pchJSONRespBuff[odata[0].cb], szStopStatus, sizeof(szStopStatus)-1); 
+                                odata[0].cb += sizeof(szStopStatus)-1;
+
+                                if(idlog.state.processing == Running)
+                                {
+                                    STATE curState = DLOGStop(&idlog);
+
+                                    if(curState == Idle)
+                                    {
+                                        // put in status code
+                                        pchJSONRespBuff[odata[0].cb++] = '0';
+                                        szTime = szWait500;
+                                    }
+                                    else
+                                    {
+                                        utoa(curState, &pchJSONRespBuff[odata[0].cb], 10);
+                                        odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                    }
+                                }
+
+                                else if(IsLogxIdle(idlog))
+                                {
+                                    // put in status code
+                                    pchJSONRespBuff[odata[0].cb++] = '0';
+                                }
+
+                                else
+                                {
+                                    utoa(InstrumentInUse, &pchJSONRespBuff[odata[0].cb], 10);
+                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                }
+
+                                // wait time
+                                cbTime = strlen(szTime);
+                                memcpy(&pchJSONRespBuff[odata[0].cb], szTime, cbTime); 
+                                odata[0].cb += cbTime;
+                            }
+                            break;
+
+                        // got a syntax error
+                        default:
+                            state = OSPARSyntaxError;
+                            break;
+                    }
+                }
+                break;
+
+           case OSPARLogDigitalChEnd:
+                if(jsonToken == tokEndArray)
+                {
+                    memcpy(&pchJSONRespBuff[odata[0].cb], szEndArray, sizeof(szEndArray)-1); 
+                    odata[0].cb += sizeof(szEndArray)-1;
+
+                    rgStrU32 = rgStrU32logDigitalChannel;
+                    cStrU32 = sizeof(rgStrU32logDigitalChannel) / sizeof(STRU32);
+
+                    stateEndArray = OSPARSyntaxError;
+                    stateEndObject = OSPARLogObjectEnd;
+                    stateValueSep = OSPARSeparatedNameValue;
+                    state = OSPARSkipValueSep;
+                }
                 break;
 
             /************************************************************************/
@@ -1675,6 +2278,49 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                     cStrU32 = sizeof(rgStrU32Endpoint) / sizeof(STRU32);
                     state = OSPARMemberName;
                 }
+
+                // a batch, an array of command objects run in order with one array of responses
+                else if(jsonToken == tokArray)
+                {
+                    odata[0].cb = sizeof(szStartArray)-1;
+                    memcpy(pchJSONRespBuff, szStartArray, odata[0].cb);  
+                    fBatch = true;
+                    state = OSPARBatchObject;
+                }
+                break;
+
+            case OSPARBatchObject:
+                if(jsonToken == tokObject)
+                {
+                    // fresh temps for each command, but the binary offset runs across the whole batch
+                    memset(&triggerT, 0, sizeof(triggerT));
+                    memset(&idcT, 0, sizeof(idcT));
+                    memset(&ioscT, 0, sizeof(ioscT));
+
+                    memcpy(&pchJSONRespBuff[odata[0].cb], szStartObject, sizeof(szStartObject)-1); 
+                    odata[0].cb += sizeof(szStartObject)-1;
+                    rgStrU32 = rgStrU32Endpoint;
+                    cStrU32 = sizeof(rgStrU32Endpoint) / sizeof(STRU32);
+                    state = OSPARMemberName;
+                }
+                else state = OSPARSyntaxError;
+                break;
+
+            case OSPARBatchNext:
+                if(jsonToken == tokValueSep)
+                {
+                    memcpy(&pchJSONRespBuff[odata[0].cb], szValueSep, sizeof(szValueSep)-1); 
+                    odata[0].cb += sizeof(szValueSep)-1;
+                    state = OSPARBatchObject;
+                }
+                else if(jsonToken == tokEndArray)
+                {
+                    memcpy(&pchJSONRespBuff[odata[0].cb], szEndArray, sizeof(szEndArray)-1); 
+                    odata[0].cb += sizeof(szEndArray)-1;
+                    fBatch = false;
+                    state = Idle;
+                }
+                else state = OSPARSyntaxError;
                 break;
 
             case OSPARSkipObject:
@@ -1689,6 +2335,25 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                 {
                     stateNameSep = (STATE) Uint32FromStr(rgStrU32, cStrU32, szToken, cbToken);
                     state = OSPARSkipNameSep;
+
+                    if(rgStrU32 == rgStrU32Endpoint)
+                    {
+                        uint32_t i = 0;
+
+                        for(i = 0; i < cStrU32 && rgStrU32Endpoint[i].u32 != (uint32_t) stateNameSep; i++);
+
+                        // a readWhenReady on another parser holds this end point, let it finish first
+                        // and let it have ParseToken back while we wait
+                        if(i < cStrU32 && rgpEndpointOwner[i] != NULL && rgpEndpointOwner[i] != this)
+                        {
+                            state = curState;
+                            pParseOwner = NULL;
+                            return(Waiting);
+                        }
+
+                        // the first end point names the command in the latency stats
+                        if(i < cStrU32 && iCmdStat == CMDSTATTYPES-1) iCmdStat = i;
+                    }
                 }
                 break;
 
@@ -1755,7 +2420,13 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
 //                pchJSONRespBuff[odata[0].cb++] = '\r';
 //                pchJSONRespBuff[odata[0].cb++] = '\n';
 
-                state = Idle;
+                // in a batch, this token is the separator or the end of the batch
+                if(fBatch)
+                {
+                    state = OSPARBatchNext;
+                    fContinue = true;
+                }
+                else state = Idle;
                 break;
 
             case OSPARTopEndArray:
@@ -2178,7 +2849,8 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
 
                         case OSPARFileRead:
 
-                            if(dGFile)
+                            // another parser may be reading or writing a file
+                            if(dGFile || uicmd.iFile.buffLock != LOCKAvailable)
                             {
                                 utoa(FileInUse, &pchJSONRespBuff[odata[0].cb], 10);
                                 odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
@@ -2446,38 +3118,46 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
             case OSPARDeviceEnmerate:
                 if(jsonToken == tokStringValue)
                 {
-                    memcpy(&pchJSONRespBuff[odata[0].cb], szEnumeration1, sizeof(szEnumeration1)-1); 
-                    odata[0].cb += sizeof(szEnumeration1)-1;
+                    // only the calibration source changes, so build it once and copy it after that
+                    if(!RespFromCache(RCEnumerate))
+                    {
+                        uint32_t iStart = odata[0].cb;
 
-                    // put version number in
-                    strcpy(&pchJSONRespBuff[odata[0].cb], szEnumVersion);
-                    odata[0].cb += strlen(szEnumVersion);
+                        memcpy(&pchJSONRespBuff[odata[0].cb], szEnumeration1, sizeof(szEnumeration1)-1); 
+                        odata[0].cb += sizeof(szEnumeration1)-1;
 
-                    // put MAC address out
-                    memcpy(&pchJSONRespBuff[odata[0].cb], szEnumeration2, sizeof(szEnumeration2)-1); 
-                    odata[0].cb += sizeof(szEnumeration2)-1;
+                        // put version number in
+                        strcpy(&pchJSONRespBuff[odata[0].cb], szEnumVersion);
+                        odata[0].cb += strlen(szEnumVersion);
 
-                    // Print out our MAC address
-                    GetNumb(macOpenScope.u8, sizeof(macOpenScope), ':', &pchJSONRespBuff[odata[0].cb]);
-                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                        // put MAC address out
+                        memcpy(&pchJSONRespBuff[odata[0].cb], szEnumeration2, sizeof(szEnumeration2)-1); 
+                        odata[0].cb += sizeof(szEnumeration2)-1;
 
-                    memcpy(&pchJSONRespBuff[odata[0].cb], szEnumeration3, sizeof(szEnumeration3)-1); 
-                    odata[0].cb += sizeof(szEnumeration3)-1;
+                        // Print out our MAC address
+                        GetNumb(macOpenScope.u8, sizeof(macOpenScope), ':', &pchJSONRespBuff[odata[0].cb]);
+                        odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
 
-                    // put in the calibration source  
-                    strcpy(&pchJSONRespBuff[odata[0].cb], rgCFGNames[((IDHDR *) rgInstr[OSC2_ID])->cfg]);
-                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                        memcpy(&pchJSONRespBuff[odata[0].cb], szEnumeration3, sizeof(szEnumeration3)-1); 
+                        odata[0].cb += sizeof(szEnumeration3)-1;
 
-                    // put MAC address out
-                    memcpy(&pchJSONRespBuff[odata[0].cb], szEnumeration4, sizeof(szEnumeration4)-1); 
-                    odata[0].cb += sizeof(szEnumeration4)-1;
+                        // put in the calibration source  
+                        strcpy(&pchJSONRespBuff[odata[0].cb], rgCFGNames[((IDHDR *) rgInstr[OSC2_ID])->cfg]);
+                        odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
 
-                    // Print out our MAC address
-                    GetNumb(macOpenScope.u8, sizeof(macOpenScope), ':', &pchJSONRespBuff[odata[0].cb]);
-                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                        // put MAC address out
+                        memcpy(&pchJSONRespBuff[odata[0].cb], szEnumeration4, sizeof(szEnumeration4)-1); 
+                        odata[0].cb += sizeof(szEnumeration4)-1;
+
+                        // Print out our MAC address
+                        GetNumb(macOpenScope.u8, sizeof(macOpenScope), ':', &pchJSONRespBuff[odata[0].cb]);
+                        odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
 
-                    memcpy(&pchJSONRespBuff[odata[0].cb], szEnumeration5, sizeof(szEnumeration5)-1); 
-                    odata[0].cb += sizeof(szEnumeration5)-1;
+                        memcpy(&pchJSONRespBuff[odata[0].cb], szEnumeration5, sizeof(szEnumeration5)-1); 
+                        odata[0].cb += sizeof(szEnumeration5)-1;
+
+                        RespToCache(RCEnumerate, iStart);
+                    }
 
                     // get next member name
                     stateEndObject = OSPARDeviceEndObject;
@@ -2550,6 +3230,27 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                     odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
                     maxLogWrittenCnt = 0;
 
+                    // report the worst of the two analog logs
+                    {
+                        uint32_t    tLogSector  = max(pjcmd.iALog1.tLogSector, pjcmd.iALog2.tLogSector);
+                        int32_t     logHeadroom = 100;
+
+                        if(pjcmd.iALog1.tLogSector != 0) logHeadroom = min(logHeadroom, pjcmd.iALog1.logHeadroom);
+                        if(pjcmd.iALog2.tLogSector != 0) logHeadroom = min(logHeadroom, pjcmd.iALog2.logHeadroom);
+
+                        memcpy(&pchJSONRespBuff[odata[0].cb], szLogSectorTime, sizeof(szLogSectorTime)-1); 
+                        odata[0].cb += sizeof(szLogSectorTime)-1;
+
+                        utoa((tLogSector / CORE_TMR_TICKS_PER_USEC), &pchJSONRespBuff[odata[0].cb], 10);
+                        odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+
+                        memcpy(&pchJSONRespBuff[odata[0].cb], szLogHeadroom, sizeof(szLogHeadroom)-1); 
+                        odata[0].cb += sizeof(szLogHeadroom)-1;
+
+                        itoa((logHeadroom), &pchJSONRespBuff[odata[0].cb], 10);
+                        odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                    }
+
                     memcpy(&pchJSONRespBuff[odata[0].cb], szMaxSDBusyTime, sizeof(szMaxSDBusyTime)-1); 
                     odata[0].cb += sizeof(szMaxSDBusyTime)-1;
 
@@ -2564,8 +3265,61 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                     odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
                     dSDVol.maxBusyInARow = 0;
 
-                    memcpy(&pchJSONRespBuff[odata[0].cb], szStatus0Wait0, sizeof(szStatus0Wait0)-1); 
-                    odata[0].cb += sizeof(szStatus0Wait0)-1;
+                    // TCP transmit since the last loopStats, or since boot; the span is in msec as the core timer wraps in 43 sec
+                    // the build time is in core timer ticks, which are half the CPU clock
+                    {
+                        uint32_t tCur   = SYSGetMilliSecond();
+                        uint32_t tSpan  = tCur - tTCPStats;
+
+                        resp.Append(szTCPBytesSent).AppendU32(g_tcpTxStats.cbPayload);
+                        resp.Append(szTCPBytesPerSec).AppendU32((tSpan == 0) ? 0 : (uint32_t) ((((uint64_t) g_tcpTxStats.cbPayload) * 1000) / tSpan));
+                        resp.Append(szTCPCyclesPerKB).AppendU32((g_tcpTxStats.cbPayload == 0) ? 0 : (uint32_t) ((((uint64_t) g_tcpTxStats.tBuild) * 2 * 1024) / g_tcpTxStats.cbPayload));
+                        resp.Append(szTCPSegments).AppendU32(g_tcpTxStats.cSegments);
+                        resp.Append(szTCPRetransmits).AppendU32(g_tcpTxStats.cRetransmit);
+                        resp.Append(szTCPFastRetransmits).AppendU32(g_tcpTxStats.cFastRetransmit);
+
+                        memset(&g_tcpTxStats, 0, sizeof(g_tcpTxStats));
+                        tTCPStats = tCur;
+                    }
+
+                    // latency histograms for the commands we have seen, bucket i is 2^i to 2^(i+1) usec
+                    resp.Append(szCmdLatency);
+                    for(uint32_t iCmd = 0, cCmd = 0; iCmd < CMDSTATTYPES; iCmd++)
+                    {
+                        uint32_t cSeen = 0;
+
+                        for(uint32_t iBucket = 0; iBucket < CMDSTATBUCKETS; iBucket++) cSeen += rgCmdStats[iCmd][0][iBucket];
+                        if(cSeen == 0) continue;
+
+                        if(cCmd++ > 0) resp.Append(',');
+                        resp.Append('"');
+                        if(iCmd < CMDSTATTYPES-1) resp.Append(rgStrU32Endpoint[iCmd].szToken, rgStrU32Endpoint[iCmd].cbToken);
+                        else resp.Append(szCmdOther);
+
+                        for(uint32_t iPhase = 0; iPhase < CMDSTATPHASES; iPhase++)
+                        {
+                            resp.AppendSz(rgszCmdPhases[iPhase]);
+                            for(uint32_t iBucket = 0; iBucket < CMDSTATBUCKETS; iBucket++)
+                            {
+                                if(iBucket > 0) resp.Append(',');
+                                resp.AppendU32(rgCmdStats[iCmd][iPhase][iBucket]);
+                            }
+                        }
+                        resp.Append(szCmdPhasesEnd);
+                    }
+                    resp.Append('}');
+                    memset(rgCmdStats, 0, sizeof(rgCmdStats));
+
+                    // it did not fit, put out just the command and why
+                    if(resp.Overflow())
+                    {
+                        resp.Rewind().Append(szLoopStatsStatusCode).AppendU32(ResponseTooLarge).Append(szWait0);
+                    }
+                    else
+                    {
+                        memcpy(&pchJSONRespBuff[odata[0].cb], szStatus0Wait0, sizeof(szStatus0Wait0)-1); 
+                        odata[0].cb += sizeof(szStatus0Wait0)-1;
+                    }
 
                     // get next member name
                     stateEndObject = OSPARDeviceEndObject;
@@ -2612,17 +3366,25 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
             case OSPARDeviceStorageGetLocations:
                 if(jsonToken == tokStringValue)
                 {
-                    memcpy(&pchJSONRespBuff[odata[0].cb], szStorageGetLocationsFlash, sizeof(szStorageGetLocationsFlash)-1); 
-                    odata[0].cb += sizeof(szStorageGetLocationsFlash)-1;
-
-                    if(DFATFS::fsvolmounted(DFATFS::szFatFsVols[VOLSD]))
+                    // only changes when the SD card comes or goes
+                    if(!RespFromCache(RCStorageGetLocations))
                     {
-                        memcpy(&pchJSONRespBuff[odata[0].cb], szStorageGetLocationsSd0, sizeof(szStorageGetLocationsSd0)-1); 
-                        odata[0].cb += sizeof(szStorageGetLocationsSd0)-1;
-                    }
+                        uint32_t iStart = odata[0].cb;
 
-                    memcpy(&pchJSONRespBuff[odata[0].cb], szDeviceEnd, sizeof(szDeviceEnd)-1); 
-                    odata[0].cb += sizeof(szDeviceEnd)-1;
+                        memcpy(&pchJSONRespBuff[odata[0].cb], szStorageGetLocationsFlash, sizeof(szStorageGetLocationsFlash)-1); 
+                        odata[0].cb += sizeof(szStorageGetLocationsFlash)-1;
+
+                        if(DFATFS::fsvolmounted(DFATFS::szFatFsVols[VOLSD]))
+                        {
+                            memcpy(&pchJSONRespBuff[odata[0].cb], szStorageGetLocationsSd0, sizeof(szStorageGetLocationsSd0)-1); 
+                            odata[0].cb += sizeof(szStorageGetLocationsSd0)-1;
+                        }
+
+                        memcpy(&pchJSONRespBuff[odata[0].cb], szDeviceEnd, sizeof(szDeviceEnd)-1); 
+                        odata[0].cb += sizeof(szDeviceEnd)-1;
+
+                        RespToCache(RCStorageGetLocations, iStart);
+                    }
 
                     // just go to Device end because this a simple string
                     // get next member name
@@ -2757,9 +3519,15 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                                 odata[0].cb += sizeof(szWait0)-1;
                             }
 
+                            // nothing has changed since we last built it
+                            else if(RespFromCache(RCCalibrationRead))
+                            {
+                            }
+
                             // we can read the calibration info
                             else
                             {
+                                uint32_t iStart = odata[0].cb;
 								uint32_t id	= NULL_ID;
 								uint32_t ig	= 0;
 								uint32_t cb	= 0;
@@ -2962,6 +3730,8 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                                 memcpy(&pchJSONRespBuff[odata[0].cb], szDeviceCalDataEnd, sizeof(szDeviceCalDataEnd)-1); 
                                 odata[0].cb += sizeof(szDeviceCalDataEnd)-1;
 
+                                RespToCache(RCCalibrationRead, iStart);
+
                             }
 
                             pjcmd.iCal.state.parsing = Idle;
@@ -4550,10 +5320,11 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
 
                         case JSPARAwgRun:
 
-                            // see if we can run the AWG
+                            // see if we can run the AWG; not while the digital logger has the timer and DMA it runs on
                             if((pjcmd.iawg.state.processing == Stopped                              ||
                                 pjcmd.iawg.state.processing == JSPARAwgWaitingRegularWaveform       || 
-                                pjcmd.iawg.state.processing == JSPARAwgWaitingArbitraryWaveform)    ) 
+                                pjcmd.iawg.state.processing == JSPARAwgWaitingArbitraryWaveform)    &&
+                                !IsDLOGRunning()                                                    ) 
                             {
                                 if(pjcmd.iawg.state.processing == JSPARAwgWaitingRegularWaveform)           pjcmd.iawg.state.processing = JSPARAwgRunRegularWaveform;
                                 else if(pjcmd.iawg.state.processing == JSPARAwgWaitingArbitraryWaveform)    pjcmd.iawg.state.processing = JSPARAwgRunArbitraryWaveform;
@@ -4805,6 +5576,15 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                 }
                 break;
 
+            case OSPAROscReadWhenReady:
+                if(jsonToken == tokStringValue)
+                {
+                    state = OSPARSkipValueSep;
+                    ioscT.state.parsing = JSPAROscReadWhenReady;
+                    tWhenReady = ReadCoreTimer();
+                }
+                break;
+
             case OSPAROscGetCurrentState:
                 if(jsonToken == tokStringValue)
                 {
@@ -4909,11 +5689,34 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
 
                             break;
 
+                        case JSPAROscReadWhenReady:
+
+                            // while the trigger is still running, yield; the main loop keeps running
+                            // and we come back here with the same end object token
+                            if( iosc.state.processing == Armed                                                                  && 
+                                (pjcmd.trigger.state.processing == Run || pjcmd.trigger.state.processing == Armed)              &&
+                                (ReadCoreTimer() - tWhenReady) < MAXTICKSWHENREADY                                              )
+                            {
+                                // let other parsers run while we wait, but keep them off the osc
+                                ClaimEndpoint(OSPAROscChannelObject);
+                                pParseOwner = NULL;
+                                return(JSPAROscReadWhenReady);
+                            }
+
+                            // now it is just a read, of the acquisition as it is now; keep the acqCount we were asked for
+                            ReleaseEndpoints();
+                            {
+                                uint32_t acqCountT = ioscT.acqCount;
+                                memcpy(&ioscT, &iosc, sizeof(ioscT));
+                                ioscT.acqCount = acqCountT;
+                            }
+                            ioscT.state.parsing = JSPAROscRead;
+                            // fall thru
+
                         case JSPAROscRead:
 
                             // put out the command and status
-                            memcpy(&pchJSONRespBuff[odata[0].cb], szReadStatusCode, sizeof(szReadStatusCode)-1); 
-                            odata[0].cb += sizeof(szReadStatusCode)-1;
+                            resp.Append(szReadStatusCode);
   
                             if(ioscT.state.processing == Triggered && ioscT.buffLock == LOCKAvailable)
                             {
@@ -4927,8 +5730,7 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                                 if(ioscT.acqCount > acqCountBuf)
                                 {
                                     // Error Code
-                                    utoa(AcqCountTooOld, &pchJSONRespBuff[odata[0].cb], 10);
-                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                    resp.AppendU32(AcqCountTooOld);
                                 }
 
                                 else
@@ -4937,14 +5739,11 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                                     ioscT.buffLock = LOCKOutput;
 
                                     // status code
-                                    pchJSONRespBuff[odata[0].cb] = '0';
-                                    odata[0].cb++;
+                                    resp.Append('0');
 
                                     // binary offset
-                                    memcpy(&pchJSONRespBuff[odata[0].cb], szBinaryOffset, sizeof(szBinaryOffset)-1); 
-                                    odata[0].cb += sizeof(szBinaryOffset)-1;
-                                    utoa(iBinOffset, &pchJSONRespBuff[odata[0].cb], 10);
-                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                    resp.Append(szBinaryOffset);
+                                    resp.AppendU32(iBinOffset);
 
                                     // fill in the binary location info
                                     odata[cOData].cb = ioscT.bidx.cBuff * sizeof(int16_t);
@@ -4953,10 +5752,8 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
 //                                    odata[cOData].pbOut = (uint8_t *) &ioscT.pBuff[ioscT.iStartRetBuf];
 
                                     // binary length 
-                                    memcpy(&pchJSONRespBuff[odata[0].cb], szBinaryLength, sizeof(szBinaryLength)-1); 
-                                    odata[0].cb += sizeof(szBinaryLength)-1;
-                                    utoa(odata[cOData].cb, &pchJSONRespBuff[odata[0].cb], 10);
-                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                    resp.Append(szBinaryLength);
+                                    resp.AppendU32(odata[cOData].cb);
 
                                     // update the offset for the next one
                                     ioscT.iBinOffset = iBinOffset;
@@ -4964,50 +5761,36 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
 
                                     // Put out the acqCount
                                     ioscT.acqCount = acqCountBuf;
-                                    memcpy(&pchJSONRespBuff[odata[0].cb], szAcqCount, sizeof(szAcqCount)-1); 
-                                    odata[0].cb += sizeof(szAcqCount)-1;
-                                    utoa(acqCountBuf, &pchJSONRespBuff[odata[0].cb], 10);
-                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                    resp.Append(szAcqCount);
+                                    resp.AppendU32(acqCountBuf);
 
                                     // put out the sps Freq
-                                    memcpy(&pchJSONRespBuff[odata[0].cb], szActualSampleFreq, sizeof(szActualSampleFreq)-1); 
-                                    odata[0].cb += sizeof(szActualSampleFreq)-1;
-                                    ulltoa(ioscT.bidx.xsps, &pchJSONRespBuff[odata[0].cb], 10);
-                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                    resp.Append(szActualSampleFreq);
+                                    resp.AppendU64(ioscT.bidx.xsps);
 
                                     // POI
-                                    memcpy(&pchJSONRespBuff[odata[0].cb], szPointOfInterest, sizeof(szPointOfInterest)-1); 
-                                    odata[0].cb += sizeof(szPointOfInterest)-1;
-                                    utoa(ioscT.bidx.iPOI, &pchJSONRespBuff[odata[0].cb], 10);
-                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                    resp.Append(szPointOfInterest);
+                                    resp.AppendU32(ioscT.bidx.iPOI);
 
                                     // trigger index
-                                    memcpy(&pchJSONRespBuff[odata[0].cb], szTriggerIndex, sizeof(szTriggerIndex)-1); 
-                                    odata[0].cb += sizeof(szTriggerIndex)-1;
-                                    itoa(ioscT.bidx.iTrg, &pchJSONRespBuff[odata[0].cb], 10);
-                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                    resp.Append(szTriggerIndex);
+                                    resp.AppendI32(ioscT.bidx.iTrg);
 
                                     // TBD: REMOVE trigger delay
-                                    memcpy(&pchJSONRespBuff[odata[0].cb], szTriggerDelay, sizeof(szTriggerDelay)-1); 
-                                    odata[0].cb += sizeof(szTriggerDelay)-1;
-                                    odata[0].cb += strlen(illtoa(ioscT.bidx.psDelay, &pchJSONRespBuff[odata[0].cb], 10));
+                                    resp.Append(szTriggerDelay);
+                                    resp.AppendI64(ioscT.bidx.psDelay);
 
                                     // trigger delay
-                                    memcpy(&pchJSONRespBuff[odata[0].cb], szActualTriggerDelay, sizeof(szActualTriggerDelay)-1); 
-                                    odata[0].cb += sizeof(szActualTriggerDelay)-1;
-                                    odata[0].cb += strlen(illtoa(ioscT.bidx.psDelay, &pchJSONRespBuff[odata[0].cb], 10));
+                                    resp.Append(szActualTriggerDelay);
+                                    resp.AppendI64(ioscT.bidx.psDelay);
                                     
                                     // Osc Offset
-                                    memcpy(&pchJSONRespBuff[odata[0].cb], szActualVOffset, sizeof(szActualVOffset)-1); 
-                                    odata[0].cb += sizeof(szActualVOffset)-1;
-                                    itoa(OSCVinFromDadcGainOffset(((OSC *) rgInstr[ioscT.id]),  0, (ioscT.gain-1), ioscT.mvOffset), &pchJSONRespBuff[odata[0].cb], 10);
-                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                    resp.Append(szActualVOffset);
+                                    resp.AppendI32(OSCVinFromDadcGainOffset(((OSC *) rgInstr[ioscT.id]),  0, (ioscT.gain-1), ioscT.mvOffset));
 
                                     // put in the gain
-                                    memcpy(&pchJSONRespBuff[odata[0].cb], szActualGain, sizeof(szActualGain)-1); 
-                                    odata[0].cb += sizeof(szActualGain)-1;
-                                    memcpy(&pchJSONRespBuff[odata[0].cb], rgszGains[ioscT.gain], strlen(rgszGains[ioscT.gain])); 
-                                    odata[0].cb += strlen(rgszGains[ioscT.gain]);
+                                    resp.Append(szActualGain);
+                                    resp.AppendSz(rgszGains[ioscT.gain]);
                                 
                                     if (ioscT.id == OSC1_ID) 
                                     {
@@ -5028,79 +5811,75 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                             else if(ioscT.state.processing == Armed) 
                             {     
                                 // Error Code
-                                utoa(InstrumentArmed, &pchJSONRespBuff[odata[0].cb], 10);
-                                odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                resp.AppendU32(InstrumentArmed);
                             }
                             
                             else
                             {
                                 // Error Code
-                                utoa(InstrumentInUse, &pchJSONRespBuff[odata[0].cb], 10);
-                                odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                resp.AppendU32(InstrumentInUse);
                             }
 
                             // put out the wait time
-                            memcpy(&pchJSONRespBuff[odata[0].cb], szWait0, sizeof(szWait0)-1); 
-                            odata[0].cb += sizeof(szWait0)-1;
+                            resp.Append(szWait0);
+
+                            // it did not fit, do not send the buffer and say why
+                            if(resp.Overflow())
+                            {
+                                if(cOData > cODataStart)
+                                {
+                                    cOData--;
+                                    iBinOffset -= odata[cOData].cb;
+                                    ioscT.buffLock = LOCKAvailable;
+                                    *odata[cOData].pLockState = LOCKAvailable;
+                                }
+                                resp.Rewind().Append(szReadStatusCode).AppendU32(ResponseTooLarge).Append(szWait0);
+                            }
 
                             break;
 
                         case JSPAROscGetCurrentState:
 
                             // put out the command and status
-                            memcpy(&pchJSONRespBuff[odata[0].cb], szGetCurrentStateStatusCode, sizeof(szGetCurrentStateStatusCode)-1); 
-                            odata[0].cb += sizeof(szGetCurrentStateStatusCode)-1;
+                            resp.Append(szGetCurrentStateStatusCode);
 
                             // refresh the data
                             if (ioscT.id == OSC1_ID) memcpy(&ioscT, &pjcmd.ioscCh1, sizeof(ioscT));
                             else memcpy(&ioscT, &pjcmd.ioscCh2, sizeof(ioscT));
 
                             // status code
-                            pchJSONRespBuff[odata[0].cb++] = '0';
+                            resp.Append('0');
 
                             // Put out the acqCount
-                            memcpy(&pchJSONRespBuff[odata[0].cb], szAcqCount, sizeof(szAcqCount)-1); 
-                            odata[0].cb += sizeof(szAcqCount)-1;
-                            utoa(ioscT.acqCount, &pchJSONRespBuff[odata[0].cb], 10);
-                            odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                            resp.Append(szAcqCount);
+                            resp.AppendU32(ioscT.acqCount);
 
                             // Osc Offset
-                            memcpy(&pchJSONRespBuff[odata[0].cb], szActualVOffset, sizeof(szActualVOffset)-1); 
-                            odata[0].cb += sizeof(szActualVOffset)-1;
-                            itoa(OSCVinFromDadcGainOffset(((OSC *) rgInstr[ioscT.id]),  0, (ioscT.gain-1), ioscT.mvOffset), &pchJSONRespBuff[odata[0].cb], 10);
-                            odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                            resp.Append(szActualVOffset);
+                            resp.AppendI32(OSCVinFromDadcGainOffset(((OSC *) rgInstr[ioscT.id]),  0, (ioscT.gain-1), ioscT.mvOffset));
 
                             // put out the sps Freq
-                            memcpy(&pchJSONRespBuff[odata[0].cb], szActualSampleFreq, sizeof(szActualSampleFreq)-1); 
-                            odata[0].cb += sizeof(szActualSampleFreq)-1;
-                            ulltoa(ioscT.bidx.xsps, &pchJSONRespBuff[odata[0].cb], 10);
-                            odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                            resp.Append(szActualSampleFreq);
+                            resp.AppendU64(ioscT.bidx.xsps);
 
                             // put in the gain
-                            memcpy(&pchJSONRespBuff[odata[0].cb], szActualGain, sizeof(szActualGain)-1); 
-                            odata[0].cb += sizeof(szActualGain)-1;
-                            memcpy(&pchJSONRespBuff[odata[0].cb], rgszGains[ioscT.gain], strlen(rgszGains[ioscT.gain])); 
-                            odata[0].cb += strlen(rgszGains[ioscT.gain]);
+                            resp.Append(szActualGain);
+                            resp.AppendSz(rgszGains[ioscT.gain]);
 
                             // TBD: REMOVE trigger delay
-                            memcpy(&pchJSONRespBuff[odata[0].cb], szTriggerDelay, sizeof(szTriggerDelay)-1); 
-                            odata[0].cb += sizeof(szTriggerDelay)-1;
-                            odata[0].cb += strlen(illtoa(ioscT.bidx.psDelay, &pchJSONRespBuff[odata[0].cb], 10));
+                            resp.Append(szTriggerDelay);
+                            resp.AppendI64(ioscT.bidx.psDelay);
 
                             // trigger delay
-                            memcpy(&pchJSONRespBuff[odata[0].cb], szActualTriggerDelay, sizeof(szActualTriggerDelay)-1); 
-                            odata[0].cb += sizeof(szActualTriggerDelay)-1;
-                            odata[0].cb += strlen(illtoa(ioscT.bidx.psDelay, &pchJSONRespBuff[odata[0].cb], 10));
+                            resp.Append(szActualTriggerDelay);
+                            resp.AppendI64(ioscT.bidx.psDelay);
 
                             // buffer size
-                            memcpy(&pchJSONRespBuff[odata[0].cb], szBufferSize, sizeof(szBufferSize)-1); 
-                            odata[0].cb += sizeof(szBufferSize)-1;
-                            utoa(ioscT.bidx.cBuff, &pchJSONRespBuff[odata[0].cb], 10);
-                            odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                            resp.Append(szBufferSize);
+                            resp.AppendU32(ioscT.bidx.cBuff);
                                 
                             // the current state 
-                            memcpy(&pchJSONRespBuff[odata[0].cb], szState, sizeof(szState)-1); 
-                            odata[0].cb += sizeof(szState)-1;
+                            resp.Append(szState);
 
                             // put out the trigger state
                             switch(ioscT.state.processing)
@@ -5108,40 +5887,41 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                                 case Idle:
                                 case Waiting:
                                     // put out idle
-                                    strcpy(&pchJSONRespBuff[odata[0].cb], rgInstrumentStates[Idle]); 
+                                    resp.AppendSz(rgInstrumentStates[Idle]);
                                     break;
 
                                 case Triggered:
                                     // put out triggered
-                                    strcpy(&pchJSONRespBuff[odata[0].cb], rgInstrumentStates[Triggered]); 
+                                    resp.AppendSz(rgInstrumentStates[Triggered]);
                                     break;
 
                                 case Armed:
                                     if(T9CONbits.ON)
                                     {
                                         // put out acquiring
-                                        strcpy(&pchJSONRespBuff[odata[0].cb], rgInstrumentStates[Acquiring]); 
+                                        resp.AppendSz(rgInstrumentStates[Acquiring]);
                                     }
 
                                     // otherwise we are armed or in the process of being armed
                                     else
                                     {
                                         // put out acquiring
-                                        strcpy(&pchJSONRespBuff[odata[0].cb], rgInstrumentStates[Armed]); 
+                                        resp.AppendSz(rgInstrumentStates[Armed]);
                                     }
                                     break;
 
                                 // Say armed or acquiring when running
                                 default:
                                     // busy doing something esle
-                                    strcpy(&pchJSONRespBuff[odata[0].cb], rgInstrumentStates[Busy]); 
+                                    resp.AppendSz(rgInstrumentStates[Busy]);
                                     break;
                             }
-                            odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]); 
 
                             // put out the wait time
-                            memcpy(&pchJSONRespBuff[odata[0].cb], szWait0, sizeof(szWait0)-1); 
-                            odata[0].cb += sizeof(szWait0)-1;
+                            resp.Append(szWait0);
+
+                            // it did not fit, say why
+                            if(resp.Overflow()) resp.Rewind().Append(szGetCurrentStateStatusCode).AppendU32(ResponseTooLarge).Append(szWait0);
                             break;
 
                         default:
@@ -5176,6 +5956,8 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                 if(jsonToken == tokObject)
                 {
                     memcpy(&ilaT, &pjcmd.ila, sizeof(ILA));
+                    ilaT.fRLE = false;
+                    ilaT.fBadEncoding = false;
                     rgStrU32 = rgStrU32LaChannel;
                     cStrU32 = sizeof(rgStrU32LaChannel) / sizeof(STRU32);
                     memcpy(&pchJSONRespBuff[odata[0].cb], szLaObject, sizeof(szLaObject)-1); 
@@ -5263,6 +6045,18 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                 }
                 break;
 
+            case OSPARLaEncoding:
+                if(jsonToken == tokStringValue)
+                {
+                    uint32_t encoding = Uint32FromStr(rgStrU32LaEncoding, sizeof(rgStrU32LaEncoding) / sizeof(STRU32), szToken, cbToken, InvalidParameter);
+
+                    // an encoding we don't know fails the read, rather than quietly coming back raw
+                    ilaT.fBadEncoding   = (encoding == InvalidParameter);
+                    ilaT.fRLE           = (encoding == true);
+                    state = OSPARSkipValueSep;
+                }
+                break;
+
             case OSPARLaSetTrigDelay:
                 if(jsonToken == tokNumber && cbToken <= 20)
                 {
@@ -5286,6 +6080,19 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                 }
                 break;
 
+            case OSPARLaReadWhenReady:
+                if(jsonToken == tokStringValue)
+                {
+                    // put out the command and status
+                    memcpy(&pchJSONRespBuff[odata[0].cb], szReadStatusCode, sizeof(szReadStatusCode)-1); 
+                    odata[0].cb += sizeof(szReadStatusCode)-1;
+  
+                    state = OSPARSkipValueSep;
+                    ilaT.state.parsing = JSPARLaReadWhenReady;
+                    tWhenReady = ReadCoreTimer();
+                }
+                break;
+
             case OSPARLaGetCurrentState:
                 if(jsonToken == tokStringValue)
                 {
@@ -5388,9 +6195,46 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
 
                             break;
 
+                        case JSPARLaReadWhenReady:
+
+                            // while the trigger is still running, yield; the main loop keeps running
+                            // and we come back here with the same end object token
+                            if( pjcmd.ila.state.processing == Armed                                                             && 
+                                (pjcmd.trigger.state.processing == Run || pjcmd.trigger.state.processing == Armed)              &&
+                                (ReadCoreTimer() - tWhenReady) < MAXTICKSWHENREADY                                              )
+                            {
+                                stateValueSep = OSPARSeparatedObject;
+                                state = OSPARSkipValueSep;
+
+                                // let other parsers run while we wait, but keep them off the la
+                                ClaimEndpoint(OSPARLaChannelObject);
+                                pParseOwner = NULL;
+                                return(JSPARLaReadWhenReady);
+                            }
+
+                            // now it is just a read, of the acquisition as it is now; keep the acqCount and encoding we were asked for
+                            ReleaseEndpoints();
+                            {
+                                uint32_t    acqCountT   = ilaT.acqCount;
+                                bool        fRLET       = ilaT.fRLE;
+                                bool        fBadEncT    = ilaT.fBadEncoding;
+                                memcpy(&ilaT, &pjcmd.ila, sizeof(ilaT));
+                                ilaT.acqCount       = acqCountT;
+                                ilaT.fRLE           = fRLET;
+                                ilaT.fBadEncoding   = fBadEncT;
+                            }
+                            ilaT.state.parsing = JSPARLaRead;
+                            // fall thru
+
                         case JSPARLaRead:
 
-                            if(pjcmd.ila.state.processing == Triggered && pjcmd.ila.buffLock == LOCKAvailable)
+                            if(ilaT.fBadEncoding)
+                            {
+                                // Error Code
+                                resp.AppendU32(InvalidParameter);
+                            }
+
+                            else if(pjcmd.ila.state.processing == Triggered && pjcmd.ila.buffLock == LOCKAvailable)
                             {
                                 uint32_t    acqCountBuf = 0;
 
@@ -5401,8 +6245,7 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                                 if(ilaT.acqCount > acqCountBuf)
                                 {
                                     // Error Code
-                                    utoa(AcqCountTooOld, &pchJSONRespBuff[odata[0].cb], 10);
-                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                    resp.AppendU32(AcqCountTooOld);
                                 }
 
                                 else
@@ -5411,14 +6254,11 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                                     ilaT.buffLock = LOCKOutput;
 
                                     // status code
-                                    pchJSONRespBuff[odata[0].cb] = '0';
-                                    odata[0].cb++;
+                                    resp.Append('0');
 
                                     // binary offset
-                                    memcpy(&pchJSONRespBuff[odata[0].cb], szBinaryOffset, sizeof(szBinaryOffset)-1); 
-                                    odata[0].cb += sizeof(szBinaryOffset)-1;
-                                    utoa(iBinOffset, &pchJSONRespBuff[odata[0].cb], 10);
-                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                    resp.Append(szBinaryOffset);
+                                    resp.AppendU32(iBinOffset);
 
                                     // fill in the binary location info
                                     odata[cOData].cb = ilaT.bidx.cBuff * sizeof(int16_t);
@@ -5426,11 +6266,27 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                                     odata[cOData].ReadData = &OSPAR::ReadJSONResp;
 //                                    odata[cOData].pbOut = (uint8_t *) &ilaT.pBuff[ilaT.iStartRetBuf];
 
+                                    // if asked for, return {value, count} runs of the masked samples
+                                    // the buffer has already been scrolled to the trigger; if the runs do not fit, send it raw
+                                    if(ilaT.fRLE)
+                                    {
+                                        uint32_t cRuns = RLEBuffer(ilaT.pBuff, ilaT.bidx.cBuff, ilaT.bitMask, rgLARLEBuff, LARLEMAXRUNS);
+
+                                        if(cRuns > 0)
+                                        {
+                                            odata[cOData].cb = cRuns * 2 * sizeof(uint16_t);
+                                            odata[cOData].pbOut = (uint8_t *) rgLARLEBuff;
+                                            resp.Append(szEncodingRLE);
+                                        }
+                                        else
+                                        {
+                                            resp.Append(szEncodingRaw);
+                                        }
+                                    }
+
                                     // binary length 
-                                    memcpy(&pchJSONRespBuff[odata[0].cb], szBinaryLength, sizeof(szBinaryLength)-1); 
-                                    odata[0].cb += sizeof(szBinaryLength)-1;
-                                    utoa(odata[cOData].cb, &pchJSONRespBuff[odata[0].cb], 10);
-                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                    resp.Append(szBinaryLength);
+                                    resp.AppendU32(odata[cOData].cb);
 
                                     // update the offset for the next one
                                     ilaT.iBinOffset = iBinOffset;
@@ -5438,44 +6294,32 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
 
                                     // Put out the acqCount
                                     ilaT.acqCount = acqCountBuf;
-                                    memcpy(&pchJSONRespBuff[odata[0].cb], szAcqCount, sizeof(szAcqCount)-1); 
-                                    odata[0].cb += sizeof(szAcqCount)-1;
-                                    utoa(acqCountBuf, &pchJSONRespBuff[odata[0].cb], 10);
-                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                    resp.Append(szAcqCount);
+                                    resp.AppendU32(acqCountBuf);
 
                                     // Put out the bitmask
-                                    memcpy(&pchJSONRespBuff[odata[0].cb], szBitMask, sizeof(szBitMask)-1); 
-                                    odata[0].cb += sizeof(szBitMask)-1;
-                                    utoa(ilaT.bitMask, &pchJSONRespBuff[odata[0].cb], 10);
-                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                    resp.Append(szBitMask);
+                                    resp.AppendU32(ilaT.bitMask);
 
                                     // put out the sps Freq
-                                    memcpy(&pchJSONRespBuff[odata[0].cb], szActualSampleFreq, sizeof(szActualSampleFreq)-1); 
-                                    odata[0].cb += sizeof(szActualSampleFreq)-1;
-                                    ulltoa(ilaT.bidx.xsps, &pchJSONRespBuff[odata[0].cb], 10);
-                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                    resp.Append(szActualSampleFreq);
+                                    resp.AppendU64(ilaT.bidx.xsps);
 
                                     // POI
-                                    memcpy(&pchJSONRespBuff[odata[0].cb], szPointOfInterest, sizeof(szPointOfInterest)-1); 
-                                    odata[0].cb += sizeof(szPointOfInterest)-1;
-                                    utoa(ilaT.bidx.iPOI, &pchJSONRespBuff[odata[0].cb], 10);
-                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                    resp.Append(szPointOfInterest);
+                                    resp.AppendU32(ilaT.bidx.iPOI);
 
                                     // trigger index
-                                    memcpy(&pchJSONRespBuff[odata[0].cb], szTriggerIndex, sizeof(szTriggerIndex)-1); 
-                                    odata[0].cb += sizeof(szTriggerIndex)-1;
-                                    itoa(ilaT.bidx.iTrg, &pchJSONRespBuff[odata[0].cb], 10);
-                                    odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                    resp.Append(szTriggerIndex);
+                                    resp.AppendI32(ilaT.bidx.iTrg);
 
                                     // TBD: REMOVE trigger delay
-                                    memcpy(&pchJSONRespBuff[odata[0].cb], szTriggerDelay, sizeof(szTriggerDelay)-1); 
-                                    odata[0].cb += sizeof(szTriggerDelay)-1;
-                                    odata[0].cb += strlen(illtoa(ilaT.bidx.psDelay, &pchJSONRespBuff[odata[0].cb], 10));
+                                    resp.Append(szTriggerDelay);
+                                    resp.AppendI64(ilaT.bidx.psDelay);
 
                                     // trigger delay
-                                    memcpy(&pchJSONRespBuff[odata[0].cb], szActualTriggerDelay, sizeof(szActualTriggerDelay)-1); 
-                                    odata[0].cb += sizeof(szActualTriggerDelay)-1;
-                                    odata[0].cb += strlen(illtoa(ilaT.bidx.psDelay, &pchJSONRespBuff[odata[0].cb], 10));
+                                    resp.Append(szActualTriggerDelay);
+                                    resp.AppendI64(ilaT.bidx.psDelay);
 
                                     memcpy(&pjcmd.ila, &ilaT, sizeof(ilaT));
                                     odata[cOData].pLockState = &pjcmd.ila.buffLock;
@@ -5488,20 +6332,30 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                             else if(ilaT.state.processing == Armed) 
                             {     
                                 // Error Code
-                                utoa(InstrumentArmed, &pchJSONRespBuff[odata[0].cb], 10);
-                                odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                resp.AppendU32(InstrumentArmed);
                             }
                             
                             else
                             {
                                 // Error Code
-                                utoa(InstrumentInUse, &pchJSONRespBuff[odata[0].cb], 10);
-                                odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                                resp.AppendU32(InstrumentInUse);
                             }
 
                             // put out the wait time
-                            memcpy(&pchJSONRespBuff[odata[0].cb], szWait0, sizeof(szWait0)-1); 
-                            odata[0].cb += sizeof(szWait0)-1;
+                            resp.Append(szWait0);
+
+                            // it did not fit, do not send the buffer and say why; the command was put out with the read token
+                            if(resp.Overflow())
+                            {
+                                if(cOData > cODataStart)
+                                {
+                                    cOData--;
+                                    iBinOffset -= odata[cOData].cb;
+                                    ilaT.buffLock = LOCKAvailable;
+                                    *odata[cOData].pLockState = LOCKAvailable;
+                                }
+                                resp.Rewind().AppendU32(ResponseTooLarge).Append(szWait0);
+                            }
 
                             break;
 
@@ -5511,45 +6365,34 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                             memcpy(&ilaT, &pjcmd.ila, sizeof(ilaT));
 
                             // status code
-                            pchJSONRespBuff[odata[0].cb++] = '0';
+                            resp.Append('0');
 
                             // Put out the acqCount
-                            memcpy(&pchJSONRespBuff[odata[0].cb], szAcqCount, sizeof(szAcqCount)-1); 
-                            odata[0].cb += sizeof(szAcqCount)-1;
-                            utoa(ilaT.acqCount, &pchJSONRespBuff[odata[0].cb], 10);
-                            odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                            resp.Append(szAcqCount);
+                            resp.AppendU32(ilaT.acqCount);
 
                             // Put out the bitmask
-                            memcpy(&pchJSONRespBuff[odata[0].cb], szBitMask, sizeof(szBitMask)-1); 
-                            odata[0].cb += sizeof(szBitMask)-1;
-                            utoa(ilaT.bitMask, &pchJSONRespBuff[odata[0].cb], 10);
-                            odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                            resp.Append(szBitMask);
+                            resp.AppendU32(ilaT.bitMask);
 
                             // put out the sps Freq
-                            memcpy(&pchJSONRespBuff[odata[0].cb], szActualSampleFreq, sizeof(szActualSampleFreq)-1); 
-                            odata[0].cb += sizeof(szActualSampleFreq)-1;
-                            ulltoa(ilaT.bidx.xsps, &pchJSONRespBuff[odata[0].cb], 10);
-                            odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                            resp.Append(szActualSampleFreq);
+                            resp.AppendU64(ilaT.bidx.xsps);
 
                             // TBD: REMOVE trigger delay
-                            memcpy(&pchJSONRespBuff[odata[0].cb], szTriggerDelay, sizeof(szTriggerDelay)-1); 
-                            odata[0].cb += sizeof(szTriggerDelay)-1;
-                            odata[0].cb += strlen(illtoa(ilaT.bidx.psDelay, &pchJSONRespBuff[odata[0].cb], 10));
+                            resp.Append(szTriggerDelay);
+                            resp.AppendI64(ilaT.bidx.psDelay);
 
                             // trigger delay
-                            memcpy(&pchJSONRespBuff[odata[0].cb], szActualTriggerDelay, sizeof(szActualTriggerDelay)-1); 
-                            odata[0].cb += sizeof(szActualTriggerDelay)-1;
-                            odata[0].cb += strlen(illtoa(ilaT.bidx.psDelay, &pchJSONRespBuff[odata[0].cb], 10));
+                            resp.Append(szActualTriggerDelay);
+                            resp.AppendI64(ilaT.bidx.psDelay);
 
                             // buffer size
-                            memcpy(&pchJSONRespBuff[odata[0].cb], szBufferSize, sizeof(szBufferSize)-1); 
-                            odata[0].cb += sizeof(szBufferSize)-1;
-                            utoa(ilaT.bidx.cBuff, &pchJSONRespBuff[odata[0].cb], 10);
-                            odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                            resp.Append(szBufferSize);
+                            resp.AppendU32(ilaT.bidx.cBuff);
                                 
                             // the current state 
-                            memcpy(&pchJSONRespBuff[odata[0].cb], szState, sizeof(szState)-1); 
-                            odata[0].cb += sizeof(szState)-1;
+                            resp.Append(szState);
 
                             // put out the trigger state
                             switch(ilaT.state.processing)
@@ -5557,39 +6400,40 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                                 case Idle:
                                 case Waiting:
                                     // put out idle
-                                    strcpy(&pchJSONRespBuff[odata[0].cb], rgInstrumentStates[Idle]); 
+                                    resp.AppendSz(rgInstrumentStates[Idle]);
                                     break;
 
                                 case Triggered:
                                     // put out triggered
-                                    strcpy(&pchJSONRespBuff[odata[0].cb], rgInstrumentStates[Triggered]); 
+                                    resp.AppendSz(rgInstrumentStates[Triggered]);
                                     break;
 
                                 case Armed:
                                     if(T9CONbits.ON)
                                     {
                                         // put out acquiring
-                                        strcpy(&pchJSONRespBuff[odata[0].cb], rgInstrumentStates[Acquiring]); 
+                                        resp.AppendSz(rgInstrumentStates[Acquiring]);
                                     }
 
                                     // otherwise we are armed or in the process of being armed
                                     else
                                     {
                                         // put out armed
-                                        strcpy(&pchJSONRespBuff[odata[0].cb], rgInstrumentStates[Armed]); 
+                                        resp.AppendSz(rgInstrumentStates[Armed]);
                                     }
                                     break;
 
                                 // busy doing something esle
                                 default:
-                                    strcpy(&pchJSONRespBuff[odata[0].cb], rgInstrumentStates[Busy]); 
+                                    resp.AppendSz(rgInstrumentStates[Busy]);
                                     break;
                             }
-                            odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]); 
 
                             // put out the wait time
-                            memcpy(&pchJSONRespBuff[odata[0].cb], szWait0, sizeof(szWait0)-1); 
-                            odata[0].cb += sizeof(szWait0)-1;
+                            resp.Append(szWait0);
+
+                            // it did not fit, say why; the command was put out with the getCurrentState token
+                            if(resp.Overflow()) resp.Rewind().AppendU32(ResponseTooLarge).Append(szWait0);
                             break;
 
                         case JSPARLaRun:
@@ -5632,6 +6476,10 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                             break;
                     }
 
+                    // encoding only applies to this command
+                    ilaT.fRLE = false;
+                    ilaT.fBadEncoding = false;
+
                     // next state
                     stateValueSep = OSPARSeparatedObject;
                     state = OSPARSkipValueSep;
@@ -6340,7 +7188,14 @@ STATE OSPAR::ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonTo
                         fLANeeded       |= (pjcmd.trigger.rgtte[i].instrID == LOGIC1_ID);
                     }
 
-                    if(fReady)
+                    // the digital logger has the LA timer and DMA
+                    if(fLANeeded && IsDLOGRunning())
+                    {
+                        utoa(InstrumentInUse, &pchJSONRespBuff[odata[0].cb], 10);
+                        odata[0].cb += strlen(&pchJSONRespBuff[odata[0].cb]);
+                    }
+
+                    else if(fReady)
                     {
 
                         // set up the trigger
@@ -6972,9 +7827,10 @@ uint32_t OSPAR::Uint32FromStr(STRU32 const * const rgStrU32L, uint32_t cStrU32L,
 {
     uint32_t i = 0;
 
+    // the length and first char reject almost every entry without touching memcmp
     for(i = 0; i < cStrU32L; i++)
     {
-        if((strlen(rgStrU32L[i].szToken) == cb) && memcmp(sz, rgStrU32L[i].szToken, cb) == 0)
+        if(rgStrU32L[i].cbToken == cb && rgStrU32L[i].szToken[0] == sz[0] && memcmp(sz, rgStrU32L[i].szToken, cb) == 0)
         {
             return(rgStrU32L[i].u32);
         }
@@ -7086,15 +7942,22 @@ GCMD::ACTION OSPAR::ReadLogFile(int32_t iOData, uint8_t const *& pbRead, int32_t
 {
     ODATA&      oData   = odata[iOData];
     IALOG&      ialog   = (oData.id == ALOG1_ID) ? pjcmd.iALog1 : pjcmd.iALog2;
-    DFILE&      dFile = *((DFILE *) ialog.pdFile);
+    DFILE&      dFile   = *((DFILE *) ialog.pdFile);
+    int32_t     iNext   = 0;
 
     static_assert(sizeof(pchJSONRespBuff) >= DFILE::FS_DEFAULT_BUFF_SIZE, "pchJSONRespBuff is too small");
+    static_assert(((sizeof(pchJSONRespBuff) / 2) % _FATFS_CBSECTOR_) == 0, "pchJSONRespBuff halves must be sector multiples");
 
     if(*oData.pLockState == LOCKAvailable) 
     {
         // if not running and was closed, close when we are done
         oData.pbOut = (!dFile && ialog.state.instrument == Idle) ? NULL : (uint8_t *) pchJSONRespBuff;      // this is just a flag
         *oData.pLockState = LOCKOutput;
+
+        iLogOData   = iOData;
+        iLogSend    = -1;
+        rgcbLog[0]  = 0;
+        rgcbLog[1]  = 0;
     }
 
     ASSERT(*oData.pLockState == LOCKOutput);
@@ -7102,42 +7965,91 @@ GCMD::ACTION OSPAR::ReadLogFile(int32_t iOData, uint8_t const *& pbRead, int32_t
     cbRead = 0;
     pbRead = NULL;
 
-    // open the file if it needs to be open
-    if(oData.cb == 0)
+    // the half we handed out last time has been sent, it is free now
+    if(iLogSend >= 0)
     {
-        if(oData.pbOut == NULL) dFile.fsclose();     
-        *oData.pLockState = LOCKAvailable;
-        return(GCMD::DONE);
+        rgcbLog[iLogSend] = 0;
+        iNext = iLogSend ^ 1;
     }
 
-    else if(!dFile &&
-        (DFATFS::fschdrive(DFATFS::szFatFsVols[ialog.vol])                      != FR_OK    || 
-            DFATFS::fschdir(DFATFS::szRoot)                                     != FR_OK    ||
-            dFile.fsopen(ialog.szURI, FA_OPEN_EXISTING | FA_WRITE | FA_READ)    != FR_OK    ))
+    // if the read ahead did not get the next half ready, do it now
+    if(rgcbLog[iNext] == 0)
     {
-        dFile.fsclose();
-        *oData.pLockState = LOCKAvailable;
-        return(GCMD::ERROR);
+        // nothing more to read, we are done
+        if(oData.cb == 0)
+        {
+            if(oData.pbOut == NULL) dFile.fsclose();     
+            *oData.pLockState = LOCKAvailable;
+            iLogOData = 0;
+            return(GCMD::DONE);
+        }
+
+        // open the file if it needs to be open
+        else if((!dFile &&
+            (DFATFS::fschdrive(DFATFS::szFatFsVols[ialog.vol])                      != FR_OK    || 
+                DFATFS::fschdir(DFATFS::szRoot)                                     != FR_OK    ||
+                dFile.fsopen(ialog.szURI, FA_OPEN_EXISTING | FA_WRITE | FA_READ)    != FR_OK    ))  ||
+                !ReadLogBuff(iOData, iNext)                                                         )
+        {
+            dFile.fsclose();
+            *oData.pLockState = LOCKAvailable;
+            iLogOData = 0;
+            return(GCMD::ERROR);
+        }
     }
 
-    else if(dFile.fstell() == oData.iOut || dFile.fslseek(oData.iOut) == FR_OK)
-    {
-        int32_t    cbThisRead = min(oData.cb, (int32_t) (sizeof(pchJSONRespBuff) - (sizeof(pchJSONRespBuff) %_FATFS_CBSECTOR_)));
+    // hand out this half, LogReadAhead will fill the other while this one is sent
+    iLogSend    = iNext;
+    pbRead      = (uint8_t *) &pchJSONRespBuff[iNext * (sizeof(pchJSONRespBuff) / 2)];
+    cbRead      = rgcbLog[iNext];
 
-        pbRead = (uint8_t *) pchJSONRespBuff;
-        dFile.fsread ((void *) pbRead, cbThisRead, (uint32_t *) &cbRead, DFILE::FS_INFINITE_SECTOR_CNT);
-        oData.cb    -= cbRead;
-        oData.iOut  += cbRead;
+    return(GCMD::WRITE);
+}
 
-        return(GCMD::WRITE);
+// read the next part of the log range into a half of pchJSONRespBuff
+// oData.iOut is the file position and oData.cb what is left to read.
+// The first read is cut short so every read after it is sector aligned.
+bool OSPAR::ReadLogBuff(int32_t iOData, int32_t iHalf)
+{
+    ODATA&      oData   = odata[iOData];
+    IALOG&      ialog   = (oData.id == ALOG1_ID) ? pjcmd.iALog1 : pjcmd.iALog2;
+    DFILE&      dFile   = *((DFILE *) ialog.pdFile);
+    uint32_t    cbHalf  = sizeof(pchJSONRespBuff) / 2;
+    uint32_t    cbThis  = min(oData.cb, cbHalf - (oData.iOut % _FATFS_CBSECTOR_));
+    uint32_t    cbBuff  = 0;
+
+    ASSERT(rgcbLog[iHalf] == 0);
+
+    if(!dFile || 
+        (dFile.fstell() != oData.iOut && dFile.fslseek(oData.iOut) != FR_OK)                                                || 
+        dFile.fsread((void *) &pchJSONRespBuff[iHalf * cbHalf], cbThis, &cbBuff, DFILE::FS_INFINITE_SECTOR_CNT) != FR_OK    ||
+        cbBuff == 0                                                                                                         )
+    {
+        return(false);
     }
 
-    else
+    rgcbLog[iHalf]  = cbBuff;
+    oData.cb        -= cbBuff;
+    oData.iOut      += cbBuff;
+
+    return(true);
+}
+
+// called from the main loop, while a log half is out being sent
+// read the next one into the other half so the SD read overlaps the send
+void OSPAR::LogReadAhead(void)
+{
+    int32_t iHalf = iLogSend ^ 1;
+
+    // only while we are in the middle of streaming a log
+    if(iLogOData == 0 || iLogSend < 0 || stateOSJB != OSJBWriteOData || iOData != iLogOData || 
+        *odata[iLogOData].pLockState != LOCKOutput || odata[iLogOData].cb == 0 || rgcbLog[iHalf] > 0)
     {
-        dFile.fsclose();
-        *oData.pLockState = LOCKAvailable;
-        return(GCMD::ERROR);
+        return;
     }
+
+    // on failure leave the half empty; ReadLogFile will retry and report the error
+    ReadLogBuff(iLogOData, iHalf);
 }
 
 /************************************************************************/
@@ -7171,6 +8083,10 @@ GCMD::ACTION OSPAR::StreamOS(char const * szStream, int32_t cbStream)
                 // fall thru
 
             case OSJBSkipWhite:
+
+                // skip the run of white space, the last character is handled as it always was
+                while(iStream < cbStream-1 && IsWhite(szStream[iStream])) iStream++;
+
                 if(IsWhite(szStream[iStream])) iStream++;
                 else stateOSJB = stateOSJBNextWhite;   
                 fContinue = true;
@@ -7180,16 +8096,20 @@ GCMD::ACTION OSPAR::StreamOS(char const * szStream, int32_t cbStream)
 
                 if(cbChunk > 0 && cbChunk-iChunk > 0)
                 {
-                    if(IsWhite(szStream[iStream])) 
-                    {
-                        iStream++;
+                    int32_t cbLeft  = cbChunk-iChunk;
+                    int32_t cbRun   = min(cbStream-iStream, cbLeft);
+                    int32_t i       = 0;
 
-                        // The stream will advance iChunk, see if we are done
-                        // we have to do this here because chunking will just silently advance to the next chunk
-                        if(cbChunk-iChunk == 1) stateOSJB = stateOSJBNextWhite;  
-                    }
-                    else fNewError = true; 
+                    // skip the white space up to the end of the chunk, or what we have of it
+                    while(i < cbRun && IsWhite(szStream[iStream+i])) i++;
+                    iStream += i;
+
+                    // anything other than white space is an error
+                    if(i < cbRun) fNewError = true; 
 
+                    // The stream will advance iChunk, see if we are done
+                    // we have to do this here because chunking will just silently advance to the next chunk
+                    else if(i == cbLeft) stateOSJB = stateOSJBNextWhite;  
                 }
 
                 else ASSERT(NEVER_SHOULD_GET_HERE); 
@@ -7208,6 +8128,15 @@ GCMD::ACTION OSPAR::StreamOS(char const * szStream, int32_t cbStream)
                         stateOSJB               = OSJBReadCount;
                 }
 
+                // binary TLV tokens, skip the STX and read the frame length
+                else if(IsOSCmdStart(szStream[iStream]) == OSPAR::TLV)
+                {
+                        iStream++;
+                        iTLV                    = 0;
+                        fTLVValueEnd            = false;
+                        stateOSJB               = OSJBTLVLength;
+                }
+
                 // some thing unexpected is happening
                 else fNewError = true;
 
@@ -7231,10 +8160,16 @@ GCMD::ACTION OSPAR::StreamOS(char const * szStream, int32_t cbStream)
                 break;
 
             case OSJBReadCount:
-                if(IsOSCmdStart(szStream[iStream]) == OSPAR::OSJB)
+
+                // take all of the hex digits we have in one go
+                while(iStream < cbStream && iOSJBCount < (int32_t) sizeof(szOSJBCount)-1 && IsOSCmdStart(szStream[iStream]) == OSPAR::OSJB)
                 {
                     szOSJBCount[iOSJBCount++]   = szStream[iStream++];
-                    fContinue = true;
+                }
+
+                if(iStream == cbStream)
+                {
+                    // the rest of the count is in the next read
                 }
                 else if(szStream[iStream] == '\r')
                 {
@@ -7284,10 +8219,14 @@ GCMD::ACTION OSPAR::StreamOS(char const * szStream, int32_t cbStream)
 
             case OSJBParseJSON:
                 {
-                    int32_t cbDataStream = (cbChunk <= 0) ? cbStream : min(cbStream, cbChunk-iChunk);
+                    int32_t         cbDataStream    = (cbChunk <= 0) ? cbStream : min(cbStream, cbChunk-iChunk);
+                    uint32_t        tLex            = ReadCoreTimer();
+                    GCMD::ACTION    actionLex       = LexJSON(&szStream[iStream], cbDataStream-iStream, cbConsumed);
+
+                    // the lexer calls ParseToken, so this is the parse time
+                    tParseCmd += ReadCoreTimer() - tLex;
 
-                    // call the lexer
-                    switch(LexJSON(&szStream[iStream], cbDataStream-iStream, cbConsumed))
+                    switch(actionLex)
                     {
                         case GCMD::CONTINUE:
                             fYield = true; 
@@ -7305,6 +8244,9 @@ GCMD::ACTION OSPAR::StreamOS(char const * szStream, int32_t cbStream)
                         case GCMD::DONE:
                             iStream += cbConsumed;
                             cbConsumed = 0;
+
+                            // done with ParseToken, any binary input can run along side other parsers
+                            ReleaseParse();
                             if(cbChunk > 0) 
                              {
                                  // if we are already at the end of the chunk
@@ -7335,6 +8277,158 @@ GCMD::ACTION OSPAR::StreamOS(char const * szStream, int32_t cbStream)
                 }
                 break;
 
+            /************************************************************************/
+            /*    Binary TLV commands                                               */
+            /*    The tokens go straight to ParseToken, no lexing.                  */
+            /*    Name and value separators are supplied here.                      */
+            /************************************************************************/
+            case OSJBTLVLength:
+                rgbTLV[iTLV++] = szStream[iStream++];
+                if(iTLV == 2)
+                {
+                    cbTLVFrame  = ((uint8_t) rgbTLV[0]) | (((uint8_t) rgbTLV[1]) << 8);
+                    iTLV        = 0;
+                    stateOSJB   = OSJBTLVRead;
+
+                    // there must be at least an object
+                    if(cbTLVFrame < 4) fNewError = true;
+                }
+                fContinue = true;
+                break;
+
+            case OSJBTLVRead:
+                {
+                    // value bytes go after the opening quote
+                    int32_t cbNeed = (iTLV < 2) ? (2 - iTLV) : (2 + ((uint8_t) rgbTLV[1]) - iTLV);
+                    int32_t cbCopy = min(min(cbNeed, cbStream - iStream), cbTLVFrame);
+
+                    memcpy(&rgbTLV[(iTLV < 2) ? iTLV : iTLV + 1], &szStream[iStream], cbCopy);
+                    iTLV        += cbCopy;
+                    iStream     += cbCopy;
+                    cbTLVFrame  -= cbCopy;
+
+                    if(iTLV >= 2 && iTLV == 2 + ((uint8_t) rgbTLV[1]))
+                    {
+                        uint8_t type = (uint8_t) rgbTLV[0];
+
+                        tokTLV = (type < TLVEnd) ? rgTokFromTLV[type] : tokNone;
+
+                        if(tokTLV == tokNone)
+                        {
+                            fNewError = true;
+                        }
+
+                        // a value separator goes before anything but an end after a value
+                        else if(fTLVValueEnd && tokTLV != tokEndObject && tokTLV != tokEndArray) stateOSJB = OSJBTLVValueSep;
+                        else stateOSJB = OSJBTLVToken;
+
+                        // don't ask for more input, we have a token to parse
+                        fYield = true;
+                    }
+
+                    // ran out of frame before the end of the TLV
+                    else if(cbTLVFrame == 0) fNewError = true;
+
+                    fContinue = true;
+                }
+                break;
+
+            case OSJBTLVValueSep:
+                {
+                    STATE stTLV = ParseToken(szValueSep, sizeof(szValueSep)-1, tokValueSep);
+
+                    if(IsStateAnError(stTLV)) fNewError = true;
+                    else if(stTLV == Idle) stateOSJB = OSJBTLVToken;
+                    fYield = true;
+                }
+                break;
+
+            case OSJBTLVToken:
+                {
+                    JSONTOKEN       tok     = tokTLV;
+                    uint32_t        cb      = (uint8_t) rgbTLV[1];
+                    char const *    sz      = &rgbTLV[3];
+                    STATE           stTLV   = Idle;
+                    uint32_t        tTok    = 0;
+
+                    switch(tok)
+                    {
+                        // ParseToken takes the quotes off
+                        case tokMemberName:
+                        case tokStringValue:
+                            rgbTLV[2] = '\"';
+                            rgbTLV[3 + cb] = '\"';
+                            sz = &rgbTLV[2];
+                            cb += 2;
+                            break;
+
+                        case tokTrue:
+                            sz = "true";
+                            cb = 4;
+                            break;
+
+                        case tokFalse:
+                            sz = "false";
+                            cb = 5;
+                            break;
+
+                        case tokNull:
+                            sz = "null";
+                            cb = 4;
+                            break;
+
+                        default:
+                            break;
+                    }
+
+                    tTok = ReadCoreTimer();
+                    stTLV = ParseToken(sz, cb, tok);
+                    tParseCmd += ReadCoreTimer() - tTok;
+
+                    if(IsStateAnError(stTLV)) fNewError = true;
+                    else if(stTLV == Idle)
+                    {
+                        fTLVValueEnd = !(tok == tokObject || tok == tokArray || tok == tokMemberName);
+
+                        iTLV = 0;
+                        if(tok == tokMemberName)    stateOSJB = OSJBTLVNameSep;
+                        else if(cbTLVFrame == 0)    stateOSJB = OSJBTLVEnd;
+                        else                        stateOSJB = OSJBTLVRead;
+                    }
+
+                    // as with the lexer, give up the time after each token
+                    fYield = true;
+                }
+                break;
+
+            case OSJBTLVNameSep:
+                {
+                    STATE stTLV = ParseToken(":", 1, tokNameSep);
+
+                    if(IsStateAnError(stTLV)) fNewError = true;
+                    else if(stTLV == Idle)
+                    {
+                        if(cbTLVFrame == 0) stateOSJB = OSJBTLVEnd;
+                        else                stateOSJB = OSJBTLVRead;
+                    }
+                    fYield = true;
+                }
+                break;
+
+            case OSJBTLVEnd:
+                {
+                    STATE stTLV = ParseToken(NULL, 0, tokEndOfJSON);
+
+                    if(IsStateAnError(stTLV)) fNewError = true;
+                    else if(stTLV == Idle) 
+                    {
+                        stateOSJB = OSJBOutputJSON;
+                        fContinue = true;
+                    }
+                    fYield = true;
+                }
+                break;
+
             case OSJBReadNextBinary:
                 {
                     int32_t     i;
@@ -7438,6 +8532,11 @@ GCMD::ACTION OSPAR::StreamOS(char const * szStream, int32_t cbStream)
 
             case OSJBOutputJSON:
 
+                // done parsing and processing, the rest is output
+                tOutputCmd = ReadCoreTimer();
+                fCmdOutput = true;
+                ReleaseParse();
+
                 // clean up reading.
                 cbStreamInception += iStream;
                 iStream = 0;
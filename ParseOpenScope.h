@@ -11,6 +11,20 @@
 /************************************************************************/
 /*  Revision History:                                                   */
 /*    7/11/2016(KeithV): Created                                        */
+/*    10/19/2026(KeithV): Double buffered log read back                 */
+/*    10/19/2026(KeithV): STRU32 carries the token length               */
+/*    10/19/2026(KeithV): Batches of commands                           */
+/*    10/19/2026(KeithV): readWhenReady                                 */
+/*    10/19/2026(KeithV): Binary TLV commands                           */
+/*    10/19/2026(KeithV): OSRESP response writer                        */
+/*    10/19/2026(KeithV): Response cache                                */
+/*    10/19/2026(KeithV): Block OSJB framing                            */
+/*    10/19/2026(KeithV): Per command latency stats                     */
+/*    10/19/2026(KeithV): Fixed TLV wire types                          */
+/*    10/19/2026(KeithV): A parser per connection                       */
+/*    10/19/2026(KeithV): IsOutputPinned                                */
+/*    10/19/2026(KeithV): OSRESP overflow replaced by an error status   */
+/*    10/19/2026(KeithV): fLocked held until ICDEnd                     */
 /************************************************************************/
 
 #ifndef LexOpenScope_h
@@ -20,6 +34,86 @@
 
 #ifdef __cplusplus
 
+/************************************************************************/
+/*    OSRESP                                                            */
+/*                                                                      */
+/*    Appends JSON response fields to a fixed buffer. The caller owns   */
+/*    the buffer and the length; the length is updated as we go so no  */
+/*    strlen is ever needed, and nothing is written past cbMax. Once a  */
+/*    field does not fit, everything after it is dropped and Overflow() */
+/*    goes true. The last CBRESPRESERVE bytes are held back so the      */
+/*    caller can Rewind() to where this writer started and put out an   */
+/*    error status in place of the response that did not fit.          */
+/************************************************************************/
+#define CBRESPRESERVE   64
+
+class OSRESP
+{
+private:
+    char * const    pch;
+    uint32_t&       cb;
+    uint32_t const  cbMax;
+    uint32_t const  cbStart;
+    uint32_t        cbLimit;
+    bool            fOverflow;
+
+    bool Room(uint32_t cbAdd)
+    {
+        if(!fOverflow && (cb > cbLimit || cbAdd > (cbLimit - cb))) fOverflow = true;
+        return(!fOverflow);
+    }
+
+public:
+    OSRESP(char * pchBuff, uint32_t& cbBuff, uint32_t cbBuffMax) : pch(pchBuff), cb(cbBuff), cbMax(cbBuffMax), cbStart(cbBuff), 
+        cbLimit(cbBuffMax > CBRESPRESERVE ? cbBuffMax - CBRESPRESERVE : 0), fOverflow(false) {}
+
+    bool Overflow(void) const { return(fOverflow); }
+
+    // drop everything written since we were made, and let the error status use the reserve
+    OSRESP& Rewind(void)
+    {
+        cb          = cbStart;
+        cbLimit     = cbMax;
+        fOverflow   = false;
+        return(*this);
+    }
+
+    // string literals, the length is known at compile time
+    template<uint32_t cbsz>
+    OSRESP& Append(char const (&sz)[cbsz])
+    {
+        return(Append(sz, cbsz-1));
+    }
+
+    OSRESP& Append(char const * pchAdd, uint32_t cbAdd)
+    {
+        if(Room(cbAdd))
+        {
+            memcpy(&pch[cb], pchAdd, cbAdd);
+            cb += cbAdd;
+        }
+        return(*this);
+    }
+
+    OSRESP& Append(char ch)
+    {
+        if(Room(1)) pch[cb++] = ch;
+        return(*this);
+    }
+
+    // for strings picked at runtime out of a table
+    OSRESP& AppendSz(char const * sz)
+    {
+        return(Append(sz, strlen(sz)));
+    }
+
+    // decimal integers, formatted by OSMath
+    OSRESP& AppendU32(uint32_t u);
+    OSRESP& AppendI32(int32_t i);
+    OSRESP& AppendU64(uint64_t u);
+    OSRESP& AppendI64(int64_t i);
+};
+
 class OSPAR : public JSON
 {
 public:
@@ -30,7 +124,12 @@ public:
     typedef struct _STRU32
     {
         char const * const  szToken;
+        const uint32_t      cbToken;
         const uint32_t      u32;
+
+        // the token length is taken from the string literal at compile time
+        template<uint32_t cbsz>
+        constexpr _STRU32(char const (&sz)[cbsz], uint32_t u) : szToken(sz), cbToken(cbsz-1), u32(u) {}
     } STRU32;
 
     typedef struct _ODATA
@@ -55,9 +154,37 @@ public:
     {
         NONE,
         JSON,
-        OSJB
+        OSJB,
+        TLV
     } OSCMD;
 
+    // the type byte of a binary TLV token; these are the wire values and must not change,
+    // they are mapped to JSONTOKEN so the lexer's enum can be reordered without breaking clients
+    typedef enum
+    {
+        TLVNone         = 0,
+        TLVObject       = 1,
+        TLVEndObject    = 2,
+        TLVArray        = 3,
+        TLVEndArray     = 4,
+        TLVMemberName   = 5,
+        TLVString       = 6,
+        TLVNumber       = 7,
+        TLVTrue         = 8,
+        TLVFalse        = 9,
+        TLVNull         = 10,
+        TLVEnd
+    } TLVTYPE;
+
+    // cached responses
+    typedef enum
+    {
+        RCEnumerate,
+        RCCalibrationRead,
+        RCStorageGetLocations,
+        RCEND
+    } RCID;
+
     typedef enum
     {
         ICDNone,
@@ -83,10 +210,18 @@ private:
 
     bool            fError;
     bool            fDoneReadingJSON;
+    bool            fBatch;                     // parsing an array of command objects
     bool            fWrite;
 
     uint32_t        tStartCmd;
     uint32_t        tLastCmd;
+    uint32_t        tWhenReady;                 // when a readWhenReady started waiting
+
+    // latency stats for this command
+    uint32_t        iCmdStat;                   // which end point, CMDSTATTYPES-1 if none
+    uint32_t        tParseCmd;                  // core ticks spent lexing and parsing
+    uint32_t        tOutputCmd;                 // when the output started
+    bool            fCmdOutput;                 // got as far as output
 
     int32_t         cbStreamInception;
     int32_t         iStream;
@@ -103,8 +238,21 @@ private:
     int32_t         iOSJBCount;
     char            szOSJBCount[128];
 
+    // binary TLV commands, STX, uint16_t frame length, then {uint8_t TLVTYPE, uint8_t cb, value} tokens
+    static const char chTLVStart = 0x02;        // STX
+    JSONTOKEN       tokTLV;                     // the JSONTOKEN the type of the current TLV maps to
+    int32_t         cbTLVFrame;                 // how much of the frame is left to read
+    int32_t         iTLV;                       // how much of the current TLV we have
+    bool            fTLVValueEnd;               // the last token ended a value, a value separator comes before the next one
+    char            rgbTLV[260];                // type, cb, '"', value, '"'
+
     char            pchJSONRespBuff[0x4000];    // 16384 bytes for output OSJB
 
+    // log read back, pchJSONRespBuff is split in 2 halves; one is being sent while the other is read ahead
+    int32_t         iLogOData;                  // the odata being streamed from a log file, 0 if none
+    int32_t         iLogSend;                   // the half last handed out to be sent, -1 if none
+    int32_t         rgcbLog[2];                 // how many bytes are ready in each half, 0 if empty
+
     // JSON callback routine; Must be supplied
     STATE ParseToken(char const * szToken, uint32_t cbToken, JSONTOKEN jsonToken); 
 
@@ -112,19 +260,33 @@ private:
     GCMD::ACTION ReadJSONResp(int32_t iOData, uint8_t const *& pbRead, int32_t& cbRead);
     GCMD::ACTION ReadFile(int32_t iOData, uint8_t const *& pbRead, int32_t& cbRead);
     GCMD::ACTION ReadLogFile(int32_t iOData, uint8_t const *& pbRead, int32_t& cbRead);
+    bool ReadLogBuff(int32_t iOData, int32_t iHalf);
+    bool RespFromCache(RCID rcid);
+    void RespToCache(RCID rcid, uint32_t iStart);
+    void RecordCmdStats(void);
+    void ReleaseParse(void);
+    void ReleaseEndpoints(void);
+    void ClaimEndpoint(STATE stateEndpoint);
  
 public:
     bool            fLocked;
     int32_t         iOData;
     int32_t         cOData;
     int32_t         cIData;
-    ODATA           odata[4];
+    ODATA           odata[8];                   // the JSON plus room for a batch to read every instrument
     IDATA           idata[4];
 
     uint8_t const * pbOutput;
     int32_t         cbOutput;
 
-    OSPAR() : tStartCmd(0), tLastCmd(0)
+    // the output is a whole buffer locked for output, it stays put until
+    // the next call unlocks it; so it can be sent without copying it
+    bool IsOutputPinned(void)
+    {
+        return(stateOSJB == OSJBWriteOData && iOData < cOData && odata[iOData].ReadData == &OSPAR::ReadJSONResp && pbOutput == odata[iOData].pbOut);
+    }
+
+    OSPAR() : tStartCmd(0), tLastCmd(0), tWhenReady(0), iCmdStat(CMDSTATTYPES-1), tParseCmd(0), tOutputCmd(0), fCmdOutput(false), fLocked(false)
     {
         Init(ICDNone);
     }
@@ -147,6 +309,7 @@ public:
         cStrU32             = 0;
 
         fError              = false;
+        fBatch              = false;
         fWrite              = false;
 
         cbStreamInception   = 0;
@@ -162,7 +325,11 @@ public:
         iChunk              = 0;
         iOSJBCount          = 0;
 
-        fLocked             = false;
+        cbTLVFrame          = 0;
+        iTLV                = 0;
+        tokTLV              = tokNone;
+        fTLVValueEnd        = false;
+
         iOData              = 0;
         cOData              = 1;
         cIData              = 0;
@@ -170,6 +337,14 @@ public:
         pbOutput            = NULL;
         cbOutput            = 0;
 
+        iLogOData           = 0;
+        iLogSend            = -1;
+        rgcbLog[0]          = 0;
+        rgcbLog[1]          = 0;
+
+        // let the other parsers in
+        ReleaseParse();
+
         memset(idata, 0, sizeof(idata));
         memset(odata, 0, sizeof(odata));
 
@@ -183,11 +358,18 @@ public:
         switch(icd)
         {
             case ICDStart:
-                tStartCmd = ReadCoreTimer();
+                tStartCmd   = ReadCoreTimer();
+                iCmdStat    = CMDSTATTYPES-1;
+                tParseCmd   = 0;
+                fCmdOutput  = false;
                 break;
 
+            // fLocked is only let go at the end, StreamOS calls Init() between commands
+            // and the owner must keep the parser until it is done with it
             case ICDEnd:
                 tLastCmd = (ReadCoreTimer() - tStartCmd) / CORE_TMR_TICKS_PER_USEC;
+                RecordCmdStats();
+                fLocked = false;
                 break;
 
             default:
@@ -198,14 +380,20 @@ public:
 
     OSCMD IsOSCmdStart(char ch)
     {
-        if(ch == '{') return(OSPAR::JSON);
+        if(ch == '{' || ch == '[') return(OSPAR::JSON);      // an object, or a batch of them
+        else if(ch == chTLVStart) return(OSPAR::TLV);
         else if(('0' <= ch && ch <= '9') || ('a' <= ch && ch <= 'f') || ('A' <= ch && ch <= 'F')) return(OSPAR::OSJB);
 
         return(OSPAR::NONE);
     }
 
     GCMD::ACTION StreamOS(char const * szStream, int32_t cbStream);
+
+    // true while the binary part of an OSJB upload is being handed to its writer
+    bool IsReadingBinary(void) { return(stateOSJB == OSJBReadBinary); }
+
     GCMD::ACTION WriteOSJBFile(char const pchWrite[], int32_t cbWrite, int32_t& cbWritten);
+    void LogReadAhead(void);
 };
 #endif // c++
 #endif
\ No newline at end of file
@@ -12,9 +12,65 @@
 /*  Revision History:                                                   */
 /*                                                                      */
 /*    8/3/2016 (KeithV): Created                                        */
+/*    10/19/2026 (KeithV): Log writes are sized from the back log       */
+/*    10/19/2026 (KeithV): Log write time and headroom kept per log     */
 /************************************************************************/
 #include <OpenScope.h>
 
+/************************************************************************/
+/*    Log write scheduler                                               */
+/*                                                                      */
+/*    SD cards are much faster per sector on large multi-sector writes, */
+/*    but a large write stalls the loop. So while we are keeping up we  */
+/*    only write what fits in LOGMAXTICKSPERWRT; once the back log      */
+/*    builds we write bigger chunks to catch up before we overflow.     */
+/*                                                                      */
+/*    tLogSector is the measured time to write one sector, from that    */
+/*    and the sample rate we know how fast the back log grows while we  */
+/*    write, and how much SD bandwidth headroom we have. Both are kept  */
+/*    per log as each log has its own sample rate and file.             */
+/************************************************************************/
+static uint32_t LOGSectorsToWrite(IALOG& ialog)
+{
+    uint32_t    cSectors = LOGMAXSECTORWRT;
+
+    // no measurement yet, be conservative
+    if(ialog.tLogSector == 0) return(cSectors);
+
+    // behind, write the whole back log, the bigger the write the higher the throughput
+    if(ialog.bidx.cBackLog > LOGCATCHUPBACKLOG)
+    {
+        cSectors = (ialog.bidx.cBackLog + LOGSMPPERSECTOR - 1) / LOGSMPPERSECTOR;
+    }
+
+    // keeping up, write what fits in our time budget
+    else
+    {
+        cSectors = max((uint32_t) (LOGMAXTICKSPERWRT / ialog.tLogSector), (uint32_t) LOGMAXSECTORWRT);
+    }
+
+    return(min(cSectors, (uint32_t) LOGMAXSECTORADP));
+}
+
+static void LOGUpdateWriteTime(IALOG& ialog, uint32_t tWrite, uint32_t cbWritten)
+{
+    uint32_t    cSectors = (cbWritten + _FATFS_CBSECTOR_ - 1) / _FATFS_CBSECTOR_;
+    uint64_t    cSmplPerSector;
+
+    if(cSectors == 0) return;
+
+    // running average over the last 8 or so writes
+    tWrite /= cSectors;
+    if(ialog.tLogSector == 0) ialog.tLogSector = tWrite;
+    else ialog.tLogSector = (7 * ialog.tLogSector + tWrite) / 8;
+
+    // how many samples come in while we write one sector; xsps is in uSPS
+    cSmplPerSector = (ialog.bidx.xsps * ialog.tLogSector) / (1000000ull * CORE_TMR_TICKS_PER_SEC);
+
+    // what percent of the sector write rate is left over
+    ialog.logHeadroom = 100 - (int32_t) ((100 * min(cSmplPerSector, 100ull * LOGSMPPERSECTOR)) / LOGSMPPERSECTOR);
+}
+
 static void ALogProcess(IALOG& ialog)
 {
 
@@ -77,6 +133,7 @@ static void ALogProcess(IALOG& ialog)
                     uint32_t    tCur                = ReadCoreTimer();
 
                     uint32_t    cThisTime;
+                    uint32_t    cSectors            = LOGSectorsToWrite(ialog);
                     uint64_t    cTotalSampled;
                     uint64_t    cWrittenSampled;
                     int32_t     iDMA;
@@ -149,11 +206,11 @@ static void ALogProcess(IALOG& ialog)
                     // normal write, sector align
                     else
                     {
-                        cThisTime =  ialog.bidx.cBackLog - (ialog.bidx.cBackLog % ((_FATFS_CBSECTOR_)/sizeof(uint16_t)));
+                        cThisTime =  ialog.bidx.cBackLog - (ialog.bidx.cBackLog % LOGSMPPERSECTOR);
                     }
 
-                    // limit us to what we will write in a pass
-                    if(cThisTime > LOGMAXSMPTORWRT) cThisTime = LOGMAXSMPTORWRT;
+                    // limit us to what the scheduler says to write in this pass
+                    if(cThisTime > cSectors * LOGSMPPERSECTOR) cThisTime = cSectors * LOGSMPPERSECTOR;
 
                     // if we have something to write and we are not in an error condition, write the data.
                     // note, we may be
@@ -177,6 +234,7 @@ static void ALogProcess(IALOG& ialog)
                             int16_t         rgu16[LOGMAXBUFFSIZE];
                             uint32_t        cSmpl                   = (ialog.bidx.iDMAStart + cThisTime) > LOGDMASIZE ? LOGDMASIZE - ialog.bidx.iDMAStart : cThisTime;;
                             uint32_t        cbWritten               = 0;
+                            uint32_t        tWrite;
 
                             // copy and convert
                             memcpy(rgu16, &ialog.pBuff[ialog.bidx.iDMAStart], cSmpl*sizeof(uint16_t));
@@ -184,12 +242,19 @@ static void ALogProcess(IALOG& ialog)
 
                             OSCVinFromDadcArray((HINSTR) &osc, rgu16, cThisTime);
 
-                            if(dFile.fswrite(rgu16, cThisTime*sizeof(uint16_t), &cbWritten, LOGMAXSECTORWRT) != FR_OK)
+                            tWrite = ReadCoreTimer();
+                            if(dFile.fswrite(rgu16, cThisTime*sizeof(uint16_t), &cbWritten, cSectors) != FR_OK)
                             {
                                 ALOGStop(&ialog);
                                 ialog.stcd              = STCDError; 
                             }
 
+                            // only time good writes, an error return time says nothing about the card
+                            else
+                            {
+                                LOGUpdateWriteTime(ialog, ReadCoreTimer() - tWrite, cbWritten);
+                            }
+
                             ialog.tStart = tCur;         // restart the timer
 
                             cbWritten /= sizeof(uint16_t);
@@ -312,6 +377,246 @@ static void ALogProcess(IALOG& ialog)
     }
 }
 
+/************************************************************************/
+/*    Digital Logger                                                    */
+/*                                                                      */
+/*    PORTE is sampled circularly into rgLOGICBuff; the back log is     */
+/*    run length encoded into rgDLogRuns and whole sectors of runs are  */
+/*    written to the file, so a quiet bus costs almost nothing.         */
+/************************************************************************/
+static uint8_t rgDLogRuns[DLOGRUNSECTORS * _FATFS_CBSECTOR_];
+
+static void DLOGPutRun(IDLOG& idlog)
+{
+    DLogRun run = {idlog.curValue, idlog.cRun};
+
+    ASSERT(idlog.cbRuns + sizeof(DLogRun) <= sizeof(rgDLogRuns));
+
+    memcpy(&rgDLogRuns[idlog.cbRuns], &run, sizeof(DLogRun));
+    idlog.cbRuns += sizeof(DLogRun);
+    idlog.cRun = 0;
+}
+
+static void DLOGEncode(IDLOG& idlog)
+{
+    int32_t     iDMA    = idlog.bidx.iDMAStart;
+    int32_t     cSmpl   = idlog.bidx.cBackLog;
+
+    // stop when we no longer have room for a run
+    while(cSmpl > 0 && (idlog.cbRuns + sizeof(DLogRun)) <= sizeof(rgDLogRuns))
+    {
+        uint16_t value = idlog.pBuff[iDMA] & idlog.bitMask;
+
+        if(idlog.cRun > 0 && (value != idlog.curValue || idlog.cRun == 0xFFFFFFFF))
+        {
+            DLOGPutRun(idlog);
+        }
+
+        if(idlog.cRun == 0) idlog.curValue = value;
+        idlog.cRun++;
+
+        cSmpl--;
+        iDMA++;
+        if(iDMA == DLOGDMASIZE)
+        {
+            iDMA = 0;
+            idlog.bidx.cSavedRoll++;
+        }
+    }
+
+    idlog.bidx.iDMAStart    = iDMA;
+    idlog.bidx.cBackLog     = cSmpl;
+}
+
+static void DLogProcess(IDLOG& idlog)
+{
+
+    switch(idlog.state.processing)
+    {
+        case Idle:
+        case Stopped:
+        case Waiting:
+            break;
+
+        case Queued:
+            idlog.state.processing = Working;
+            break;
+
+        case Working:
+            {
+                DFILE&      dFile               = *((DFILE *) idlog.pdFile);
+
+                // make sure the file is closed
+                if(dFile) dFile.fsclose();
+
+                idlog.bidx.cTotalSamples    = 0;    // total number of valid samples          
+                idlog.bidx.iDMAEnd          = 0;    // end of valid data in DMA buffer   
+                idlog.bidx.cDMARoll         = 0;    // roll count
+                idlog.bidx.iDMAStart        = 0;    // start of unencoded samples in DMA buffer
+                idlog.bidx.cSavedRoll       = 0;    // unencoded DMA roll count
+                idlog.bidx.cBackLog         = 0;    // how many samples are left to encode
+                idlog.cRun                  = 0;    // no run started
+                idlog.cbRuns                = 0;    // no runs to write
+                idlog.cRunsWritten          = 0;    // no runs in the file
+                idlog.stcd                  = STCDNormal;   // Normal stop condition.
+                idlog.tStart                = ReadCoreTimer();
+                idlog.state.processing      = Running;
+                idlog.state.instrument      = WaitingRun;
+
+                // open the file it should already exist, seek to end
+                if( DFATFS::fschdrive(DFATFS::szFatFsVols[idlog.vol])                   != FR_OK    || 
+                    DFATFS::fschdir(DFATFS::szRoot)                                     != FR_OK    ||
+                    dFile.fsopen(idlog.szURI, FA_OPEN_EXISTING | FA_WRITE | FA_READ)    != FR_OK    ||
+                    dFile.fslseek(dFile.fssize())                                       != FR_OK    )
+                {
+                    dFile.fsclose();
+                    idlog.state.instrument  = Idle;
+                    idlog.stcd              = STCDError; 
+                }
+            }
+            break;
+
+        case Running:
+            {
+                DLOG const& dlog                = *((DLOG *) rgInstr[idlog.id]);
+                DFILE&      dFile               = *((DFILE *) idlog.pdFile);
+                uint32_t    tCur                = ReadCoreTimer();
+                uint32_t    cbThisTime          = 0;
+                bool        fFinish             = false;
+                int32_t     iDMA;
+                int32_t     clDMA;
+
+                if(idlog.state.instrument != Idle) idlog.state.instrument = DLOGRun(&idlog);
+
+                // get a good dma location
+                do
+                {
+                    clDMA   = idlog.bidx.cDMARoll;
+                    iDMA    = (idlog.state.instrument == Idle) ? (idlog.bidx.iDMAEnd * sizeof(uint16_t)) : dlog.pla->pDMA->DCHxDPTR;
+                } while(idlog.bidx.cDMARoll != clDMA);
+
+                // convert to sample index
+                iDMA /= sizeof(uint16_t);    
+
+                idlog.bidx.cBackLog = (((int64_t) clDMA) * DLOGDMASIZE + iDMA) - (((int64_t) idlog.bidx.cSavedRoll) * DLOGDMASIZE + idlog.bidx.iDMAStart);
+                ASSERT(idlog.bidx.cBackLog >= 0);
+
+                // if we overran the LA buffer, or filled the file; say we overflowed
+                if(idlog.stcd == STCDNormal && (idlog.bidx.cBackLog > DLOGMAXBACKLOG || idlog.cRunsWritten >= DLOGMAXFILERUNS))
+                {
+                    DLOGStop(&idlog);
+                    idlog.stcd = STCDOverflow;
+                }
+
+                // encode what we have, on a stop condition the back log is dropped
+                if(idlog.stcd == STCDNormal) DLOGEncode(idlog);
+
+                // once the sampler stopped and there is nothing to encode, close out the last run
+                if(idlog.state.instrument == Idle && (idlog.stcd != STCDNormal || idlog.bidx.cBackLog == 0))
+                {
+                    if(idlog.cRun > 0 && (idlog.cbRuns + sizeof(DLogRun)) <= sizeof(rgDLogRuns)) DLOGPutRun(idlog);
+                    fFinish = (idlog.cRun == 0);
+                }
+
+                // write whole sectors, unless we are finishing or the timer expired
+                if(fFinish || (tCur - idlog.tStart) > LOGMAXTICKSBEFORESDSAVE)
+                {
+                    cbThisTime = idlog.cbRuns;
+                }
+                else
+                {
+                    cbThisTime = idlog.cbRuns - (idlog.cbRuns % _FATFS_CBSECTOR_);
+                }
+
+                if(cbThisTime > 0 && idlog.stcd != STCDError)
+                {
+                    uint32_t cbWritten = 0;
+
+                    // open the file if it needs to be open
+                    if(!dFile &&
+                        (DFATFS::fschdrive(DFATFS::szFatFsVols[idlog.vol])                  != FR_OK    || 
+                         DFATFS::fschdir(DFATFS::szRoot)                                    != FR_OK    ||
+                         dFile.fsopen(idlog.szURI, FA_OPEN_EXISTING | FA_WRITE | FA_READ)   != FR_OK    ||
+                         dFile.fslseek(dFile.fssize())                                      != FR_OK    ))
+                    {
+                        dFile.fsclose();
+                        DLOGStop(&idlog);
+                        idlog.stcd              = STCDError; 
+                    }
+
+                    else if(dFile.fswrite(rgDLogRuns, cbThisTime, &cbWritten, DFILE::FS_INFINITE_SECTOR_CNT) != FR_OK || cbWritten != cbThisTime)
+                    {
+                        DLOGStop(&idlog);
+                        idlog.stcd              = STCDError; 
+                    }
+
+                    else
+                    {
+                        idlog.cRunsWritten  += cbWritten / sizeof(DLogRun);
+                        idlog.cbRuns        -= cbWritten;
+                        memmove(rgDLogRuns, &rgDLogRuns[cbWritten], idlog.cbRuns);
+                    }
+
+                    idlog.tStart = tCur;         // restart the timer
+                }
+
+                // on a write error, whatever we have can not be saved
+                if(idlog.stcd == STCDError)
+                {
+                    idlog.cbRuns        = 0;
+                    idlog.cRun          = 0;
+                    fFinish             = (idlog.state.instrument == Idle);
+                }
+
+                // finish and get out
+                if(fFinish && idlog.cbRuns == 0)
+                {
+                    idlog.bidx.cTotalSamples = ((int64_t) idlog.bidx.cSavedRoll) * DLOGDMASIZE + idlog.bidx.iDMAStart;
+
+                    // open the file if it needs to be open
+                    if( !dFile &&
+                           (DFATFS::fschdrive(DFATFS::szFatFsVols[idlog.vol])                  != FR_OK    || 
+                            DFATFS::fschdir(DFATFS::szRoot)                                    != FR_OK    ||
+                            dFile.fsopen(idlog.szURI, FA_OPEN_EXISTING | FA_WRITE | FA_READ)   != FR_OK    ))
+                    {
+                        dFile.fsclose();
+                        idlog.stcd              = STCDError; 
+                    }
+
+                    // write out the header
+                    // make sure we seek to the front of the file
+                    else if(dFile.fslseek(0) == FR_OK)
+                    {
+                        LogHeader   logHdr  = LogHeader(sizeof(DLogRun), DLOGFMT);
+                        uint32_t    cbHdr   = 0;  
+
+                        logHdr.AHdr.stopReason   = idlog.stcd;
+                        logHdr.AHdr.iStart       = 0;             
+                        logHdr.AHdr.actualCount  = idlog.bidx.cTotalSamples;        
+                        logHdr.AHdr.uSPS         = idlog.bidx.xsps;               
+                        logHdr.AHdr.psDelay      = 0;  
+                        dFile.fswrite(&logHdr, sizeof(logHdr), &cbHdr, DFILE::FS_INFINITE_SECTOR_CNT);
+                    }
+                       
+                    dFile.fsclose();
+                    idlog.state.processing = Stopped;
+                    idlog.buffLock = LOCKAvailable;
+                }
+
+                // haven't written anything for awhile, close the file
+                else if(dFile && (tCur - idlog.tStart) > LOGMAXTICKSBEFORESDSAVE)
+                {
+                    dFile.fsclose();
+                }
+            }
+            break;
+
+        default:
+            ASSERT(NEVER_SHOULD_GET_HERE);
+            break;
+    }
+}
+
 static void TRGProcess(void)
 {
     uint32_t    i;
@@ -638,6 +943,7 @@ static void Calibrate(void)
             if((pjcmd.iCal.state.instrument = CFGCalibrateInstruments(instrGrp)) == Idle) 
             {
                 pjcmd.iCal.state.processing     = Idle;
+                respCacheVersion++;
 
                 pjcmd.trigger.state.processing  = Idle;
                 pjcmd.iawg.state.processing     = Idle;
@@ -652,6 +958,7 @@ static void Calibrate(void)
             else if(IsStateAnError(pjcmd.iCal.state.instrument))
             {
                 pjcmd.iCal.state.processing     = NotCfgForCalibration;
+                respCacheVersion++;
 
                 pjcmd.trigger.state.processing  = Idle;
                 pjcmd.iawg.state.processing     = Idle;
@@ -687,6 +994,9 @@ static void Calibrate(void)
             if(pjcmd.iCal.state.instrument == Idle || IsStateAnError(pjcmd.iCal.state.instrument)) 
             {
                 pjcmd.iCal.state.processing     = Idle;
+
+                // the calibration source and values may have changed
+                respCacheVersion++;
             }
             break;
 
@@ -712,6 +1022,9 @@ static void Calibrate(void)
             if(pjcmd.iCal.state.instrument == Idle || IsStateAnError(pjcmd.iCal.state.instrument)) 
             {
                 pjcmd.iCal.state.processing     = Idle;
+
+                // the calibration source and values may have changed
+                respCacheVersion++;
             }
             break;
 
@@ -835,6 +1148,10 @@ STATE JSONCmdTask(void)
 
     ALogProcess(pjcmd.iALog1);
     ALogProcess(pjcmd.iALog2);
+    DLogProcess(pjcmd.iDLog1);
+
+    // read ahead the logs being read back
+    for(uint32_t i = 0; i < COSPAR; i++) rgOSPar[i].LogReadAhead();
 
     Serial.PeriodicTask(&DCH1CON);
     
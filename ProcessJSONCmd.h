@@ -22,6 +22,7 @@
 #ifdef __cplusplus
 extern DFILE dLFile1;             // Create a File handle to use with Logging
 extern DFILE dLFile2;             // Create a File handle to use with Logging
+extern DFILE dLFile3;             // Create a File handle to use with digital Logging
 #endif
 
 typedef enum
@@ -199,6 +200,8 @@ typedef struct _ILA
     uint32_t        iBinOffset;     // the offset of the binary in the file after the JSON
     STATE           buffLock;       // the locked state of the buffer
     uint16_t * const pBuff;         // point to the data buffer
+    bool            fRLE;           // return the read as {value, count} runs
+    bool            fBadEncoding;   // the read asked for an encoding we don't know
 } ILA;
 
 typedef struct _IALOG
@@ -220,18 +223,28 @@ typedef struct _IALOG
     uint32_t        iBinOffset;     // the offset of the binary in the file after the JSON
     int16_t * const pBuff;          // point to the data buffer
     char            szURI[MAX_PATH+1]; // The file name or URL to the place to store the data logs
+    uint32_t        tLogSector;     // running average core ticks to write one sector of this log, 0 until measured
+    int32_t         logHeadroom;    // percent of the SD write bandwidth left over at this log's sample rate
 } IALOG;
 
 typedef struct _IDLOG
 {
     PSTATE          state;          // all of the parsing states
     INSTR_ID const  id;             // the instrument ID
-    uint64_t        sps;            // samples per second
+    VOLTYPE         vol;            // where to store the data, only the SD card is supported
+    int64_t         maxSamples;     // how many samples to take, -1 forever
     uint16_t        bitMask;        // bit Mask of channels in use
+    BIDX            bidx;           // samples per second and DMA roll indexes
+    STCD            stcd;           // stop condition
+    uint32_t        tStart;         // how often we must do an SD card save, for really slow sample rates
+    void *          pdFile;         // pointer to the dfile to use for writting the LOG file
     STATE           buffLock;       // the locked state of the buffer
-    uint32_t        iBinOffset;     // the offset of the binary in the file after the JSON
-    uint32_t        cBuff;          // how many entries in the buffer
-    uint16_t * const pBuff;          // point to the data buffer
+    uint16_t        curValue;       // the value of the run being encoded
+    uint32_t        cRun;           // how many samples in the run being encoded, 0 if no run yet
+    uint32_t        cbRuns;         // how many bytes of encoded runs are waiting to be written
+    uint32_t        cRunsWritten;   // how many runs are in the file
+    uint16_t * const pBuff;         // point to the data buffer
+    char            szURI[MAX_PATH+1]; // The file name or URL to the place to store the data logs
 } IDLOG;
 
 typedef struct _IGPIOPIN
@@ -356,7 +369,9 @@ typedef struct _PJCMD
                 iALog2({ {Idle, Idle, Idle}, ALOG2_ID, VOLRAM, -1, 0, OVFCircular, 0, 4,
                             {100000000, 0, 0, 0, 2000, 1, false, {0, 0, 0, 0, 0, 0, 0}, LOGPBCLK, 2ll*LOGuSPS, LOGDMASIZE, LOGMAXBUFFSIZE, LOGOVERSIZE},
                             STCDNormal, 0, 0, &dLFile2, LOCKAvailable, 0, rgOSC2Buff, {0}}),
-                iDLog1({ {Idle, Idle, Idle}, DLOG1_ID, LOGuSPS, 0, LOCKAvailable, 0, 0, rgLOGICBuff}),
+                iDLog1({ {Idle, Idle, Idle}, DLOG1_ID, VOLSD, -1, 0x03FF,
+                            {1000000000, 0, 0, 0, 2000, 1, false, {0, 0, 0, 0, 0, 0, 0}, LAPBCLK, 2ll*DLOGuSPS, DLOGDMASIZE, DLOGDMASIZE, 0},
+                            STCDNormal, 0, &dLFile3, LOCKAvailable, 0, 0, 0, 0, rgLOGICBuff, {0}}),
                 iMfgTest({0})
     {
         memset(iWiFi.szPassphrase, 0, sizeof(iWiFi.szPassphrase));
@@ -426,6 +441,10 @@ static void inline __attribute__((always_inline)) StopInstrumentTimer(INSTR_ID i
 //            IEC4CLR  = _IEC4_DMA6IE_MASK;               // Stop rollover counter
             break;
 
+        case DLOG1_ID:
+            T7CONCLR = _T7CON_ON_MASK;                  // Stop taking DMA samples of PORTE
+            break;
+
             // sometimes we invalidate ID on the fly
             // if we get a force stop
         case NULL_ID:
@@ -11,6 +11,7 @@
 /*  Revision History:                                                   */
 /*                                                                      */
 /*    8/10/2016 (KeithV): Created                                        */
+/*    10/19/2026 (KeithV): Abort leaves the LA to a running DLOG        */
 /************************************************************************/
 #include <OpenScope.h>
 
@@ -387,7 +388,8 @@ void TRGAbort(void)
     IEC3CLR = _IEC3_CNEIE_MASK;     // Stop any LA interrupts
 
     // got to check to see if the DMA is working on the logic analyzer
-    if(IsLALocked())
+    // but leave it alone if the digital logger owns it
+    if(IsLALocked() && !IsDLOGRunning())
     {       
         T7CONbits.ON = 0;       // Stop taking LA samples
         UnLockLA();
@@ -0,0 +1,208 @@
+/************************************************************************/
+/*                                                                      */
+/*    OSMathTest.c                                                      */
+/*                                                                      */
+/*    Checks the digit pair decimal formatting in OSMath.c against      */
+/*    the division loop it replaced, and times both                     */
+/*                                                                      */
+/************************************************************************/
+/*    Author:     Keith Vogel                                           */
+/*    Copyright 2026, Digilent Inc.                                     */
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  Links the real OSMath.c. Every value is formatted by OldUlltoa,     */
+/*  the ulltoa OSMath.c had before, and by snprintf, and the two must   */
+/*  agree with OSU64ToDec, OSU32ToDec, OSI64ToDec, ulltoa and illtoa,   */
+/*  and the returned lengths with strlen. The values are each power of  */
+/*  ten and its neighbours, the 32 bit and 8 digit piece edges, the     */
+/*  64 bit limits, and random values spread evenly over bit lengths.    */
+/*  Bases 2 and 16 are checked too, they still take the old loop.       */
+/*                                                                      */
+/*  Then it times OldUlltoa against OSU64ToDec on a sample rate in mHz, */
+/*  a trigger delay in ps and full 20 digit values. A PC divides 64     */
+/*  bits in hardware; the PIC32 calls a library routine for every       */
+/*  64 bit divide, so the gap on the board is wider than shown here.    */
+/*                                                                      */
+/*  Exits 0 if everything matched, 1 on the first mismatch; a seed can  */
+/*  be given on the command line. Build from this directory with:       */
+/*                                                                      */
+/*    gcc -O2 -I. -o OSMathTest OSMathTest.c ../OSMath.c                */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*    10/19/2026 (KeithV): Created                                      */
+/************************************************************************/
+#include <stdio.h>
+#include <time.h>
+#include <OpenScope.h>
+
+#define cRandom     2000000
+#define cBench      2000000
+
+static uint32_t cChecked = 0;
+
+// ulltoa before the digit pairs, the reference
+static char * OldUlltoa(uint64_t val, char * buf, uint32_t base)
+{
+	uint64_t	v;
+	char		c;
+
+	v = val;
+	do {
+		v /= base;
+		buf++;
+	} while(v != 0);
+	*buf-- = 0;
+	do {
+		c = val % base;
+		val /= base;
+		if(c >= 10)
+			c += 'A'-'0'-10;
+		c += '0';
+		*buf-- = c;
+	} while(val != 0);
+	return ++buf;
+}
+
+static bool Mismatch(char const * szWhat, char const * szGot, char const * szExpected)
+{
+    if(strcmp(szGot, szExpected) == 0) return(false);
+
+    printf("%s: got \"%s\", expected \"%s\"\n", szWhat, szGot, szExpected);
+    return(true);
+}
+
+static bool CheckU64(uint64_t val)
+{
+    char        szOld[72];
+    char        szPrintf[72];
+    char        szNew[72];
+    char        szHex[72];
+    uint32_t    cch;
+
+    OldUlltoa(val, szOld, 10);
+    snprintf(szPrintf, sizeof(szPrintf), "%" PRIu64, val);
+    if(Mismatch("OldUlltoa", szOld, szPrintf)) return(false);
+
+    memset(szNew, 'x', sizeof(szNew));
+    cch = OSU64ToDec(val, szNew);
+    if(Mismatch("OSU64ToDec", szNew, szOld)) return(false);
+    if(cch != strlen(szOld))
+    {
+        printf("OSU64ToDec(%s) returned length %u\n", szOld, cch);
+        return(false);
+    }
+
+    if(Mismatch("ulltoa base 10", ulltoa(val, szNew, 10), szOld)) return(false);
+    if(Mismatch("ulltoa base 16", ulltoa(val, szNew, 16), OldUlltoa(val, szHex, 16))) return(false);
+    if(Mismatch("ulltoa base 2", ulltoa(val, szNew, 2), OldUlltoa(val, szHex, 2))) return(false);
+
+    if(val <= 0xFFFFFFFFull)
+    {
+        cch = OSU32ToDec((uint32_t) val, szNew);
+        if(Mismatch("OSU32ToDec", szNew, szOld)) return(false);
+        if(cch != strlen(szOld))
+        {
+            printf("OSU32ToDec(%s) returned length %u\n", szOld, cch);
+            return(false);
+        }
+    }
+
+    cChecked++;
+    return(true);
+}
+
+static bool CheckI64(int64_t val)
+{
+    char        szPrintf[72];
+    char        szNew[72];
+    uint32_t    cch;
+
+    snprintf(szPrintf, sizeof(szPrintf), "%" PRId64, val);
+
+    cch = OSI64ToDec(val, szNew);
+    if(Mismatch("OSI64ToDec", szNew, szPrintf)) return(false);
+    if(cch != strlen(szPrintf))
+    {
+        printf("OSI64ToDec(%s) returned length %u\n", szPrintf, cch);
+        return(false);
+    }
+
+    if(Mismatch("illtoa", illtoa(val, szNew, 10), szPrintf)) return(false);
+
+    cChecked++;
+    return(true);
+}
+
+static uint64_t Random64(void)
+{
+    uint64_t val = 0;
+    int i;
+
+    for(i = 0; i < 4; i++) val = (val << 16) | (rand() & 0xFFFF);
+
+    // even over bit lengths, so short numbers get as many trials as long ones
+    return(val >> (rand() % 64));
+}
+
+static double NsPerValue(clock_t tStart, uint32_t cRuns)
+{
+    return(((double) (clock() - tStart) / CLOCKS_PER_SEC) * 1e9 / cRuns);
+}
+
+int main(int argc, char * argv[])
+{
+    unsigned int    seed    = (argc > 1) ? strtoul(argv[1], NULL, 0) : 1;
+    uint64_t        pow10   = 1;
+    uint64_t        rgEdges[] = {0, 0xFFFFFFFFull, 0x100000000ull, 99999999ull, 100000000ull,
+                                0xFFFFFFFFull * 100000000ull + 99999999ull, (0xFFFFFFFFull + 1) * 100000000ull,
+                                INT64_MAX, (uint64_t) INT64_MAX + 1, UINT64_MAX - 1, UINT64_MAX};
+    uint64_t        rgBench[] = {100000000000ull, 2500000000000ull, 1000000000000000ull, UINT64_MAX};
+    char const *    rgszBench[] = {"100 MS/s in mHz", "2.5 s in ps", "1000 s in ps", "20 digits"};
+    char            sz[72];
+    uint32_t        i, j;
+    clock_t         tStart;
+    volatile uint32_t cchSink = 0;
+
+    srand(seed);
+
+    // every power of 10 and its neighbors, to the top of a uint64_t
+    for(i = 0; i < 20; i++, pow10 *= 10)
+    {
+        if(!CheckU64(pow10 - 1) || !CheckU64(pow10) || !CheckU64(pow10 + 1)) return(1);
+        if(!CheckI64(-(int64_t) pow10) || !CheckI64(1 - (int64_t) pow10) || !CheckI64((int64_t) pow10 - 1)) return(1);
+    }
+
+    for(i = 0; i < sizeof(rgEdges) / sizeof(rgEdges[0]); i++)
+    {
+        if(!CheckU64(rgEdges[i])) return(1);
+    }
+    if(!CheckI64(INT64_MIN) || !CheckI64(INT64_MIN + 1) || !CheckI64(INT64_MAX) || !CheckI64(-1) || !CheckI64(0)) return(1);
+
+    for(i = 0; i < cRandom; i++)
+    {
+        uint64_t val = Random64();
+
+        if(!CheckU64(val) || !CheckI64((int64_t) val)) return(1);
+    }
+    printf("%u values, seed %u: OSMath decimal formatting matches the division loop and printf\n", cChecked, seed);
+
+    for(j = 0; j < sizeof(rgBench) / sizeof(rgBench[0]); j++)
+    {
+        double nsOld, nsNew;
+
+        tStart = clock();
+        for(i = 0; i < cBench; i++) cchSink += (uint32_t) (OldUlltoa(rgBench[j] - (i & 7), sz, 10)[0]);
+        nsOld = NsPerValue(tStart, cBench);
+
+        tStart = clock();
+        for(i = 0; i < cBench; i++) cchSink += OSU64ToDec(rgBench[j] - (i & 7), sz);
+        nsNew = NsPerValue(tStart, cBench);
+
+        printf("%-16s %20" PRIu64 ": OldUlltoa %6.1f ns, OSU64ToDec %6.1f ns\n", rgszBench[j], rgBench[j], nsOld, nsNew);
+    }
+
+    return(0);
+}
@@ -0,0 +1,87 @@
+/************************************************************************/
+/*                                                                      */
+/*    OpenScope.h                                                       */
+/*                                                                      */
+/*    Host stand in for OpenScope.h so OSMath.c builds with gcc         */
+/*    on a PC                                                           */
+/*                                                                      */
+/************************************************************************/
+/*    Author:     Keith Vogel                                           */
+/*    Copyright 2026, Digilent Inc.                                     */
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  Only the host programs in this directory include this. It has just  */
+/*  what OSMath.c uses; BIDX and the timer values are copied from       */
+/*  ProcessJSONCmd.h and OpenScope.h and must be kept the same.         */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*    10/19/2026 (KeithV): Created                                      */
+/************************************************************************/
+#ifndef OpenScope_h
+#define OpenScope_h
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#define ASSERT(f)               assert(f)
+
+#define TMRPBCLK                100000000               // PB CLK, ticks per second
+#define MAXTMRPRX               0x10000
+#define TMRMINSPS               6   // 100,000,000 / 256 / 65536 ~=> 5.960464 Hz
+
+typedef struct _BIDX
+{
+    uint64_t        xsps;
+    int64_t         psDelay;
+    int32_t         cBuff;
+
+    uint16_t        tmrPreScalar;
+    uint32_t        tmrPeriod;
+    uint32_t        tmrCnt;
+    bool            fInterleave;
+
+    union
+    {
+        struct
+        {
+            int64_t             dlTrig2POI;
+            int32_t             iPOI;
+            int32_t             iTrg;
+            int32_t             iTrigDMA;
+            volatile int32_t    iDMATrig;
+            int32_t             cBeforeTrig;
+            int64_t             cDelayTmr;
+        };
+
+        struct
+        {
+            int64_t             cTotalSamples;
+            int32_t             iDMAEnd;
+            int32_t             iDMAStart;
+            volatile int32_t    cDMARoll;
+            int32_t             cSavedRoll;
+            int32_t             cBackLog;
+            int64_t             spare;
+        };
+    };
+
+    uint32_t const  pbClkSampTmr;
+    uint64_t const  mHzInterleave;
+    int32_t  const  cDMA;
+    int32_t  const  cDMABuff;
+    int32_t  const  cDMASlop;
+} BIDX;
+
+extern uint32_t OSU32ToDec(uint32_t val, char * buf);
+extern uint32_t OSU64ToDec(uint64_t val, char * buf);
+extern uint32_t OSI64ToDec(int64_t val, char * buf);
+extern char * ulltoa(uint64_t val, char * buf, uint32_t base);
+extern char * illtoa(int64_t val, char * buf, uint32_t base);
+
+#endif // OpenScope_h
@@ -0,0 +1,408 @@
+/************************************************************************/
+/*                                                                      */
+/*    STRU32Test.c                                                      */
+/*                                                                      */
+/*    Checks the OSPAR::Uint32FromStr lookup against the strlen         */
+/*    lookup it replaced, over every STRU32 keyword in the parser       */
+/*                                                                      */
+/************************************************************************/
+/*    Author:     Keith Vogel                                           */
+/*    Copyright 2026, Digilent Inc.                                     */
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  Reads every "static const OSPAR::STRU32" table out of               */
+/*  ParseOpenScope.cpp, so a keyword added there is tested without      */
+/*  touching this file. Each table is built the way the STRU32          */
+/*  constructor builds it, with the length of the literal, and every    */
+/*  entry returns its own index so a wrong match shows.                 */
+/*                                                                      */
+/*  Every table is then asked for:                                      */
+/*      every keyword of every table                                    */
+/*      each keyword cut short, run on, and with its case flipped       */
+/*      each keyword behind a space, a + and a -, and ahead of a space  */
+/*      each keyword inside a longer buffer, as the lexer hands it over */
+/*      the empty string                                                */
+/*      numbers: leading zeros, signs, spaces, past 2^32, non digits    */
+/*      random strings over the keyword characters                      */
+/*  and OldUint32FromStr and NewUint32FromStr must agree every time.    */
+/*  NewUint32FromStr is a copy, the parser does not build on a PC; the  */
+/*  test fails if its compare no longer matches ParseOpenScope.cpp.     */
+/*                                                                      */
+/*  Exits 0 if they always agree, 1 on the first difference. Build and  */
+/*  run from this directory with:                                       */
+/*                                                                      */
+/*    gcc -O2 -o STRU32Test STRU32Test.c                                */
+/*    ./STRU32Test ../ParseOpenScope.cpp                                */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*    10/19/2026 (KeithV): Created                                      */
+/************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+
+#define cTablesMax      128
+#define cEntriesMax     64
+#define cbTokenMax      64
+#define cRandom         200000
+#define STRU32MISS      0xFFFFFFFF      // the defaultState we pass in
+
+// the same layout as OSPAR::STRU32
+typedef struct _STRU32
+{
+    char const *    szToken;
+    uint32_t        cbToken;
+    uint32_t        u32;
+} STRU32;
+
+typedef struct _TABLE
+{
+    char            szName[cbTokenMax];
+    uint32_t        cEntries;
+    STRU32          rgEntries[cEntriesMax];
+    char            rgszTokens[cEntriesMax][cbTokenMax];
+} TABLE;
+
+static TABLE    rgTables[cTablesMax];
+static uint32_t cTables = 0;
+static uint32_t cKeywords = 0;
+static uint64_t cLookups = 0;
+
+/************************************************************************/
+/*    The two lookups                                                   */
+/************************************************************************/
+
+// OSPAR::Uint32FromStr before STRU32 carried the length
+static uint32_t OldUint32FromStr(STRU32 const * const rgStrU32L, uint32_t cStrU32L, char const * const sz, uint32_t cb, uint32_t defaultState)
+{
+    uint32_t i = 0;
+
+    for(i = 0; i < cStrU32L; i++)
+    {
+        if((strlen(rgStrU32L[i].szToken) == cb) && memcmp(sz, rgStrU32L[i].szToken, cb) == 0)
+        {
+            return(rgStrU32L[i].u32);
+        }
+    }
+
+    return(defaultState);
+}
+
+// OSPAR::Uint32FromStr as it is now; ReadTables checks its test is still the one in ParseOpenScope.cpp
+static char const szNewTest[] = "if(rgStrU32L[i].cbToken == cb && rgStrU32L[i].szToken[0] == sz[0] && memcmp(sz, rgStrU32L[i].szToken, cb) == 0)";
+
+static uint32_t NewUint32FromStr(STRU32 const * const rgStrU32L, uint32_t cStrU32L, char const * const sz, uint32_t cb, uint32_t defaultState)
+{
+    uint32_t i = 0;
+
+    // the length and first char reject almost every entry without touching memcmp
+    for(i = 0; i < cStrU32L; i++)
+    {
+        if(rgStrU32L[i].cbToken == cb && rgStrU32L[i].szToken[0] == sz[0] && memcmp(sz, rgStrU32L[i].szToken, cb) == 0)
+        {
+            return(rgStrU32L[i].u32);
+        }
+    }
+
+    return(defaultState);
+}
+
+/************************************************************************/
+/*    Reading the tables out of ParseOpenScope.cpp                      */
+/************************************************************************/
+
+static char const * SkipSpace(char const * pch)
+{
+    for(;;)
+    {
+        while(isspace((unsigned char) *pch)) pch++;
+
+        if(pch[0] == '/' && pch[1] == '/')
+        {
+            while(*pch != '\0' && *pch != '\n') pch++;
+        }
+        else if(pch[0] == '/' && pch[1] == '*')
+        {
+            char const * pchEnd = strstr(pch + 2, "*/");
+            pch = (pchEnd == NULL) ? pch + strlen(pch) : pchEnd + 2;
+        }
+        else
+        {
+            return(pch);
+        }
+    }
+}
+
+// pch is just past "OSPAR::STRU32 "; returns where to look for the next table, NULL on a parse error
+static char const * ReadTable(char const * pch)
+{
+    TABLE *         pTable  = &rgTables[cTables];
+    uint32_t        cch     = 0;
+
+    if(cTables == cTablesMax)
+    {
+        printf("More than %u STRU32 tables\n", cTablesMax);
+        return(NULL);
+    }
+
+    pch = SkipSpace(pch);
+    while((isalnum((unsigned char) *pch) || *pch == '_') && cch < cbTokenMax - 1) pTable->szName[cch++] = *pch++;
+    pTable->szName[cch] = '\0';
+
+    pch = SkipSpace(pch);
+    if(strncmp(pch, "[]", 2) != 0) return(NULL);
+    pch = SkipSpace(pch + 2);
+    if(*pch != '=') return(NULL);
+    pch = SkipSpace(pch + 1);
+    if(*pch != '{') return(NULL);
+    pch++;
+
+    // {"token", value}, ... };
+    for(;;)
+    {
+        char const *    pchToken;
+        STRU32 *        pEntry  = &pTable->rgEntries[pTable->cEntries];
+        char *          szToken = pTable->rgszTokens[pTable->cEntries];
+
+        pch = SkipSpace(pch);
+        if(*pch == '}') break;
+        if(*pch == ',') { pch++; continue; }
+        if(*pch != '{') return(NULL);
+
+        pch = SkipSpace(pch + 1);
+        if(*pch != '"') return(NULL);
+        pchToken = ++pch;
+        while(*pch != '"' && *pch != '\0')
+        {
+            // no keyword has an escape; if one ever does its length needs real unescaping
+            if(*pch == '\\' || *pch == '\n') return(NULL);
+            pch++;
+        }
+        if(*pch != '"' || pch - pchToken >= cbTokenMax || pTable->cEntries == cEntriesMax) return(NULL);
+
+        memcpy(szToken, pchToken, pch - pchToken);
+        szToken[pch - pchToken] = '\0';
+
+        // as the constructor does it, sizeof the literal less the null
+        pEntry->szToken = szToken;
+        pEntry->cbToken = (uint32_t) (pch - pchToken);
+        pEntry->u32     = pTable->cEntries;
+        pTable->cEntries++;
+        cKeywords++;
+
+        // past the value to the closing brace
+        while(*pch != '}' && *pch != '\0') pch++;
+        if(*pch != '}') return(NULL);
+        pch++;
+    }
+
+    if(pTable->cEntries == 0) return(NULL);
+
+    cTables++;
+    return(pch);
+}
+
+static bool ReadTables(char const * szFile)
+{
+    FILE *          pFile   = fopen(szFile, "rb");
+    char *          pchFile;
+    char const *    pch;
+    long            cbFile;
+    bool            fOK     = true;
+
+    if(pFile == NULL)
+    {
+        printf("Unable to open %s\n", szFile);
+        return(false);
+    }
+
+    fseek(pFile, 0, SEEK_END);
+    cbFile = ftell(pFile);
+    fseek(pFile, 0, SEEK_SET);
+    pchFile = (char *) malloc(cbFile + 1);
+    if(pchFile == NULL || fread(pchFile, 1, cbFile, pFile) != (size_t) cbFile)
+    {
+        printf("Unable to read %s\n", szFile);
+        fclose(pFile);
+        free(pchFile);
+        return(false);
+    }
+    pchFile[cbFile] = '\0';
+    fclose(pFile);
+
+    // the lookup here must be the one the parser runs
+    if((pch = strstr(pchFile, "uint32_t OSPAR::Uint32FromStr(")) == NULL || (pch = strstr(pch, "if(")) == NULL || strncmp(pch, szNewTest, strlen(szNewTest)) != 0)
+    {
+        printf("OSPAR::Uint32FromStr in %s is not the lookup NewUint32FromStr tests, update this test\n", szFile);
+        free(pchFile);
+        return(false);
+    }
+
+    pch = pchFile;
+    while((pch = strstr(pch, "static const OSPAR::STRU32 ")) != NULL)
+    {
+        char const * pchTable = pch;
+
+        if((pch = ReadTable(pch + strlen("static const OSPAR::STRU32 "))) == NULL)
+        {
+            int iLine = 1;
+
+            for(pch = pchFile; pch < pchTable; pch++) if(*pch == '\n') iLine++;
+            printf("%s(%d): unable to read the STRU32 table\n", szFile, iLine);
+            fOK = false;
+            break;
+        }
+    }
+
+    free(pchFile);
+
+    if(fOK && cTables == 0)
+    {
+        printf("No STRU32 tables in %s\n", szFile);
+        fOK = false;
+    }
+
+    return(fOK);
+}
+
+/************************************************************************/
+/*    Checking                                                          */
+/************************************************************************/
+
+// sz need not be null terminated, only cb bytes are the token
+static bool Check(char const * sz, uint32_t cb, char const * szWhy)
+{
+    uint32_t i;
+
+    for(i = 0; i < cTables; i++)
+    {
+        uint32_t uOld = OldUint32FromStr(rgTables[i].rgEntries, rgTables[i].cEntries, sz, cb, STRU32MISS);
+        uint32_t uNew = NewUint32FromStr(rgTables[i].rgEntries, rgTables[i].cEntries, sz, cb, STRU32MISS);
+
+        cLookups++;
+        if(uOld != uNew)
+        {
+            printf("%s: \"%.*s\" (%u bytes) in %s: old gave %d, new gave %d\n", szWhy, (int) cb, sz, cb, rgTables[i].szName, (int) uOld, (int) uNew);
+            return(false);
+        }
+    }
+
+    return(true);
+}
+
+static bool CheckSz(char const * sz, char const * szWhy)
+{
+    return(Check(sz, (uint32_t) strlen(sz), szWhy));
+}
+
+static bool CheckKeyword(char const * szKey, uint32_t cbKey)
+{
+    char        sz[cbTokenMax + 8];
+    char        rgchEdit[] = {' ', '+', '-', 'x', '0'};
+    uint32_t    i;
+
+    // itself, and as the lexer hands it over: in the middle of the JSON text, not null terminated
+    if(!Check(szKey, cbKey, "keyword")) return(false);
+    snprintf(sz, sizeof(sz), "%s\",", szKey);
+    if(!Check(sz, cbKey, "keyword followed by more text")) return(false);
+
+    // cut short and run on
+    if(!Check(szKey, cbKey - 1, "keyword cut short")) return(false);
+    if(cbKey > 1 && !Check(szKey + 1, cbKey - 1, "keyword less its first char")) return(false);
+
+    for(i = 0; i < sizeof(rgchEdit); i++)
+    {
+        snprintf(sz, sizeof(sz), "%c%s", rgchEdit[i], szKey);
+        if(!CheckSz(sz, "char ahead of a keyword")) return(false);
+        snprintf(sz, sizeof(sz), "%s%c", szKey, rgchEdit[i]);
+        if(!CheckSz(sz, "char after a keyword")) return(false);
+    }
+
+    // case flipped, first and last
+    strcpy(sz, szKey);
+    sz[0] = islower((unsigned char) sz[0]) ? toupper((unsigned char) sz[0]) : tolower((unsigned char) sz[0]);
+    if(!CheckSz(sz, "keyword with the first char's case flipped")) return(false);
+    strcpy(sz, szKey);
+    sz[cbKey - 1] = islower((unsigned char) sz[cbKey - 1]) ? toupper((unsigned char) sz[cbKey - 1]) : tolower((unsigned char) sz[cbKey - 1]);
+    if(!CheckSz(sz, "keyword with the last char's case flipped")) return(false);
+
+    return(true);
+}
+
+int main(int argc, char * argv[])
+{
+    char const *    szFile      = (argc > 1) ? argv[1] : "../ParseOpenScope.cpp";
+    unsigned int    seed        = (argc > 2) ? strtoul(argv[2], NULL, 0) : 1;
+    char const *    rgszOdd[]   = {"", " ", "\"", "0", "00", "01", "010", "+1", "-1", "+0", "-0", " 1", "1 ", "\t1",
+                                   "11", "99", "4294967295", "4294967296", "18446744073709551616", "99999999999999999999",
+                                   "1a", "a1", "1.0", ".1", "1e3", "0x1", "one", "true", "false", "null", "[]", "{}"};
+    char            rgchAlpha[128];
+    uint32_t        cchAlpha    = 0;
+    uint32_t        i, j;
+
+    if(!ReadTables(szFile)) return(1);
+
+    // every keyword of every table, in every table
+    for(i = 0; i < cTables; i++)
+    {
+        for(j = 0; j < rgTables[i].cEntries; j++)
+        {
+            if(!CheckKeyword(rgTables[i].rgEntries[j].szToken, rgTables[i].rgEntries[j].cbToken)) return(1);
+        }
+    }
+
+    // the empty token; the new lookup must not care what is at sz when cb is 0
+    if(!Check("", 0, "empty string") || !Check("run", 0, "empty token in front of text")) return(1);
+
+    for(i = 0; i < sizeof(rgszOdd) / sizeof(rgszOdd[0]); i++)
+    {
+        if(!CheckSz(rgszOdd[i], "number or odd token")) return(1);
+    }
+
+    // random strings over the characters the keywords use, so near misses are common
+    for(i = 0; i < cTables; i++)
+    {
+        for(j = 0; j < rgTables[i].cEntries; j++)
+        {
+            char const * pch;
+
+            for(pch = rgTables[i].rgEntries[j].szToken; *pch != '\0'; pch++)
+            {
+                if(memchr(rgchAlpha, *pch, cchAlpha) == NULL && cchAlpha < sizeof(rgchAlpha)) rgchAlpha[cchAlpha++] = *pch;
+            }
+        }
+    }
+
+    srand(seed);
+    for(i = 0; i < cRandom; i++)
+    {
+        char        sz[cbTokenMax];
+        uint32_t    cb = rand() % 8;
+
+        // mostly a keyword with a char changed, otherwise short random strings
+        if(rand() % 2)
+        {
+            TABLE const *   pTable  = &rgTables[rand() % cTables];
+            STRU32 const *  pEntry  = &pTable->rgEntries[rand() % pTable->cEntries];
+
+            cb = pEntry->cbToken;
+            memcpy(sz, pEntry->szToken, cb);
+            sz[rand() % cb] = rgchAlpha[rand() % cchAlpha];
+        }
+        else
+        {
+            for(j = 0; j < cb; j++) sz[j] = rgchAlpha[rand() % cchAlpha];
+        }
+
+        if(!Check(sz, cb, "random string")) return(1);
+    }
+
+    printf("%u tables, %u keywords, %llu lookups, seed %u: Uint32FromStr matches the strlen lookup\n", cTables, cKeywords, (unsigned long long) cLookups, seed);
+    return(0);
+}
@@ -165,7 +165,16 @@ public:
     size_t writeStream(const uint8_t *rgbWrite, size_t cbWrite);                            
     size_t writeStream(const uint8_t *rgbWrite, size_t cbWrite, IPSTATUS * pStatus);
 
+    // rgbWrite is sent as is, it must not change until externalUnacked() is 0
+    size_t writeStreamExternal(const uint8_t *rgbWrite, size_t cbWrite, IPSTATUS * pStatus);
+    size_t externalUnacked(void) {return(TCPExternalUnacked(&_socket));}
+
     void flush(void) {TCPFlush(&_socket);}
+
+    // send options, see TCPSetNoDelay, TCPSetDelayedAck and TCPSetSendWindow
+    void setNoDelay(bool fNoDelay) {TCPSetNoDelay(&_socket, fNoDelay);}
+    void setDelayedAck(uint32_t msDelay) {TCPSetDelayedAck(&_socket, msDelay);}
+    void setSendWindow(uint32_t cSegments) {TCPSetSendWindow(&_socket, cSegments);}
  
     bool getRemoteEndPoint(IPEndPoint& epRemote);
     bool getLocalEndPoint(IPEndPoint& epLocal);
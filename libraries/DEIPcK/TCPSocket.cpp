@@ -46,6 +46,7 @@
 /*  Revision History:                                                   */
 /*                                                                      */
 /*      11/20/2011(KeithV): Created                                     */
+/*      10/19/2026(KeithV): writeStreamExternal                         */
 /*                                                                      */
 /************************************************************************/
 #include "DEIPcK.h"
@@ -430,6 +431,42 @@ size_t TCPSocket::writeStream(const uint8_t *rgbWrite, size_t cbWrite, IPSTATUS
     return(0);
 }
 
+/***	size_t TCPSocket::writeStreamExternal(const uint8_t *rgbWrite, size_t cbWrite, IPSTATUS * pStatus)
+**
+**	Synopsis:   
+**      Sends an array of bytes without copying it into the socket buffer
+**
+**	Parameters:
+**      rgbWrite    A pointer to an array of bytes to write out; it is sent straight out of this memory
+**
+**      cbWrite     The number of bytes to write out.
+**
+**      pStatus     A pointer to receive the status of the call, usually the connection status.
+**
+**	Return Values:
+**      cbWrite if the array was queued, 0 if a previous external write is not ACKed yet or on error.
+**
+**	Errors:
+**      connection status
+**
+**  Notes:
+**
+**      The array must not be changed until externalUnacked() returns 0.
+**      Closing the socket before then aborts the connection.
+**
+*/
+size_t TCPSocket::writeStreamExternal(const uint8_t *rgbWrite, size_t cbWrite, IPSTATUS * pStatus)
+{
+    // make sure we are Connected
+    // this will also run the stack
+    if(TCPIsEstablished(&_socket, pStatus))
+    {
+        return(TCPWriteExternal(&_socket, rgbWrite, cbWrite, pStatus));
+    }
+
+    return(0);
+}
+
 /***	bool TCPSocket::getRemoteMAC(MAC *pRemoteMAC)
 **
 **	Synopsis:   
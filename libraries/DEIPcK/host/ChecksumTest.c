@@ -0,0 +1,216 @@
+/************************************************************************/
+/*                                                                      */
+/*	ChecksumTest.c  Checks CalculateChecksum and CopyAndSum against     */
+/*                  the byte pair sum they replaced, and times them     */
+/*                                                                      */
+/************************************************************************/
+/*  Author:     Keith Vogel                                             */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/* deIP core network library
+*
+* Copyright (c) 2013-2014, Digilent <www.digilentinc.com>
+* Contact Digilent for the latest version.
+*
+* This program is free software; distributed under the terms of
+* BSD 3-clause license ("Revised BSD License", "New BSD License", or "Modified BSD License")
+*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* 1.    Redistributions of source code must retain the above copyright notice, this
+*        list of conditions and the following disclaimer.
+* 2.    Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+* 3.    Neither the name(s) of the above-listed copyright holder(s) nor the names
+*        of its contributors may be used to endorse or promote products derived
+*        from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+* IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+* OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+* OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  Links the real System.c and runs random buffers, at every start     */
+/*  alignment, lengths from 0 to an IP datagram, and all zero and all   */
+/*  0xFF runs for the carries, thru CalculateChecksum and CopyAndSum.   */
+/*  Each result must match OldChecksum, the byte pair loop that         */
+/*  System.c had before, and CopyAndSum must copy exactly cb bytes.     */
+/*  Then it times each of the three over a 32K OSC buffer.              */
+/*                                                                      */
+/*  Exits 0 if everything matched, 1 on the first mismatch; a seed can  */
+/*  be given on the command line. Build from this directory with:       */
+/*                                                                      */
+/*  gcc -O2 -fno-tree-vectorize -DMPIDE -I. -I../utility                */
+/*      -o ChecksumTest ChecksumTest.c ../utility/System.c              */
+/*                                                                      */
+/*  The PIC32 has no SIMD; without -fno-tree-vectorize gcc vectorizes   */
+/*  the old loop on a PC and the times say nothing about the board.     */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*	10/19/2026(KeithV): Created                                         */
+/*                                                                      */
+/************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "deIP.h"
+
+#define cTrials         200000
+#define cbMaxTrial      65535               // the largest IP datagram
+#define cbBench         32768               // an OSC buffer
+#define cBench          20000
+#define cbGuard         64
+
+static uint8_t rgbSrc[cbGuard + cbMaxTrial + cbGuard];
+static uint8_t rgbDest[cbGuard + cbMaxTrial + cbGuard];
+
+// System.c reads the core timer, nothing here needs it
+uint32_t LoopGetTick(void)
+{
+    return(0);
+}
+
+/*********************************************************************
+ *  This is CalculateChecksum as it was before it summed aligned words,
+ *  one unaligned 16 bit load at a time; it is the reference.
+ ********************************************************************/
+static inline uint16_t __attribute__((always_inline)) unalignedload(volatile void *ptr)
+ {
+    struct unaligned {
+      uint16_t u16;
+    } __attribute__ ((packed)) *ip;
+    ip = (struct unaligned *)ptr;
+
+    return ip->u16;
+ }
+
+static uint16_t OldChecksum(uint16_t sumComplement, void * pv, unsigned int cb)
+{
+    uint8_t *       pbEnd   = ((uint8_t *) pv) + cb;
+    uint32_t        sum     = ((uint32_t) (~sumComplement)) & 0x0000FFFF;
+
+    if(cb > 0)
+    {
+        for(; pv < (void *) (pbEnd-1); pv = ((uint8_t *) pv) + sizeof(uint16_t)) sum += unalignedload(pv);
+
+        // see if we need to pad a zero at the end of the last odd byte; RFC 1071
+        if(pv < (void *) pbEnd) sum += (((uint16_t) (*(pbEnd - 1))) & 0x00FF);
+
+        // add the carry until all carries are added
+        while((sum & 0xFFFF0000) != 0) sum = (sum & 0x0000FFFF) + (sum >> 16);
+    }
+
+    // return the ones complement
+    return((uint16_t) ((~sum) & 0x0000FFFF));
+}
+
+// what a CopyAndSum sum gives when it is added to a running checksum
+static uint16_t AddSum(uint16_t sumComplement, uint16_t sum)
+{
+    uint32_t sumT = (((uint32_t) (~sumComplement)) & 0x0000FFFF) + sum;
+
+    sumT = (sumT & 0x0000FFFF) + (sumT >> 16);
+    return((uint16_t) ((~sumT) & 0x0000FFFF));
+}
+
+static void FillRandom(uint8_t * pb, unsigned int cb)
+{
+    unsigned int i;
+
+    for(i = 0; i < cb; i++) pb[i] = (uint8_t) rand();
+}
+
+static double MBPerSec(clock_t tStart, unsigned int cb, unsigned int cRuns)
+{
+    double sec = (double) (clock() - tStart) / CLOCKS_PER_SEC;
+
+    return(sec > 0 ? ((double) cb * cRuns) / sec / 1000000.0 : 0.0);
+}
+
+int main(int argc, char * argv[])
+{
+    unsigned int    seed    = (argc > 1) ? strtoul(argv[1], NULL, 0) : 1;
+    unsigned int    t;
+    clock_t         tStart;
+    volatile uint16_t sumSink = 0;
+
+    srand(seed);
+    FillRandom(rgbSrc, sizeof(rgbSrc));
+
+    for(t = 0; t < cTrials; t++)
+    {
+        unsigned int    offSrc  = cbGuard - 8 + (rand() % 16);
+        unsigned int    offDest = cbGuard - 8 + (rand() % 16);
+        unsigned int    cb      = (t % 10 == 0) ? (unsigned int) (rand() % (cbMaxTrial + 1)) : (unsigned int) (rand() % 200);
+        uint16_t        sumComp = (t % 3 == 0) ? 0 : (t % 3 == 1) ? 0xFFFF : (uint16_t) rand();
+        uint16_t        ckOld, ckNew, ckCopy, sumCopy;
+
+        // runs of 0x00 and 0xFF, the sums where a missed carry or end around shows
+        if(t % 50 == 0) memset(&rgbSrc[offSrc], (t % 100 == 0) ? 0x00 : 0xFF, cb);
+
+        ckOld = OldChecksum(sumComp, &rgbSrc[offSrc], cb);
+        ckNew = CalculateChecksum(sumComp, &rgbSrc[offSrc], cb);
+        if(ckNew != ckOld)
+        {
+            printf("CalculateChecksum mismatch: trial %u, seed %u, offset %u, cb %u, sum 0x%04X; got 0x%04X, expected 0x%04X\n", t, seed, offSrc, cb, sumComp, ckNew, ckOld);
+            return(1);
+        }
+
+        memset(&rgbDest[offDest - 1], 0xA5, cb + 2);
+        sumCopy = CopyAndSum(&rgbDest[offDest], &rgbSrc[offSrc], cb);
+        ckCopy  = AddSum(sumComp, sumCopy);
+        if(ckCopy != ckOld)
+        {
+            printf("CopyAndSum mismatch: trial %u, seed %u, offsets %u to %u, cb %u, sum 0x%04X; got 0x%04X, expected 0x%04X\n", t, seed, offSrc, offDest, cb, sumComp, ckCopy, ckOld);
+            return(1);
+        }
+
+        if(memcmp(&rgbDest[offDest], &rgbSrc[offSrc], cb) != 0)
+        {
+            printf("CopyAndSum copy is wrong: trial %u, seed %u, offsets %u to %u, cb %u\n", t, seed, offSrc, offDest, cb);
+            return(1);
+        }
+
+        if(rgbDest[offDest - 1] != 0xA5 || rgbDest[offDest + cb] != 0xA5)
+        {
+            printf("CopyAndSum wrote outside the buffer: trial %u, seed %u, offsets %u to %u, cb %u\n", t, seed, offSrc, offDest, cb);
+            return(1);
+        }
+
+        if(t % 50 == 0) FillRandom(&rgbSrc[offSrc], cb);
+    }
+    printf("%u trials, seed %u: CalculateChecksum and CopyAndSum match the byte pair sum\n", cTrials, seed);
+
+    // odd source, as a TCP payload behind a 20 byte header in a page often is
+    tStart = clock();
+    for(t = 0; t < cBench; t++) sumSink += OldChecksum(0, &rgbSrc[cbGuard + 1], cbBench);
+    printf("OldChecksum:        %7.1f MB/s\n", MBPerSec(tStart, cbBench, cBench));
+
+    tStart = clock();
+    for(t = 0; t < cBench; t++) sumSink += CalculateChecksum(0, &rgbSrc[cbGuard + 1], cbBench);
+    printf("CalculateChecksum:  %7.1f MB/s\n", MBPerSec(tStart, cbBench, cBench));
+
+    tStart = clock();
+    for(t = 0; t < cBench; t++) { memcpy(&rgbDest[cbGuard], &rgbSrc[cbGuard + 1], cbBench); sumSink += OldChecksum(0, &rgbDest[cbGuard], cbBench); }
+    printf("memcpy+OldChecksum: %7.1f MB/s\n", MBPerSec(tStart, cbBench, cBench));
+
+    tStart = clock();
+    for(t = 0; t < cBench; t++) sumSink += CopyAndSum(&rgbDest[cbGuard], &rgbSrc[cbGuard + 1], cbBench);
+    printf("CopyAndSum:         %7.1f MB/s\n", MBPerSec(tStart, cbBench, cBench));
+
+    return(0);
+}
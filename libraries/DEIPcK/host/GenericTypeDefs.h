@@ -0,0 +1,31 @@
+/************************************************************************/
+/*                                                                      */
+/*	GenericTypeDefs.h   Host stand in for the Microchip type header     */
+/*                                                                      */
+/************************************************************************/
+/*  Author:     Keith Vogel                                             */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  The deIP stack only uses the stdint and stdbool types, so on the    */
+/*  host this just has to be found.                                     */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*	10/19/2026(KeithV): Created                                         */
+/*                                                                      */
+/************************************************************************/
+#ifndef _HOST_GENERICTYPEDEFS_H_
+#define _HOST_GENERICTYPEDEFS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef TRUE
+#define TRUE    true
+#define FALSE   false
+#endif
+
+#endif // _HOST_GENERICTYPEDEFS_H_
@@ -0,0 +1,332 @@
+/************************************************************************/
+/*                                                                      */
+/*	LoopAdaptor.c   A host network adaptor that wires two deIP          */
+/*                  adaptors back to back through memory                */
+/*                                                                      */
+/************************************************************************/
+/*  Author:     Keith Vogel                                             */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/* deIP core network library
+*
+* Copyright (c) 2013-2014, Digilent <www.digilentinc.com>
+* Contact Digilent for the latest version.
+*
+* This program is free software; distributed under the terms of
+* BSD 3-clause license ("Revised BSD License", "New BSD License", or "Modified BSD License")
+*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* 1.    Redistributions of source code must retain the above copyright notice, this
+*        list of conditions and the following disclaimer.
+* 2.    Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+* 3.    Neither the name(s) of the above-listed copyright holder(s) nor the names
+*        of its contributors may be used to endorse or promote products derived
+*        from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+* IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+* OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+* OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  Send queues the IPSTACK like the MRF24 adaptor does; the periodic   */
+/*  task copies it into a frame on the wire to the other adaptor and    */
+/*  releases it. Frames that have arrived are copied into an IPSTACK    */
+/*  out of the receiving adaptor's heap, as WF_ProcessRxPacket does,    */
+/*  and handed out by Read.                                             */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*	10/19/2026(KeithV): Created                                         */
+/*                                                                      */
+/************************************************************************/
+#include "deIP.h"
+#include "LoopAdaptor.h"
+
+static uint32_t usLoop = 0;
+static LOOPADPD rgLoop[cLoopAdaptors];
+
+/*********************************************************************
+ * Virtual time
+ *
+ * The core timer runs SYSTICKSPERUSEC ticks a usec and wraps like
+ * the real one; nothing moves it but LoopAdvance().
+ ********************************************************************/
+uint32_t LoopGetTick(void)
+{
+    return(usLoop * SYSTICKSPERUSEC);
+}
+
+uint32_t LoopGetMicroSecond(void)
+{
+    return(usLoop);
+}
+
+void LoopAdvance(uint32_t us)
+{
+    usLoop += us;
+}
+
+/*********************************************************************
+ * The wire
+ ********************************************************************/
+static bool LoopDropFrame(LOOPLINK * pLink)
+{
+    if(pLink->lossPerMil == 0)
+    {
+        return(false);
+    }
+
+    // a plain LCG, so the same seed drops the same frames
+    pLink->seed = pLink->seed * 1103515245ul + 12345ul;
+    return(((pLink->seed >> 16) % 1000) < pLink->lossPerMil);
+}
+
+static void LoopPutOnWire(LOOPADPD * pLoopTo, IPSTACK * pIpStack)
+{
+    uint16_t    cbTotal = pIpStack->cbFrame + pIpStack->cbIPHeader + pIpStack->cbTranportHeader + pIpStack->cbPayload;
+    LOOPADPP *  pPriv   = &pLoopTo->priv;
+    LOOPPKT *   pPkt    = NULL;
+    uint32_t    usSer   = 0;
+    uint8_t *   pb;
+
+    pPriv->stats.cFrames++;
+    pPriv->stats.cbFrames += cbTotal;
+
+    // the link takes its time with it even if it loses it
+    if(pPriv->link.bitsPerSec > 0)
+    {
+        usSer = (uint32_t) ((((uint64_t) cbTotal) * 8 * 1000000ull + pPriv->link.bitsPerSec - 1) / pPriv->link.bitsPerSec);
+    }
+    if((int32_t) (pPriv->usWireFree - usLoop) < 0)
+    {
+        pPriv->usWireFree = usLoop;
+    }
+    pPriv->usWireFree += usSer;
+
+    if(LoopDropFrame(&pPriv->link))
+    {
+        pPriv->stats.cDropped++;
+        return;
+    }
+
+    if((pPkt = malloc(sizeof(LOOPPKT) + cbTotal)) == NULL)
+    {
+        pPriv->stats.cDropped++;
+        return;
+    }
+
+    pPkt->usDeliver = pPriv->usWireFree + pPriv->link.usLatency;
+    pPkt->cb        = cbTotal;
+
+    // frame, IP header, transport header, payload; just as the MRF puts it in its Tx buffer
+    pb = pPkt->rgb;
+    memcpy(pb, pIpStack->pFrameII, pIpStack->cbFrame);
+    pb += pIpStack->cbFrame;
+
+    if(pIpStack->cbIPHeader > 0)
+    {
+        memcpy(pb, pIpStack->pIPHeader, pIpStack->cbIPHeader);
+        pb += pIpStack->cbIPHeader;
+    }
+
+    if(pIpStack->cbTranportHeader > 0)
+    {
+        memcpy(pb, pIpStack->pTransportHeader, pIpStack->cbTranportHeader);
+        pb += pIpStack->cbTranportHeader;
+    }
+
+    if(pIpStack->cbPayload > 0)
+    {
+        memcpy(pb, pIpStack->pPayload, pIpStack->cbPayload);
+    }
+
+    // one link, so frames arrive in the order they were sent
+    FFInPacket(&pPriv->ffptWire, pPkt);
+}
+
+static void LoopTakeOffWire(LOOPADPD * pLoop)
+{
+    LOOPADPP *  pPriv   = &pLoop->priv;
+    LOOPPKT *   pPkt;
+
+    while((pPkt = pPriv->ffptWire.pvFirst) != NULL && (int32_t) (usLoop - pPkt->usDeliver) >= 0)
+    {
+        IPSTACK * pIpStack;
+
+        FFOutPacket(&pPriv->ffptWire);
+
+        if((pIpStack = RRHPAlloc(pLoop->adpLoop.hAdpHeap, pPkt->cb + sizeof(IPSTACK))) != NULL)
+        {
+            memset(pIpStack, 0, sizeof(IPSTACK));
+
+            // fill in info about the frame data
+            pIpStack->fFrameIsParsed    = false;
+            pIpStack->fFreeIpStackToAdp = true;
+            pIpStack->headerOrder       = NETWORK_ORDER;
+            pIpStack->pPayload          = ((uint8_t *) pIpStack) + sizeof(IPSTACK);
+            pIpStack->cbPayload         = pPkt->cb;
+
+            memcpy(pIpStack->pPayload, pPkt->rgb, pPkt->cb);
+
+            pIpStack->fOwnedByAdp = true;
+            FFInPacket(&pPriv->ffptRead, pIpStack);
+        }
+
+        // the adaptor has no room, like the MRF just drop it
+        else
+        {
+            pPriv->stats.cNoHeap++;
+        }
+
+        free(pPkt);
+    }
+}
+
+static void LoopPeriodicTask(uint32_t iAdp)
+{
+    LOOPADPD *  pLoop   = &rgLoop[iAdp];
+    IPSTACK *   pIpStack;
+
+    // put what we were given on the wire to the other adaptor
+    while((pIpStack = FFOutPacket(&pLoop->priv.ffptWrite)) != NULL)
+    {
+        LoopPutOnWire(&rgLoop[iAdp ^ 1], pIpStack);
+
+        // we sent it, clean up
+        pIpStack->fOwnedByAdp = false;
+        IPSRelease(pIpStack);
+    }
+
+    // and pick up what has arrived
+    LoopTakeOffWire(pLoop);
+}
+
+/*********************************************************************
+ * The NWADP
+ ********************************************************************/
+static bool IsLinked(IPSTATUS * pStatus)
+{
+    AssignStatusSafely(pStatus, ipsSuccess);
+    return(true);
+}
+
+static bool Send(IPSTACK * pIpStack, IPSTATUS * pStatus)
+{
+    LOOPADPD * pLoop = (LOOPADPD *) pIpStack->pLLAdp->pNwAdp;
+
+    AssignStatusSafely(pStatus, ipsSuccess);
+    pIpStack->fOwnedByAdp = true;
+    FFInPacket(&pLoop->priv.ffptWrite, pIpStack);
+    return(true);
+}
+
+static IPSTACK * Read(uint32_t iAdp, IPSTATUS * pStatus)
+{
+    IPSTACK *   pIpStack = FFOutPacket(&rgLoop[iAdp].priv.ffptRead);
+
+    if(pIpStack != NULL)
+    {
+        pIpStack->fOwnedByAdp = false;
+    }
+
+    AssignStatusSafely(pStatus, ipsSuccess);
+    return(pIpStack);
+}
+
+static bool Close(void)
+{
+    return(true);
+}
+
+// the NWADP calls do not say which adaptor, so each gets its own
+static void LoopPeriodicTask0(void) { LoopPeriodicTask(0); }
+static void LoopPeriodicTask1(void) { LoopPeriodicTask(1); }
+static IPSTACK * Read0(IPSTATUS * pStatus) { return(Read(0, pStatus)); }
+static IPSTACK * Read1(IPSTATUS * pStatus) { return(Read(1, pStatus)); }
+
+static void (* const rgPeriodicTask[cLoopAdaptors])(void) = {LoopPeriodicTask0, LoopPeriodicTask1};
+static IPSTACK * (* const rgRead[cLoopAdaptors])(IPSTATUS * pStatus) = {Read0, Read1};
+
+const NWADP * GetLoopAdaptor(uint32_t iAdp, MACADDR *pUseThisMac, HRRHEAP hAdpHeap, const LOOPLINK * pLink, IPSTATUS * pStatus)
+{
+    LOOPADPD * pLoop;
+
+    if(iAdp >= cLoopAdaptors)
+    {
+        AssignStatusSafely(pStatus, ipsAdaptorMustBeSpecified);
+        return(NULL);
+    }
+    else if(hAdpHeap == NULL)
+    {
+        AssignStatusSafely(pStatus, ipsNoHeapGiven);
+        return(NULL);
+    }
+
+    pLoop = &rgLoop[iAdp];
+    memset(pLoop, 0, sizeof(LOOPADPD));
+
+    pLoop->adpLoop.version          = LOOP_NWA_VERSION;
+    pLoop->adpLoop.fIPv6            = false;
+    pLoop->adpLoop.cbRxMTU_R        = LOOP_NWA_MTU_RX;
+    pLoop->adpLoop.cbTxMTU_S        = LOOP_NWA_MIN_TX_MTU;
+    pLoop->adpLoop.hAdpHeap         = hAdpHeap;
+    pLoop->adpLoop.PeriodicTask     = rgPeriodicTask[iAdp];
+    pLoop->adpLoop.IsLinked         = IsLinked;
+    pLoop->adpLoop.IsReadyToSend    = IsLinked;
+    pLoop->adpLoop.Send             = Send;
+    pLoop->adpLoop.Read             = rgRead[iAdp];
+    pLoop->adpLoop.Close            = Close;
+
+    if(pLink != NULL)
+    {
+        memcpy(&pLoop->priv.link, pLink, sizeof(LOOPLINK));
+    }
+    pLoop->priv.usWireFree = usLoop;
+
+    // save away our MAC
+    if(pUseThisMac != NULL)
+    {
+        memcpy(&pLoop->adpLoop.mac, pUseThisMac, sizeof(MACADDR));
+    }
+    else
+    {
+        memcpy(&pLoop->adpLoop.mac, &MACNONE, sizeof(MACADDR));
+    }
+
+    AssignStatusSafely(pStatus, ipsSuccess);
+    return(&pLoop->adpLoop);
+}
+
+const LOOPSTATS * LoopGetStats(uint32_t iAdp)
+{
+    return((iAdp < cLoopAdaptors) ? &rgLoop[iAdp].priv.stats : NULL);
+}
+
+bool LoopIsWireIdle(void)
+{
+    uint32_t i;
+
+    for(i=0; i<cLoopAdaptors; i++)
+    {
+        if(rgLoop[i].priv.ffptWire.pvFirst != NULL || rgLoop[i].priv.ffptWrite.pvFirst != NULL || rgLoop[i].priv.ffptRead.pvFirst != NULL)
+        {
+            return(false);
+        }
+    }
+
+    return(true);
+}
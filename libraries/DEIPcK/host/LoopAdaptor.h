@@ -0,0 +1,115 @@
+/************************************************************************/
+/*                                                                      */
+/*	LoopAdaptor.h   A host network adaptor that wires two deIP          */
+/*                  adaptors back to back through memory                */
+/*                                                                      */
+/************************************************************************/
+/*  Author:     Keith Vogel                                             */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/* deIP core network library
+*
+* Copyright (c) 2013-2014, Digilent <www.digilentinc.com>
+* Contact Digilent for the latest version.
+*
+* This program is free software; distributed under the terms of
+* BSD 3-clause license ("Revised BSD License", "New BSD License", or "Modified BSD License")
+*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* 1.    Redistributions of source code must retain the above copyright notice, this
+*        list of conditions and the following disclaimer.
+* 2.    Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+* 3.    Neither the name(s) of the above-listed copyright holder(s) nor the names
+*        of its contributors may be used to endorse or promote products derived
+*        from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+* IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+* OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+* OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  Two loopback adaptors, 0 and 1, each a full NWADP. What one sends   */
+/*  arrives at the other after the link's serialization time and        */
+/*  latency; a seeded generator drops frames at the asked for rate, so  */
+/*  a run is repeatable. Time is virtual, the stack's core timer is     */
+/*  LoopGetTick() and only LoopAdvance() moves it.                      */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*	10/19/2026(KeithV): Created                                         */
+/*                                                                      */
+/************************************************************************/
+#ifndef _LOOP_ADAPTOR_H_
+#define _LOOP_ADAPTOR_H_
+
+#define LOOP_NWA_VERSION        0x01000101
+#define LOOP_NWA_MTU_RX         1500
+#define LOOP_NWA_MIN_TX_MTU     TCP_EMTU_S
+#define cLoopAdaptors           2
+
+// a frame on the wire
+typedef struct LOOPPKT_T
+{
+    struct LOOPPKT_T *  pNext;          // must be first, FFPT links thru it
+    uint32_t            usDeliver;      // virtual usec when it arrives
+    uint16_t            cb;
+    uint8_t             rgb[];
+} LOOPPKT;
+
+// the link into an adaptor
+typedef struct LOOPLINK_T
+{
+    uint32_t    usLatency;              // one way latency
+    uint32_t    bitsPerSec;             // 0 for no serialization time
+    uint32_t    lossPerMil;             // frames dropped per 1000
+    uint32_t    seed;                   // loss generator state
+} LOOPLINK;
+
+typedef struct LOOPSTATS_T
+{
+    uint32_t    cFrames;                // frames put on the wire to this adaptor
+    uint32_t    cDropped;               // frames the link dropped
+    uint32_t    cNoHeap;                // frames dropped because the heap was full
+    uint32_t    cbFrames;               // bytes put on the wire
+} LOOPSTATS;
+
+typedef struct LOOPADPP_T
+{
+    FFPT        ffptRead;               // IPSTACKs delivered, waiting for Read
+    FFPT        ffptWrite;              // IPSTACKs given to Send, not on the wire yet
+    FFPT        ffptWire;               // LOOPPKTs on their way to this adaptor, in arrival order
+    uint32_t    usWireFree;             // when the link into this adaptor is done with the last frame
+    LOOPLINK    link;                   // the link into this adaptor
+    LOOPSTATS   stats;
+} LOOPADPP;
+
+typedef struct LOOPADPD_T
+{
+    NWADP       adpLoop;                // must be first, the stack only sees this
+    LOOPADPP    priv;
+} LOOPADPD;
+
+const NWADP * GetLoopAdaptor(uint32_t iAdp, MACADDR *pUseThisMac, HRRHEAP hAdpHeap, const LOOPLINK * pLink, IPSTATUS * pStatus);
+const LOOPSTATS * LoopGetStats(uint32_t iAdp);
+bool LoopIsWireIdle(void);
+
+// virtual time
+uint32_t LoopGetTick(void);
+uint32_t LoopGetMicroSecond(void);
+void LoopAdvance(uint32_t us);
+
+#endif // _LOOP_ADAPTOR_H_
@@ -0,0 +1,335 @@
+/************************************************************************/
+/*                                                                      */
+/*	TCPBench.c      Bulk TCP send benchmark of the deIP stack on a      */
+/*                  host, over the loopback adaptor                     */
+/*                                                                      */
+/************************************************************************/
+/*  Author:     Keith Vogel                                             */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/* deIP core network library
+*
+* Copyright (c) 2013-2014, Digilent <www.digilentinc.com>
+* Contact Digilent for the latest version.
+*
+* This program is free software; distributed under the terms of
+* BSD 3-clause license ("Revised BSD License", "New BSD License", or "Modified BSD License")
+*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* 1.    Redistributions of source code must retain the above copyright notice, this
+*        list of conditions and the following disclaimer.
+* 2.    Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+* 3.    Neither the name(s) of the above-listed copyright holder(s) nor the names
+*        of its contributors may be used to endorse or promote products derived
+*        from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+* IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+* OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+* OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  Runs the real IPStack.c, TCP.c and TCPStateMachine.c between two    */
+/*  loopback adaptors in one process. A client on adaptor 0 sends a     */
+/*  known pattern to a server on adaptor 1, which checks every byte.    */
+/*                                                                      */
+/*  Throughput is in virtual time, so it only depends on the link and   */
+/*  the stack's protocol behaviour and is the same on every run. The    */
+/*  CPU cost is measured on the host around the stack calls: the        */
+/*  periodic tasks, which include the adaptor copies, TCPWrite and      */
+/*  TCPRead. It includes the stack polling while it waits on the link,  */
+/*  as the main loop does on the board; use -l 0 -r 0 for the cost of   */
+/*  the data path alone.                                                */
+/*                                                                      */
+/*  With the OpenScope's 64 byte pages the receive window is under one  */
+/*  segment, so only one segment is ever in flight; there are never     */
+/*  the duplicate ACKs for a fast retransmit and -w changes nothing.    */
+/*                                                                      */
+/*  Exits 0 if all of the data arrived intact, 1 if not, so it can be   */
+/*  run as a regression test. Build from this directory with:           */
+/*                                                                      */
+/*  gcc -O2 -DMPIDE -I. -I../utility -o TCPBench TCPBench.c             */
+/*      LoopAdaptor.c ../utility/\*.c                                   */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*	10/19/2026(KeithV): Created                                         */
+/*                                                                      */
+/************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "deIP.h"
+#include "LoopAdaptor.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HasCycleCounter()   true
+#define GetCycles()         __rdtsc()
+#else
+#define HasCycleCounter()   false
+#define GetCycles()         0ull
+#endif
+
+// the same sizes the OpenScope builds the stack with
+#define pfSocketBuffer      6               // 1<<6 == 64 byte pages
+#define cPagesSocketBuffer  192             // 12,288 bytes for sockets
+#define cbAdpHeap           8192            // space for the adaptor to use to pass data
+#define cARPEntries         4
+
+#define portBench           5001
+#define cbExtBuff           32768           // an OSC buffer
+#define usStall             120000000ul     // no data for this long, give up; the RTO backs off without a cap
+
+static uint8_t  rgbSocketPageMGR[cLoopAdaptors][RAMGetPMGRSize(cPagesSocketBuffer, pfSocketBuffer)];
+static uint8_t  rgbAdpHeap[cLoopAdaptors][cbAdpHeap];
+static uint8_t  rgbLLARPMem[cLoopAdaptors][LLGetIPv4ARPMemSize(cARPEntries)];
+static uint8_t  rgbWrite[cbExtBuff];
+static uint8_t  rgbRead[2048];
+static TCPSOCKET socketClient;
+static TCPSOCKET socketServer;
+
+// the pattern; the offset in its low bytes so a dropped or repeated segment shows
+static inline uint8_t PatternByte(uint32_t i)
+{
+    return((uint8_t) (i ^ (i >> 8) ^ (i >> 16) ^ (i >> 24)));
+}
+
+static void FillPattern(uint8_t * pb, uint32_t iStart, uint32_t cb)
+{
+    uint32_t i;
+
+    for(i=0; i<cb; i++)
+    {
+        pb[i] = PatternByte(iStart + i);
+    }
+}
+
+static void Usage(char const * szProg)
+{
+    printf("usage: %s [-n bytes] [-c chunk] [-l usec] [-r bits/s] [-p lost/1000] [-s seed]\n", szProg);
+    printf("          [-w segments] [-a ack msec] [-q usec] [-d] [-x]\n");
+    printf("  -n  bytes to send, default 4194304\n");
+    printf("  -c  bytes per TCPWrite, default 1024\n");
+    printf("  -l  one way link latency in usec, default 1000\n");
+    printf("  -r  link rate in bits a second, 0 for none; default 20000000\n");
+    printf("  -p  frames lost out of 1000, each way; default 0\n");
+    printf("  -s  loss seed, default 1\n");
+    printf("  -w  TCPSetSendWindow on the client, 0 to leave it alone; default 0\n");
+    printf("  -a  TCPSetDelayedAck on the server in msec, -1 to leave it alone; default -1\n");
+    printf("  -q  virtual usec a pass of the main loop takes, default 20\n");
+    printf("  -d  TCPSetNoDelay on the client\n");
+    printf("  -x  send with TCPWriteExternal, %u bytes at a time\n", cbExtBuff);
+}
+
+int main(int argc, char * argv[])
+{
+    uint32_t        cbTotal     = 4194304;
+    uint32_t        cbChunk     = 1024;
+    uint32_t        cSegWindow  = 0;
+    int32_t         msAck       = -1;
+    uint32_t        usQuantum   = 20;
+    bool            fNoDelay    = false;
+    bool            fExternal   = false;
+    LOOPLINK        link        = {1000, 20000000, 0, 1};
+    IPv4            rgIP[cLoopAdaptors] = {{.u8 = {192, 168, 10, 1}}, {.u8 = {192, 168, 10, 2}}};
+    IPv4            ipMask      = {.u8 = {255, 255, 255, 0}};
+    MACADDR         rgMac[cLoopAdaptors] = {{.u8 = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01}}, {.u8 = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02}}};
+    const LLADP *   rgLLAdp[cLoopAdaptors];
+    HPMGR           rghPMGR[cLoopAdaptors];
+    HSOCKET         hClient;
+    HSOCKET         hServer;
+    IPSTATUS        status      = ipsSuccess;
+    uint32_t        cbWritten   = 0;
+    uint32_t        cbRead      = 0;
+    uint32_t        cbExtQueued = 0;
+    uint32_t        usStart     = 0;
+    uint32_t        usLast      = 0;
+    uint64_t        cCycles     = 0;
+    uint64_t        nsCPU       = 0;
+    bool            fEstablished = false;
+    bool            fIntact     = true;
+    int             opt;
+    uint32_t        i;
+
+    while((opt = getopt(argc, argv, "n:c:l:r:p:s:w:a:q:dxh")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n': cbTotal           = strtoul(optarg, NULL, 0);             break;
+            case 'c': cbChunk           = strtoul(optarg, NULL, 0);             break;
+            case 'l': link.usLatency    = strtoul(optarg, NULL, 0);             break;
+            case 'r': link.bitsPerSec   = strtoul(optarg, NULL, 0);             break;
+            case 'p': link.lossPerMil   = strtoul(optarg, NULL, 0);             break;
+            case 's': link.seed         = strtoul(optarg, NULL, 0);             break;
+            case 'w': cSegWindow        = strtoul(optarg, NULL, 0);             break;
+            case 'a': msAck             = strtol(optarg, NULL, 0);              break;
+            case 'q': usQuantum         = strtoul(optarg, NULL, 0);             break;
+            case 'd': fNoDelay          = true;                                 break;
+            case 'x': fExternal         = true;                                 break;
+            default:  Usage(argv[0]);                                           return(2);
+        }
+    }
+
+    if(cbChunk == 0 || cbChunk > sizeof(rgbWrite) || usQuantum == 0 || link.lossPerMil >= 1000)
+    {
+        Usage(argv[0]);
+        return(2);
+    }
+
+    // bring up the stack with two adaptors wired to each other
+    IPSInit(NULL, 0, 0);
+    for(i=0; i<cLoopAdaptors; i++)
+    {
+        LOOPLINK    linkT   = link;
+        const NWADP * pNwAdp;
+
+        // each direction loses its own frames
+        linkT.seed = link.seed + i;
+
+        if( (pNwAdp = GetLoopAdaptor(i, &rgMac[i], RRHPInit(rgbAdpHeap[i], cbAdpHeap), &linkT, &status)) == NULL    ||
+            (rgLLAdp[i] = LLAddAdaptor(pNwAdp, rgbLLARPMem[i], sizeof(rgbLLARPMem[i]), &status)) == NULL           )
+        {
+            printf("Unable to bring up adaptor %u, status 0x%08X\n", i, status);
+            return(1);
+        }
+
+        // ARP goes thru the gateway for anything off the gateway's subnet, so give it one on ours
+        ILSetMyIP(rgLLAdp[i], &rgIP[i]);
+        ILSetMySubmask(rgLLAdp[i], &ipMask);
+        ILSetMyGateway(rgLLAdp[i], &rgIP[i ^ 1]);
+
+        // each end has its own socket memory, as the board and its peer would
+        rghPMGR[i] = RAMCreatePageMGR(rgbSocketPageMGR[i], sizeof(rgbSocketPageMGR[i]), cPagesSocketBuffer, pfSocketBuffer);
+    }
+
+    if((hServer = TCPOpenWithSocket(rgLLAdp[1], &socketServer, rghPMGR[1], &IPListen, portListen, portBench, &status)) == NULL)
+    {
+        printf("Unable to listen, status 0x%08X\n", status);
+        return(1);
+    }
+    if((hClient = TCPOpenWithSocket(rgLLAdp[0], &socketClient, rghPMGR[0], &rgIP[1], portBench, portDynamicallyAssign, &status)) == NULL)
+    {
+        printf("Unable to connect, status 0x%08X\n", status);
+        return(1);
+    }
+
+    if(cSegWindow > 0)  TCPSetSendWindow(hClient, cSegWindow);
+    if(msAck >= 0)      TCPSetDelayedAck(hServer, (uint32_t) msAck);
+    if(fNoDelay)        TCPSetNoDelay(hClient, true);
+
+    memset(&g_tcpTxStats, 0, sizeof(g_tcpTxStats));
+
+    while(cbRead < cbTotal)
+    {
+        struct timespec tsStart;
+        struct timespec tsEnd;
+        uint64_t        cyStart;
+        uint32_t        cbW     = 0;
+        uint32_t        cbR     = 0;
+        uint32_t        cbFill  = 0;
+
+        // what the client will write this pass, made before the clock starts
+        if(fEstablished && cbWritten < cbTotal)
+        {
+            if(fExternal)
+            {
+                if(cbExtQueued == 0 || TCPExternalUnacked(hClient) == 0)
+                {
+                    cbFill = min(cbTotal - cbWritten, sizeof(rgbWrite));
+                    FillPattern(rgbWrite, cbWritten, cbFill);
+                }
+            }
+            else
+            {
+                cbFill = min(cbTotal - cbWritten, cbChunk);
+                FillPattern(rgbWrite, cbWritten, cbFill);
+            }
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &tsStart);
+        cyStart = GetCycles();
+
+        if(cbFill > 0)
+        {
+            cbW = fExternal ? TCPWriteExternal(hClient, rgbWrite, cbFill, &status) : TCPWrite(hClient, rgbWrite, cbFill, &status);
+        }
+
+        IPSPeriodicTasks();
+        cbR = TCPRead(hServer, rgbRead, sizeof(rgbRead), &status);
+
+        cCycles += GetCycles() - cyStart;
+        clock_gettime(CLOCK_MONOTONIC, &tsEnd);
+        nsCPU += (uint64_t) ((tsEnd.tv_sec - tsStart.tv_sec) * 1000000000ll + (tsEnd.tv_nsec - tsStart.tv_nsec));
+
+        if(!fEstablished && TCPIsEstablished(hClient, NULL))
+        {
+            fEstablished    = true;
+            usStart         = LoopGetMicroSecond();
+            usLast          = usStart;
+        }
+
+        cbWritten   += cbW;
+        cbExtQueued += cbW;
+
+        // check what came in
+        for(i=0; i<cbR; i++)
+        {
+            if(rgbRead[i] != PatternByte(cbRead + i))
+            {
+                printf("Data mismatch at byte %u\n", cbRead + i);
+                fIntact = false;
+                break;
+            }
+        }
+        if(!fIntact)
+        {
+            break;
+        }
+        cbRead += cbR;
+
+        if(cbR > 0)
+        {
+            usLast = LoopGetMicroSecond();
+        }
+        else if(LoopGetMicroSecond() - usLast > usStall)
+        {
+            printf("No data for %lu usec, %u of %u bytes arrived\n", usStall, cbRead, cbTotal);
+            fIntact = false;
+            break;
+        }
+
+        LoopAdvance(usQuantum);
+    }
+
+    {
+        uint32_t            usRun       = usLast - usStart;
+        const LOOPSTATS *   pStats0     = LoopGetStats(0);
+        const LOOPSTATS *   pStats1     = LoopGetStats(1);
+
+        printf("link: %u usec latency, %u bits/s, %u/1000 lost, seed %u; %u usec passes\n", link.usLatency, link.bitsPerSec, link.lossPerMil, link.seed, usQuantum);
+        printf("sent: %u of %u bytes %s, %s\n", cbRead, cbTotal, fExternal ? "by TCPWriteExternal" : "by TCPWrite", fIntact ? "intact" : "FAILED");
+        printf("time: %u usec virtual, %.0f bytes/s\n", usRun, usRun == 0 ? 0.0 : ((double) cbRead) * 1000000.0 / usRun);
+        printf("cpu:  %.1f ns/byte", cbRead == 0 ? 0.0 : ((double) nsCPU) / cbRead);
+        if(HasCycleCounter()) printf(", %.1f cycles/byte", cbRead == 0 ? 0.0 : ((double) cCycles) / cbRead);
+        printf("\n");
+        printf("tcp:  %u segments, %u payload bytes, %u retransmit timeouts, %u fast retransmits\n", g_tcpTxStats.cSegments, g_tcpTxStats.cbPayload, g_tcpTxStats.cRetransmit, g_tcpTxStats.cFastRetransmit);
+        printf("wire: to 0 %u frames %u lost %u no heap; to 1 %u frames %u lost %u no heap\n", pStats0->cFrames, pStats0->cDropped, pStats0->cNoHeap, pStats1->cFrames, pStats1->cDropped, pStats1->cNoHeap);
+    }
+
+    return(fIntact ? 0 : 1);
+}
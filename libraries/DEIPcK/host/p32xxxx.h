@@ -0,0 +1,35 @@
+/************************************************************************/
+/*                                                                      */
+/*	p32xxxx.h       Host stand in for the PIC32 device header so the    */
+/*                  deIP stack builds with gcc on a PC                  */
+/*                                                                      */
+/************************************************************************/
+/*  Author:     Keith Vogel                                             */
+/*  Copyright 2026, Digilent Inc.                                       */
+/************************************************************************/
+/*  Module Description:                                                 */
+/*                                                                      */
+/*  Only the host programs in this directory include this; the core     */
+/*  timer is the loopback adaptor's virtual clock.                      */
+/*                                                                      */
+/************************************************************************/
+/*  Revision History:                                                   */
+/*                                                                      */
+/*	10/19/2026(KeithV): Created                                         */
+/*                                                                      */
+/************************************************************************/
+#ifndef _HOST_P32XXXX_H_
+#define _HOST_P32XXXX_H_
+
+#define __PIC32MZ__
+
+// the core timer, SYSTICKSPERSEC ticks a second of virtual time
+extern uint32_t LoopGetTick(void);
+#define _CP0_GET_COUNT()            LoopGetTick()
+#define _CP0_BIC_DEBUG(_mask)
+#define _CP0_DEBUG_COUNTDM_MASK     0
+
+// GetPeripheralClock() reads the divider
+#define PB2DIVbits                  ((struct {uint32_t PBDIV;}) {1})
+
+#endif // _HOST_P32XXXX_H_
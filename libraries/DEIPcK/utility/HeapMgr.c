@@ -46,6 +46,7 @@
 /*  Revision History:                                                   */
 /*                                                                      */
 /*	6/5/2013(KeithV): Created                                           */
+/*	10/19/2026(KeithV): Checksum while reading a stream out             */
 /*                                                                      */
 /************************************************************************/
 #include "deIP.h"
@@ -397,6 +398,27 @@ static uint16_t RAMCopyFromPage(HPMGR hPMGR, PGID pageID, uint16_t offset, uint8
 {
         return(RAMCopyToFromPage(hPMGR, false, pageID, offset, pb, cb));
 }
+static uint16_t RAMCopyFromPageSum(HPMGR hPMGR, PGID pageID, uint16_t offset, uint8_t * pb, uint16_t cb, uint16_t * pSum)
+{
+    PMGR *      pPMGR = (PMGR *) hPMGR;
+
+    if(hPMGR != NULL && PMGRIsAlloc(pPMGR, pageID))
+    {
+        uint8_t *   pbPage =   ((uint8_t *) hPMGR) +                                        // base address
+                                PMGRGetPMGRSize(pPMGR->cPages) +                            // beyond the PMRG struct; 4 byte aligned
+                                pageID * PMGRGetPageSizeFromPF2(pPMGR->pf2PerPage) +        // index to the page
+                                offset;                                                     // offset in the page
+
+        // make sure what is asked for fits in the page
+        if((((int32_t) PMGRGetPageSizeFromPF2(pPMGR->pf2PerPage)) - cb - offset) >= 0)
+        {
+            *pSum = CopyAndSum(pb, pbPage, cb);
+            return(cb);
+        }
+    }
+
+    return(0);
+}
 
 HPMGR RAMCreatePageMGR(uint8_t * pRam, uint32_t cbRam, uint8_t cPages, uint8_t pf2PageSize)
 {
@@ -418,6 +440,7 @@ HPMGR RAMCreatePageMGR(uint8_t * pRam, uint32_t cbRam, uint8_t cPages, uint8_t p
     // intialize page MGR struct
     pPMGR->CopyFromPage = RAMCopyFromPage;
     pPMGR->CopyToPage   = RAMCopyToPage;
+    pPMGR->CopyFromPageSum = RAMCopyFromPageSum;
     pPMGR->cPages       = cPages;
     pPMGR->cbAllocMap   = PMGRGetAllocBytesNeeded(cPages);
     pPMGR->pf2PerPage   = pf2PageSize;
@@ -521,10 +544,22 @@ HSMGR SMGRInit(void * pbSMGRMEM, uint32_t cbSMGRMEM, HPMGR hPMGR)
 }
 
 uint16_t SMGRCopyInOut(HSMGR hSMGR, bool fIn, uint16_t index, void * pb, uint16_t cb)
+{
+    return(SMGRCopyInOutSum(hSMGR, fIn, index, pb, cb, NULL));
+}
+
+// if pSum is not NULL, on a read it gets the ones complement sum of what was read, as CopyAndSum returns it
+uint16_t SMGRCopyInOutSum(HSMGR hSMGR, bool fIn, uint16_t index, void * pb, uint16_t cb, uint16_t * pSum)
 {
     SMGR *      pSMGR   = (SMGR *) hSMGR;
     uint16_t    cbCopy  = 0;
     uint16_t    cbT     = 0;
+    uint32_t    sum     = 0;
+
+    if(pSum != NULL)
+    {
+        *pSum = 0;
+    }
 
     if(cb > 0 && pSMGR != NULL && pSMGR->pPMGR != NULL)
     {
@@ -575,6 +610,25 @@ uint16_t SMGRCopyInOut(HSMGR hSMGR, bool fIn, uint16_t index, void * pb, uint16_
 
                 cbT = PMGRCopyToPage((HPMGR) pSMGR->pPMGR, pSMGR->rgPages[j], oPage, &((uint8_t *) pb)[cbCopy], cbCopyThisPass);
             }
+            else if(pSMGR->rgPages[j] != PMGRFreePage && pSum != NULL)
+            {
+                uint16_t sumT = 0;
+
+                // sum as we copy, or if the page manager can't, sum what we copied
+                if(pSMGR->pPMGR->CopyFromPageSum != NULL)
+                {
+                    cbT = pSMGR->pPMGR->CopyFromPageSum((HPMGR) pSMGR->pPMGR, pSMGR->rgPages[j], oPage, &((uint8_t *) pb)[cbCopy], cbCopyThisPass, &sumT);
+                }
+                else
+                {
+                    cbT = PMGRCopyFromPage((HPMGR) pSMGR->pPMGR, pSMGR->rgPages[j], oPage, &((uint8_t *) pb)[cbCopy], cbCopyThisPass);
+                    sumT = (uint16_t) ~CalculateChecksum(0xFFFF, &((uint8_t *) pb)[cbCopy], cbT);
+                }
+
+                // this piece starts on an odd byte of what we are reading, so its bytes are the other way around
+                if((cbCopy & 1) != 0) sumT = (uint16_t) ((sumT << 8) | (sumT >> 8));
+                sum += sumT;
+            }
             else if(pSMGR->rgPages[j] != PMGRFreePage)
             {
                 cbT = PMGRCopyFromPage((HPMGR) pSMGR->pPMGR, pSMGR->rgPages[j], oPage, &((uint8_t *) pb)[cbCopy], cbCopyThisPass);
@@ -601,6 +655,13 @@ uint16_t SMGRCopyInOut(HSMGR hSMGR, bool fIn, uint16_t index, void * pb, uint16_
         }
     }
 
+    if(pSum != NULL)
+    {
+        sum = (sum & 0x0000FFFF) + (sum >> 16);
+        sum = (sum & 0x0000FFFF) + (sum >> 16);
+        *pSum = (uint16_t) sum;
+    }
+
     return(cbCopy);
 }
 
@@ -46,6 +46,7 @@
 /*  Revision History:                                                   */
 /*                                                                      */
 /*	6/5/2013(KeithV): Created                                           */
+/*	10/19/2026(KeithV): Checksum while reading a stream out             */
 /*                                                                      */
 /************************************************************************/
 
@@ -93,6 +94,7 @@ typedef uint8_t PGID;
 // HPMGR RAMCreatePageMGR(uint8_t * pRam, uint32_t cbRam, uint8_t cPages, uint8_t pf2PageSize);
 typedef uint16_t (* DPMGRCopyToPage)(HPMGR hPMGR, PGID pageID, uint16_t offset, const uint8_t * pb, uint16_t cb);
 typedef uint16_t (* DPMGRCopyFromPage)(HPMGR hPMGR, PGID pageID, uint16_t offset, uint8_t * pb, uint16_t cb);
+typedef uint16_t (* DPMGRCopyFromPageSum)(HPMGR hPMGR, PGID pageID, uint16_t offset, uint8_t * pb, uint16_t cb, uint16_t * pSum);
 
 // pageIDs must only be 1 byte in size and can not be 0xFF
 // therefore we have a max of 255 useful pages
@@ -121,6 +123,7 @@ typedef struct PMGR_T
 {
     DPMGRCopyToPage     CopyToPage;         // copy bytes to a page
     DPMGRCopyFromPage   CopyFromPage;       // read bytes from a page
+    DPMGRCopyFromPageSum CopyFromPageSum;   // read bytes from a page and return their ones complement sum (CopyAndSum); NULL if not supported
     uint8_t             pf2PerPage;         // this is the power of 2 power factor, thus (1 << pfPerPage) MUST == cbPerPage.
     uint8_t             cPages;             // max of 255 pages 0-254; 0x255 == PMGRFreePage is reserved
     uint8_t             cAlloc;             // number of alloced pages
@@ -150,8 +153,10 @@ typedef const void * HSMGR;
 #define GetSMGRSize(_cPages) SYSAdjToDerefSize((sizeof(SMGR) + _cPages))
 HSMGR SMGRInit(void * pbSMGRMEM, uint32_t cbSMGRMEM, HPMGR hPMGR);
 uint16_t SMGRCopyInOut(HSMGR hSMGR, bool fIn, uint16_t index, void * pb, uint16_t cb);
+uint16_t SMGRCopyInOutSum(HSMGR hSMGR, bool fIn, uint16_t index, void * pb, uint16_t cb, uint16_t * pSum);
 #define SMGRWrite(_hSMGR, _index, _pb, _cb) SMGRCopyInOut(_hSMGR, true, _index, ((void *) (_pb)), _cb)
 #define SMGRRead(_hSMGR, _index, _pb, _cb) SMGRCopyInOut(_hSMGR, false, _index, _pb, _cb)
+#define SMGRReadSum(_hSMGR, _index, _pb, _cb, _pSum) SMGRCopyInOutSum(_hSMGR, false, _index, _pb, _cb, _pSum)
 void SMGRMoveEnd(HSMGR hSMGR, uint16_t index, uint16_t end);
 #define SMGRcbStream(_hSMGR) (((SMGR *) (_hSMGR))->iEnd - ((SMGR *) (_hSMGR))->iStart)
 void SMGRFree(HSMGR hSMGR);
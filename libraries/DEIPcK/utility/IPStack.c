@@ -143,6 +143,9 @@ uint16_t IPSGetPayloadFromAdaptor(IPSTACK * pIpStack, uint16_t cbAlloc)
     if(pIpStack != NULL)
     {
 
+        // whatever goes in the payload has not been summed yet
+        pIpStack->fPayloadSummed = false;
+
         // clean up the current payload
         if(pIpStack->pPayload != NULL)
         {
@@ -47,6 +47,8 @@
 /*  Revision History:													*/
 /*																		*/
 /*	8/15/2012(KeithV): Created											*/
+/*	10/19/2026(KeithV): Word aligned, unrolled CalculateChecksum		*/
+/*	10/19/2026(KeithV): CopyAndSum to checksum while copying			*/
 /*																		*/
 /************************************************************************/
 
@@ -122,42 +124,158 @@ void ExEndian(void * pv, int cb)
  *                  So under a non-error condition, machine order
  *                  structures will have a checksum of zero, and
  *                  network order structures will have the checksum
+ *
+ *                  For speed the bulk of the buffer is summed as aligned
+ *                  32 bit words into a 64 bit accumulator, 8 words at a time.
+ *                  A 2^16 carry is congruent to 1 in ones complement, so 
+ *                  folding the 64 bit sum down to 16 bits gives the same
+ *                  result as adding 16 bits at a time. An odd starting address
+ *                  is summed one byte over and swapped back at the end (RFC 1071 2(B)).
+ *                  The partial sum of the buffer is added to sumComplement last.
  * 
  ********************************************************************/
-static inline uint16_t __attribute__((always_inline)) unalignedload(volatile void *ptr)
- {
-    struct unaligned {
-      uint16_t u16;
-    } __attribute__ ((packed)) *ip;
-    ip = (struct unaligned *)ptr;
+static inline uint32_t __attribute__((always_inline)) SumAndCopy(uint8_t * pbDest, uint8_t const * pb, unsigned int cb, bool fCopy)
+{
+    uint64_t    sum64   = 0;
+    bool        fOdd    = (((uintptr_t) pb) & 1) != 0;
+    uint32_t    sum;
+
+    // odd address, put the first byte in the high byte of a word
+    // and sum the rest one byte off, we swap the sum back at the end
+    if(fOdd && cb > 0)
+    {
+        if(fCopy) *pbDest++ = *pb;
+        sum64 += ((uint32_t) *pb) << 8;
+        pb++;
+        cb--;
+    }
+
+    // get to a word boundary
+    if((((uintptr_t) pb) & 2) != 0 && cb >= sizeof(uint16_t))
+    {
+        uint16_t w = *((uint16_t const *) pb);
+
+        if(fCopy) { ((UNALIGNPTR *) pbDest)->u16 = w; pbDest += sizeof(uint16_t); }
+        sum64 += w;
+        pb += sizeof(uint16_t);
+        cb -= sizeof(uint16_t);
+    }
+
+    // the bulk of the buffer, 32 bytes a loop
+    // the source is aligned, the destination may not be
+    for(; cb >= 8 * sizeof(uint32_t); cb -= 8 * sizeof(uint32_t), pb += 8 * sizeof(uint32_t))
+    {
+        uint32_t const * pw = (uint32_t const *) pb;
+
+        if(fCopy)
+        {
+            uint32_t w0 = pw[0], w1 = pw[1], w2 = pw[2], w3 = pw[3];
+            uint32_t w4 = pw[4], w5 = pw[5], w6 = pw[6], w7 = pw[7];
+
+            ((UNALIGNPTR *) &pbDest[0])->u32    = w0;
+            ((UNALIGNPTR *) &pbDest[4])->u32    = w1;
+            ((UNALIGNPTR *) &pbDest[8])->u32    = w2;
+            ((UNALIGNPTR *) &pbDest[12])->u32   = w3;
+            ((UNALIGNPTR *) &pbDest[16])->u32   = w4;
+            ((UNALIGNPTR *) &pbDest[20])->u32   = w5;
+            ((UNALIGNPTR *) &pbDest[24])->u32   = w6;
+            ((UNALIGNPTR *) &pbDest[28])->u32   = w7;
+            pbDest += 8 * sizeof(uint32_t);
+
+            sum64 += w0; sum64 += w1; sum64 += w2; sum64 += w3;
+            sum64 += w4; sum64 += w5; sum64 += w6; sum64 += w7;
+        }
+        else
+        {
+            sum64 += pw[0];
+            sum64 += pw[1];
+            sum64 += pw[2];
+            sum64 += pw[3];
+            sum64 += pw[4];
+            sum64 += pw[5];
+            sum64 += pw[6];
+            sum64 += pw[7];
+        }
+    }
+
+    // remaining words
+    for(; cb >= sizeof(uint32_t); cb -= sizeof(uint32_t), pb += sizeof(uint32_t))
+    {
+        uint32_t w = *((uint32_t const *) pb);
+
+        if(fCopy) { ((UNALIGNPTR *) pbDest)->u32 = w; pbDest += sizeof(uint32_t); }
+        sum64 += w;
+    }
+
+    // remaining half word
+    if(cb >= sizeof(uint16_t))
+    {
+        uint16_t w = *((uint16_t const *) pb);
+
+        if(fCopy) { ((UNALIGNPTR *) pbDest)->u16 = w; pbDest += sizeof(uint16_t); }
+        sum64 += w;
+        pb += sizeof(uint16_t);
+        cb -= sizeof(uint16_t);
+    }
+
+    // see if we need to pad a zero at the end of the last odd byte; RFC 1071
+    if(cb > 0)
+    {
+        if(fCopy) *pbDest = *pb;
+        sum64 += (((uint16_t) *pb) & 0x00FF);
+    }
 
-    return ip->u16;
- }
+    // fold the carries down to 16 bits
+    sum64   = (sum64 & 0xFFFFFFFF) + (sum64 >> 32);
+    sum64   = (sum64 & 0xFFFFFFFF) + (sum64 >> 32);
+    sum     = (uint32_t) sum64;
+    sum     = (sum & 0x0000FFFF) + (sum >> 16);
+    sum     = (sum & 0x0000FFFF) + (sum >> 16);
+
+    // we summed one byte off, swap it back
+    if(fOdd) sum = ((sum & 0x00FF) << 8) | (sum >> 8);
+
+    return(sum);
+}
 
 uint16_t CalculateChecksum(uint16_t sumComplement, void * pv, unsigned int cb)
 {
-    uint8_t *       pbEnd   = ((uint8_t *) pv) + cb;
     uint32_t        sum     = ((uint32_t) (~sumComplement)) & 0x0000FFFF;
 
     if(cb > 0)
     {
-        // make this as short and sweet so the compiler can do the best it can
-//        for(; pv < (void *) (pbEnd-1); pv += sizeof(uint16_t)) sum += *((uint16_t *) pv);         // this faults on unaligned pv
-//        for(; pv < (void *) (pbEnd-1); pv += sizeof(uint16_t)) sum += (uint32_t) (((uint16_t) *((uint8_t *) pv)) | (((uint16_t) *((uint8_t *) pv+1)) << 8));  // works but gens more code than below
-        for(; pv < (void *) (pbEnd-1); pv = ((uint8_t *) pv) + sizeof(uint16_t)) sum += unalignedload(pv);
-
-        // see if we need to pad a zero at the end of the last odd byte; RFC 1071
-        // no need to worry about unaligned pv as we deref as a byte only
-        if(pv < (void *) pbEnd) sum += (((uint16_t) (*(pbEnd - 1))) & 0x00FF);
-
-        // add the carry until all carries are added
-        while((sum & 0xFFFF0000) != 0) sum = (sum & 0x0000FFFF) + (sum >> 16);
+        // add in the sum of the buffer
+        sum += SumAndCopy(NULL, (uint8_t const *) pv, cb, false);
+        sum = (sum & 0x0000FFFF) + (sum >> 16);
     }
     
     // return the ones complement
     return((uint16_t) ((~sum) & 0x0000FFFF));
 }
 
+/*********************************************************************
+ * Function:        uint16_t CopyAndSum(void * pvDest, const void * pvSrc, unsigned int cb)
+ *
+ * Input:           pvDest  Where to copy to, any alignment
+ *                  pvSrc   What to copy and sum
+ *                  cb      The number of bytes to copy
+ *                  
+ * Output:          cb bytes of pvSrc are copied to pvDest
+ * 
+ * Returns:         The ones complement sum of the bytes, not complemented
+ *                  and in the same order CalculateChecksum uses. 
+ * 
+ * Note:            Touches each byte once to both copy and sum it.
+ *                  Because the sum is not complemented, putting it in a uint16_t 
+ *                  and running it through CalculateChecksum gives the same
+ *                  checksum as running the bytes through. To add a sum of bytes 
+ *                  that start at an odd offset, swap its bytes first.
+ ********************************************************************/
+uint16_t CopyAndSum(void * pvDest, const void * pvSrc, unsigned int cb)
+{
+    return((uint16_t) SumAndCopy((uint8_t *) pvDest, (uint8_t const *) pvSrc, cb, true));
+}
+
 // Because this can be running on one of many systems, and because we do not know what
 // what kinds of clocks or the frequency or wrap time is available, it is difficult
 // to pick an update time that works for all systems. With the MX7cK the system clock
@@ -112,6 +112,7 @@ static inline uint32_t __attribute__((always_inline)) InitBoard(void)
 
 void ExEndian(void * pb, int cb);
 uint16_t CalculateChecksum(uint16_t sumComplement, void * pv, unsigned int cb);
+uint16_t CopyAndSum(void * pvDest, const void * pvSrc, unsigned int cb);
 
 void SYSPeriodicTasks(void);
 uint32_t SYSGetSecond(void);
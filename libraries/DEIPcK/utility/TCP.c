@@ -46,12 +46,18 @@
 /************************************************************************/
 /*  Revision History:                                                   */
 /*      9/12/2012(KeithV): Created                                      */
+/*      10/19/2026(KeithV): Use the payload sum taken while copying     */
+/*      10/19/2026(KeithV): Drop any external send buffer on reset      */
+/*      10/19/2026(KeithV): Default socket send options                 */
+/*      10/19/2026(KeithV): TCP transmit counters                       */
+/*      10/19/2026(KeithV): Start the congestion window at the default  */
 /*                                                                      */
 /************************************************************************/
 #include "deIP.h"
 
 static uint16_t     g_nextTCPEphemeralPort  = portEphemeralFirst;
 FFPT                g_ffptActiveTCPSockets = {NULL, NULL};
+TCPTXSTATS          g_tcpTxStats            = {0, 0, 0, 0, 0};
 
 // the compiler will zero this, but it would be better if this were random and uninitialized
 static uint32_t     cSeqNbrFixup;
@@ -197,8 +203,15 @@ uint32_t ExTCPHeader(IPSTACK * pIpStack, bool fStartsInMachineOrder)
         }
     }
 
-    // add the data
-    pIpStack->pTCPHdr->checksum = CalculateChecksum(sum, pIpStack->pPayload, pIpStack->cbPayload);
+    // add the data, if we summed it when it was copied in just add that sum
+    if(pIpStack->fPayloadSummed)
+    {
+        pIpStack->pTCPHdr->checksum = CalculateChecksum(sum, &pIpStack->sumPayload, sizeof(pIpStack->sumPayload));
+    }
+    else
+    {
+        pIpStack->pTCPHdr->checksum = CalculateChecksum(sum, pIpStack->pPayload, pIpStack->cbPayload);
+    }
 
     // RFC 768, if zero and outgoing, make all FFs
     if(fStartsInMachineOrder)
@@ -459,6 +472,12 @@ TCPSOCKET * TCPInitSocket(const LLADP * pLLAdp, TCPSOCKET * pSocketOpen, HPMGR h
     pSocketOpen->tRTO_SET       = RTO(pSocketOpen);
     pSocketOpen->tRTOCur        = pSocketOpen->tRTO_SET;
 
+    // send options, until TCPSetNoDelay, TCPSetDelayedAck or TCPSetSendWindow change them
+    pSocketOpen->fNoDelay       = false;
+    pSocketOpen->tDelayedAck    = MAXFLUSH;
+    pSocketOpen->cTxSegments    = CNTPAUSESEND;
+    pSocketOpen->cTxWindow      = CNTPAUSESEND;
+
     return(pSocketOpen);
 }
 
@@ -526,6 +545,10 @@ void TCPResetSocket(TCPSOCKET *  pSocket)
 //    pSocket->sndWL2     = 0;
     pSocket->sndUP          = 0;
     pSocket->sndRTTComplete = 0;
+    pSocket->pbExt          = NULL;
+    pSocket->cbExt          = 0;
+    pSocket->sndRecover     = 0;
+    pSocket->fFastRecovery  = false;
     
     pSocket->rcvIRS         = 0;
     // pSocket->rcvUNR     = 0;
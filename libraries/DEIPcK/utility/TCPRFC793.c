@@ -46,6 +46,8 @@
 /*  Revision History:                                                   */
 /*                                                                      */
 /*	10/9/2012(KeithV): Created                                          */
+/*	10/19/2026(KeithV): TCPWriteExternal, send from a pinned buffer     */
+/*	10/19/2026(KeithV): Per socket no delay, delayed ACK, send window   */
 /*                                                                      */
 /************************************************************************/
 #include "deIP.h"
@@ -365,6 +367,15 @@ void TCPClose(HSOCKET hSocket, IPSTATUS * pStatus)
         return;
     }
 
+    // the caller is taking back a buffer we have not finished sending
+    // we can't finish the stream without it, so the connection has to go
+    if(TCPExternalUnacked(hSocket) > 0)
+    {
+        TCPAbort(hSocket);
+        AssignStatusSafely(pStatus, IPStatusFromTCPState(pSocket->tcpState));
+        return;
+    }
+
     switch(TCPState(pSocket))
     {
         case  tcpListen:
@@ -460,8 +471,12 @@ uint32_t TCPWrite(HSOCKET hSocket, const void * pv, uint32_t cbReq, IPSTATUS * p
 
             // after we have scaled our pointers and potentially released some memory, we can
             // write as much data as we can to the stream
-            cb  = SMGRWrite((HSMGR) pSMGR, SMGRcbStream(pSMGR), pv, cbReq);
-            pSocket->sndEND += cb;
+            // but not while an external buffer is pending, that has to stay at the end of what we send
+            if(pSocket->cbExt == 0)
+            {
+                cb  = SMGRWrite((HSMGR) pSMGR, SMGRcbStream(pSMGR), pv, cbReq);
+                pSocket->sndEND += cb;
+            }
 
             // save away the table that is stored on the stack
             // this should not fail! It is a fixed size and already allocated
@@ -472,6 +487,101 @@ uint32_t TCPWrite(HSOCKET hSocket, const void * pv, uint32_t cbReq, IPSTATUS * p
     return(cb);
 }
 
+/*****************************************************************************
+  Function:
+	uint32_t TCPWriteExternal(HSOCKET hSocket, const void * pv, uint32_t cbReq, IPSTATUS * pStatus)
+
+  Description:
+        Queues a buffer to be sent without copying it into the socket. Segments are
+        built straight out of the buffer, so it must not be changed or reused until
+        TCPExternalUnacked returns 0, that is when the remote has ACKed all of it.
+        Only one external buffer may be pending at a time, and TCPWrite
+        will not take any more data until it is ACKed.
+
+        If the socket is closed before the buffer is ACKed, the connection is aborted.
+
+  Parameters:
+	hSocket:        The socket to send the data on
+
+        pv:             a pointer to the buffer to send, it is pinned until ACKed
+
+        cbReq:          The number of bytes to send.
+
+        pStatus:        A pointer to a status variable to recieve the state of the send
+
+  Returns:
+        cbReq if the buffer was queued, 0 if an external buffer is still pending or
+        the connection is not established.
+
+  ***************************************************************************/
+uint32_t TCPWriteExternal(HSOCKET hSocket, const void * pv, uint32_t cbReq, IPSTATUS * pStatus)
+{
+    TCPSOCKET * pSocket = (TCPSOCKET *) hSocket;
+    uint32_t    cb      = 0;
+
+    if(pSocket == NULL)
+    {
+        AssignStatusSafely(pStatus, ipsSocketNULL);
+        return(0);
+    }
+
+    // we can only write data if we are in the established state
+    if(TCPIsEstablished(pSocket, pStatus))
+    {
+        SMGR *  pSMGR = alloca(pSocket->cbTxSMGR);
+
+        if(cbReq > 0 && pv != NULL && pSMGR != NULL && (SMGRRead((HSMGR) &pSocket->smgrRxTxBuff, pSocket->cbRxSMGR, pSMGR, pSocket->cbTxSMGR) == pSocket->cbTxSMGR))
+        {
+            // let go of what has been ACK'ed, that may finish off the last external buffer
+            bool fScaled = TCPScaleSndIndexes(pSocket, pSMGR);
+
+            // the buffer goes on the end of the stream, after anything in the socket pages
+            if(pSocket->cbExt == 0)
+            {
+                pSocket->pbExt  = (const uint8_t *) pv;
+                pSocket->cbExt  = cbReq;
+                pSocket->sndEND += cbReq;
+                cb              = cbReq;
+            }
+
+            // only the page table moves on a scale
+            if(fScaled)
+            {
+                SMGRWrite((HSMGR) &pSocket->smgrRxTxBuff, pSocket->cbRxSMGR, pSMGR, pSocket->cbTxSMGR);
+            }
+        }
+    }
+
+    return(cb);
+}
+
+/*****************************************************************************
+  Function:
+	uint32_t TCPExternalUnacked(HSOCKET hSocket)
+
+  Description:
+        How much of the buffer given to TCPWriteExternal the remote has not ACKed yet.
+
+  Parameters:
+	hSocket:        The socket the external buffer was written to
+
+  Returns:
+        The number of unACKed bytes, when 0 the buffer is no longer used by the socket.
+
+  ***************************************************************************/
+uint32_t TCPExternalUnacked(HSOCKET hSocket)
+{
+    TCPSOCKET * pSocket = (TCPSOCKET *) hSocket;
+
+    // the external buffer is the tail of the stream, anything below sndUNA is done with
+    if(pSocket == NULL || pSocket->cbExt == 0 || pSocket->sndUNA >= pSocket->sndEND)
+    {
+        return(0);
+    }
+
+    return(min(pSocket->cbExt, pSocket->sndEND - pSocket->sndUNA));
+}
+
 /*****************************************************************************
   Function:
 	void TCPFlush(SOCKET *  pSocket)
@@ -497,6 +607,94 @@ void TCPFlush(HSOCKET hSocket)
     }
 }
 
+/*****************************************************************************
+  Function:
+	void TCPSetNoDelay(HSOCKET hSocket, bool fNoDelay)
+
+  Description:
+        By default small amounts of data are held back for up to MAXFLUSH ms so
+        they can go out together in one segment. With fNoDelay, whatever is in the
+        socket is sent as soon as the window allows; like TCP_NODELAY.
+
+  Parameters:
+	hSocket:        The socket to set the option on
+
+        fNoDelay:       true to send small segments right away
+
+  Returns:
+         None
+
+  ***************************************************************************/
+void TCPSetNoDelay(HSOCKET hSocket, bool fNoDelay)
+{
+    TCPSOCKET * pSocket = (TCPSOCKET *) hSocket;
+
+    if(pSocket != NULL)
+    {
+        pSocket->fNoDelay = fNoDelay;
+    }
+}
+
+/*****************************************************************************
+  Function:
+	void TCPSetDelayedAck(HSOCKET hSocket, uint32_t msDelay)
+
+  Description:
+        Sets the longest time an ACK is held hoping to go out with data; RFC 1122 4.2.3.2.
+        A second segment to ACK, or half the RTO, still sends the ACK sooner.
+
+  Parameters:
+	hSocket:        The socket to set the option on
+
+        msDelay:        The delay in ms, 0 ACKs right away; it is capped at MAXFLUSH
+
+  Returns:
+         None
+
+  ***************************************************************************/
+void TCPSetDelayedAck(HSOCKET hSocket, uint32_t msDelay)
+{
+    TCPSOCKET * pSocket = (TCPSOCKET *) hSocket;
+
+    if(pSocket != NULL)
+    {
+        pSocket->tDelayedAck = min(msDelay, MAXFLUSH);
+    }
+}
+
+/*****************************************************************************
+  Function:
+	void TCPSetSendWindow(HSOCKET hSocket, uint32_t cSegments)
+
+  Description:
+        Sets how many segments may go out after an ACK before we wait for the next one.
+        The default of CNTPAUSESEND is gentle on the network, but on a long round trip
+        it limits the throughput, and with so few segments in flight a lost one may not
+        bring back the 3 duplicate ACKs needed for a fast retransmit.
+
+        The remote's window, and what is in the socket, still limit what is sent.
+        On a loss the congestion window drops below this and grows back up to it.
+
+  Parameters:
+	hSocket:        The socket to set the option on
+
+        cSegments:      Segments in flight, 1 to CNTMAXPAUSESEND
+
+  Returns:
+         None
+
+  ***************************************************************************/
+void TCPSetSendWindow(HSOCKET hSocket, uint32_t cSegments)
+{
+    TCPSOCKET * pSocket = (TCPSOCKET *) hSocket;
+
+    if(pSocket != NULL)
+    {
+        pSocket->cTxSegments = (uint8_t) max(1, min(cSegments, CNTMAXPAUSESEND));
+        pSocket->cTxWindow   = pSocket->cTxSegments;
+    }
+}
+
 /*****************************************************************************
   Function:
 	uint32_t TCPAvailable(SOCKET *  pSocket, IPSTATUS * pStatus)
@@ -46,6 +46,11 @@
 /*  Revision History:                                                   */
 /*                                                                      */
 /*	12/13/2012(KeithV): Created                                         */
+/*	10/19/2026(KeithV): Sum the payload as it is read from the socket   */
+/*	10/19/2026(KeithV): Build segments from the external send buffer    */
+/*	10/19/2026(KeithV): RFC 5681 fast retransmit and limited transmit   */
+/*	10/19/2026(KeithV): Count what we transmit                          */
+/*	10/19/2026(KeithV): Cut the window on fast retransmit and timeout   */
 /*                                                                      */
 /************************************************************************/
 #include "deIP.h"
@@ -257,7 +262,10 @@ void TCPStateMachine(IPSTACK *   pIpStack, TCPSOCKET *  pSocket, IPSTATUS * pSta
             pSocket->sndUP      = 0;
             pSocket->sndEND     = 0;
             pSocket->sndPSH     = 0;
-            pSocket->cTxUntilPause = CNTPAUSESEND;
+            pSocket->sndRecover = 0;
+            pSocket->fFastRecovery = false;
+            pSocket->cTxWindow  = pSocket->cTxSegments;
+            pSocket->cTxUntilPause = pSocket->cTxWindow;
 
             pSocket->tcpState   = tcpEstablished;
 
@@ -970,14 +978,34 @@ static void TCPProcessACK(IPSTACK *  pIpStack, TCPSOCKET * pSocket, uint32_t tCu
                     pSocket->cSameAck < 15)                     // do not want to overflow the counter and wrap
                 {
                     pSocket->cSameAck++;
+
+                    // RFC 3042 limited transmit, the first duplicate ACKs each let one new segment out
+                    // so even a small window gets enough duplicate ACKs back to fast retransmit
+                    if(pSocket->cSameAck < cDupAckFastRetransmit && !pSocket->fFastRecovery)
+                    {
+                        pSocket->cTxUntilPause++;
+                    }
                 }
             }
             else
             {
                 // update my unacked ack location
                 pSocket->cSameAck = 0;
-                pSocket->cTxUntilPause = CNTPAUSESEND;
                 pSocket->sndUNA = pIpStack->pTCPHdr->ackNbr;
+
+                // once everything out at the fast retransmit is ACKed we are out of recovery
+                // a partial ACK leaves us sending again from sndUNA, which is the next hole
+                if(pSocket->fFastRecovery && pSocket->sndUNA >= pSocket->sndRecover)
+                {
+                    pSocket->fFastRecovery = false;
+                }
+
+                // out of recovery the window grows back a segment per ACK, RFC 5681 congestion avoidance in segments
+                else if(!pSocket->fFastRecovery && pSocket->cTxWindow < pSocket->cTxSegments)
+                {
+                    pSocket->cTxWindow++;
+                }
+                pSocket->cTxUntilPause = pSocket->cTxWindow;
             }
 
             // this should ONLY happen when we retransmit
@@ -990,7 +1018,7 @@ static void TCPProcessACK(IPSTACK *  pIpStack, TCPSOCKET * pSocket, uint32_t tCu
             {
                 pSocket->sndNXT = pSocket->sndUNA;
                 pSocket->cSameAck = 0;
-                pSocket->cTxUntilPause = CNTPAUSESEND;
+                pSocket->cTxUntilPause = pSocket->cTxWindow;
             }
 
 //            if(pSocket->sndUNA >= pSocket->rcvSeqAhead)
@@ -1096,14 +1124,47 @@ static bool TCPCheckForReTransmit(IPSTACK *  pIpStack, TCPSOCKET * pSocket, uint
             }
         }
 
+        // RFC 5681 3.2 fast retransmit; duplicate ACKs say a segment was lost but the ones after it got there
+        // so resend from the hole now instead of waiting out the RTO. This is not a timeout, the RTO does not back off.
+        // Only once until everything out right now is ACKed, RFC 6582; duplicate ACKs until then are from the same loss
+        else if(pSocket->cSameAck >= cDupAckFastRetransmit && !pSocket->fFastRecovery && 
+                (pSocket->tcpState == tcpEstablished || pSocket->tcpState == tcpCloseWait))
+        {
+            AssignStatusSafely(pStatus, ipsRetransmit);
+            pSocket->cSameAck       = 0;
+            pSocket->fFastRecovery  = true;
+            pSocket->sndRecover     = pSocket->sndNXT;
+            g_tcpTxStats.cFastRetransmit++;
+
+            // Karn, don't take a round trip time off of a retransmitted segment
+            if(pSocket->cRetransmit == 0) pSocket->cRetransmit++;
+
+            // restart the retransmit timer from the fast retransmit
+            pSocket->tLastAck       = tCur;
+
+            // resend the lost segment, what was in flight is back in the window.
+            // When it is ACKed the receiver usually ACKs what it got after it as well
+            // and TCPProcessACK moves sndNXT right back up.
+            pSocket->sndWND         += pSocket->sndNXT - pSocket->sndUNA;
+            pSocket->sndNXT         = pSocket->sndUNA;
+            pSocket->cTxUntilPause  = 1;
+
+            // RFC 5681 3.2, ssthresh = max(FlightSize / 2, 2 * SMSS); we count in segments
+            // and stay at the cut window through recovery, it grows again once we are out
+            pSocket->cTxWindow      = (uint8_t) max(2, pSocket->cTxWindow / 2);
+        }
+
         // Now just set our sndNext back and send those packets again.
-        else if(tCur - pSocket->tLastAck >= pSocket->tRTOCur || pSocket->cSameAck >= cDupAckFastRetransmit)
+        // The duplicate ACK term is for the states fast retransmit does not cover, 
+        // FIN wait 1, closing and last ACK, where our FIN is out after the data
+        else if(tCur - pSocket->tLastAck >= pSocket->tRTOCur || (pSocket->cSameAck >= cDupAckFastRetransmit && !pSocket->fFastRecovery))
         {
             IPSTATUS status;
 
             // we are clearly retransmitting.
             AssignStatusSafely(pStatus, ipsRetransmit);
             pSocket->cSameAck = 0;
+            pSocket->fFastRecovery = false;
             
             // Only pretend to retransmit if we are not connected
             // but don't actually retransmit, and don't timeout either
@@ -1139,6 +1200,8 @@ static bool TCPCheckForReTransmit(IPSTACK *  pIpStack, TCPSOCKET * pSocket, uint
                 return(true);
             }
 
+            g_tcpTxStats.cRetransmit++;
+
             // set up for our next timeout time
             // We are required to exponetially grow
             // but eventually we will max out
@@ -1164,7 +1227,9 @@ static bool TCPCheckForReTransmit(IPSTACK *  pIpStack, TCPSOCKET * pSocket, uint
             // and we don't want to redump everything, we may wish to move forward to his ACK
             // if he can handle out of sequence packets and will jump forward beyond
             // just this one missing packet. This will prevent retransmitting unneeded data on the wire
+            // RFC 5681 3.1, after a timeout the window is one segment and grows back from there
             pSocket->cTxUntilPause = 1;
+            pSocket->cTxWindow = 1;
 
             // if we need to resent the SYN, then do that.
             // this is very difficult as CreateSyn resets a bunch of stuff and requires ARP to succeed. Typically ARP will succeed because the
@@ -1374,6 +1439,13 @@ bool TCPTransmit(IPSTACK *  pIpStack, TCPSOCKET * pSocket, int32_t cbSend, int32
             pSocket->cTxUntilPause--;
         }
 
+        // count the data going out
+        if(cbSend > 0 && pIpStack->cbPayload > 0)
+        {
+            g_tcpTxStats.cbPayload += pIpStack->cbPayload;
+            g_tcpTxStats.cSegments++;
+        }
+
         // start of a new calculation for RTT; RFC 793 3.7
         // we redo this with RFC 1122 4.2.2.15
         // and looking at Karn's / Jacobson's Algorithm
@@ -1502,9 +1574,9 @@ static bool TCPProcessTxSocketBuffers(IPSTACK * pIpStack, TCPSOCKET * pSocket, u
         // Retransmit time is a calculated and conservative time, so this is probably too long to wait for the ACK
         // let's back off on retransmit time and make sure we ACK before they retransmit.
         // On init, retransmit times are long, so lets make sure we are quick enough to retransmit even with init RTO.
-        // so put the ACK out at least as fast as MAXFLUSH
+        // so put the ACK out at least as fast as tDelayedAck, which is MAXFLUSH unless the socket was told otherwise
         // Also, before we have establish an RTT time, immdiately ACK if we go any ack request.
-        || ((pSocket->cNeedAck > 0) && ((pSocket->cRTT < cRTTINVALID) || ((tCur - pSocket->tLastSnd) >= min(MAXFLUSH, (pSocket->tRTOCur/2)))));
+        || ((pSocket->cNeedAck > 0) && ((pSocket->cRTT < cRTTINVALID) || ((tCur - pSocket->tLastSnd) >= min(pSocket->tDelayedAck, (pSocket->tRTOCur/2)))));
 
     // if we have data to send, lets think about sending it.
     if(*pcbSend > 0)
@@ -1516,6 +1588,9 @@ static bool TCPProcessTxSocketBuffers(IPSTACK * pIpStack, TCPSOCKET * pSocket, u
         // check to see if we are to push right now
         fForceAck = fForceAck || pIpStack->pTCPHdr->fPsh
 
+            // the socket was told not to hold small segments back
+            || pSocket->fNoDelay
+
             // if there is a big enough data in the socket, send it now
             || (*pcbSend >= (pSocket->cbRemoteEffMSS / 4))
 
@@ -1528,7 +1603,8 @@ static bool TCPProcessTxSocketBuffers(IPSTACK * pIpStack, TCPSOCKET * pSocket, u
         // send the packet if we are to send it.
         if(fForceAck)
         {
-            SMGR *  pSMGR = alloca(pSocket->cbTxSMGR);
+            SMGR *      pSMGR   = alloca(pSocket->cbTxSMGR);
+            uint32_t    tStart  = GetSysTick();
 
             if(pSMGR != NULL && (SMGRRead((HSMGR) &pSocket->smgrRxTxBuff, pSocket->cbRxSMGR, pSMGR, pSocket->cbTxSMGR) == pSocket->cbTxSMGR))
             {
@@ -1538,10 +1614,35 @@ static bool TCPProcessTxSocketBuffers(IPSTACK * pIpStack, TCPSOCKET * pSocket, u
                 // see if we get the payload space
                 if(((*pcbSend) = IPSGetPayloadFromAdaptor(pIpStack, *pcbSend)) > 0)
                 {
-                    // read the data
-                    *pcbSend  = SMGRRead((HSMGR) pSMGR, pSocket->sndNXT,  pIpStack->pPayload, *pcbSend);
-                    pIpStack->cbPayload = *pcbSend;
+                    uint32_t    cbPages = pSocket->sndEND - pSocket->cbExt;
+                    uint32_t    cbRead  = 0;
 
+                    pIpStack->sumPayload = 0;
+
+                    // read the data, and sum it while we have it so the checksum does not have to read it again
+                    if(pSocket->sndNXT < cbPages)
+                    {
+                        cbRead = SMGRReadSum((HSMGR) pSMGR, pSocket->sndNXT,  pIpStack->pPayload, min(*pcbSend, (int32_t) (cbPages - pSocket->sndNXT)), &pIpStack->sumPayload);
+                    }
+
+                    // the rest comes straight out of the external buffer
+                    if(cbRead < (uint32_t) *pcbSend && pSocket->sndNXT + cbRead >= cbPages)
+                    {
+                        uint32_t    sum     = pIpStack->sumPayload;
+                        uint16_t    sumExt  = CopyAndSum(&pIpStack->pPayload[cbRead], &pSocket->pbExt[pSocket->sndNXT + cbRead - cbPages], *pcbSend - cbRead);
+
+                        // if it lands on an odd byte of the payload its bytes are the other way around
+                        if((cbRead & 1) != 0) sumExt = (uint16_t) ((sumExt << 8) | (sumExt >> 8));
+                        sum += sumExt;
+                        sum = (sum & 0x0000FFFF) + (sum >> 16);
+                        pIpStack->sumPayload = (uint16_t) sum;
+
+                        cbRead = *pcbSend;
+                    }
+
+                    *pcbSend = cbRead;
+                    pIpStack->cbPayload = *pcbSend;
+                    pIpStack->fPayloadSummed = true;
                 }
 
                 // this is somewhat complicated, if we failed to get a payload we can swamp
@@ -1570,6 +1671,8 @@ static bool TCPProcessTxSocketBuffers(IPSTACK * pIpStack, TCPSOCKET * pSocket, u
                     SMGRWrite((HSMGR) &pSocket->smgrRxTxBuff, pSocket->cbRxSMGR, pSMGR, pSocket->cbTxSMGR);
                 }
             }
+
+            g_tcpTxStats.tBuild += GetSysTick() - tStart;
         }
     }
 
@@ -1582,12 +1685,30 @@ bool TCPScaleSndIndexes(TCPSOCKET * pSocket, SMGR *  pSMGR)
 {
     if(pSocket->sndUNA > 0)
     {
+        uint32_t cbAckPages = pSocket->sndUNA;
+
         /************************************************************************************/
         /**************************   SCALE SEND INDEXES    *********************************/
         /************************************************************************************/
+        // anything ACK'ed beyond the socket pages is in the external buffer
+        // step over it, and once all of it is ACK'ed we no longer point to it
+        if(pSocket->cbExt > 0 && pSocket->sndUNA > (pSocket->sndEND - pSocket->cbExt))
+        {
+            uint32_t cbAckExt = min(pSocket->sndUNA - (pSocket->sndEND - pSocket->cbExt), pSocket->cbExt);
+
+            cbAckPages      = pSocket->sndEND - pSocket->cbExt;
+            pSocket->pbExt  += cbAckExt;
+            pSocket->cbExt  -= cbAckExt;
+
+            if(pSocket->cbExt == 0)
+            {
+                pSocket->pbExt = NULL;
+            }
+        }
+
         // Keep ourselves scaled at the bottom of the uint32_t so we can do linear compares
         // we can remove all Tx data that has been ACK'ed.
-        SMGRMoveEnd((HSMGR) pSMGR, pSocket->sndUNA, SMGRAtBegining);
+        SMGRMoveEnd((HSMGR) pSMGR, cbAckPages, SMGRAtBegining);
 
         pSocket->sndISS             += pSocket->sndUNA;
         pSocket->sndNXT             -= pSocket->sndUNA;
@@ -1595,6 +1716,7 @@ bool TCPScaleSndIndexes(TCPSOCKET * pSocket, SMGR *  pSMGR)
         pSocket->sndPSH             -= pSocket->sndUNA;
         pSocket->sndUP              -= pSocket->sndUNA;
         pSocket->sndRTTComplete     -= pSocket->sndUNA;
+        pSocket->sndRecover         -= pSocket->sndUNA;
 
         // make UNA the bottom
         pSocket->sndUNA             =  0;
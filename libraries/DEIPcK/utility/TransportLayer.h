@@ -47,6 +47,9 @@
 /*  Revision History:													*/
 /*																		*/
 /*	9/12/2012(KeithV): Created											*/
+/*	10/19/2026(KeithV): Send straight out of an external pinned buffer	*/
+/*	10/19/2026(KeithV): Socket send options and fast recovery			*/
+/*	10/19/2026(KeithV): Congestion window in segments					*/
 /*																		*/
 /************************************************************************/
 #ifndef _TRANSPORT_LAYER_H_
@@ -299,6 +302,12 @@ typedef struct TCPSOCKET_T
 //    uint32_t                sndWL2;         // This is the sndWND position when we get an updated window size; not need as we can use sndUNA
     uint32_t                sndUP;          // send urgent pointer
     uint32_t                sndRTTComplete; // when I get an ACK >= to this, than I know thisis my round trip time.
+    uint32_t                sndRecover;     // sndNXT when we fast retransmitted, RFC 6582 recover; we are in fast recovery until it is ACKed
+
+    // an external buffer the user pinned for us to send directly out of; see TCPWriteExternal
+    // it is always the last cbExt bytes before sndEND, the socket pages hold everything before it
+    const uint8_t *         pbExt;          // the external byte at (sndEND - cbExt)
+    uint32_t                cbExt;          // bytes of the external buffer we still point to
 
     // Round Trip and retry timers
     uint32_t                tLastSnd;       // the last time we sent any packet
@@ -308,7 +317,9 @@ typedef struct TCPSOCKET_T
     {
         unsigned            fSocketOpen         : 1;    // If true the socket is in use and has not been closed by the user
         unsigned            fGotFin             : 1;    // did I recieve the FIN or not
-        unsigned            pad                 : 6;    // padding
+        unsigned            fNoDelay            : 1;    // send small segments right away, don't hold them to coalesce; no Nagle
+        unsigned            fFastRecovery       : 1;    // we fast retransmitted and are waiting for the ACK of sndRecover
+        unsigned            pad                 : 4;    // padding
     };
 
     uint8_t                 cZWndProbe;         // How many times we have retransmitted a zero window probe
@@ -317,13 +328,15 @@ typedef struct TCPSOCKET_T
     uint8_t                 cTxUntilPause;      // how many sends until we pause sending waiting for an ACK
     uint8_t                 cSameAck;           // count of identical ACK coming in
     uint8_t                 cRetransmit;        // How many times we have retransmitted
-    uint8_t                 pad2;               // padding
+    uint8_t                 cTxSegments;        // how many sends we allow after an ACK before pausing for the next; our send window in segments
+    uint8_t                 cTxWindow;          // our congestion window in segments, cut on a loss and grown by one per ACK back up to cTxSegments
 
     int32_t                 RTTsa;          // See Jacobson's algorithms
     int32_t                 RTTsv;          // See Jacobson's algorithms
     uint32_t                tRTOCur;        // Current Round-Trip Timeout
     uint32_t                tRTO_SET;       // Karn's Round-Trip Set time
     uint32_t                tSndRTTStart;   // when we started measuring
+    uint32_t                tDelayedAck;    // the longest we hold an ACK hoping to piggy back it; 0 ACKs at once
 
 #if 0
     // DEBUG VARIABLES, this can be removed.
@@ -352,6 +365,7 @@ typedef struct TCPSOCKET_T
 #define cRTTINVALID             8               // how many round trip measurments before the RTT is accurate, 8 is what J&K says
 #define cDupAckFastRetransmit   3               // you think this might be 2, but NetMon reports this on 3 dup acks
 #define CNTPAUSESEND            3               // don't flood the network with unacked sends
+#define CNTMAXPAUSESEND         16              // the most TCPSetSendWindow will let a socket have in flight
 
 // the data layout  is
 // socket poll struct
@@ -47,6 +47,10 @@
 /*  Revision History:                                                   */
 /*                                                                      */
 /*	7/10/2012(KeithV): Created                                          */
+/*	10/19/2026(KeithV): IPSTACK can carry the sum of its payload        */
+/*	10/19/2026(KeithV): TCPWriteExternal and TCPExternalUnacked         */
+/*	10/19/2026(KeithV): Per socket send options                        */
+/*	10/19/2026(KeithV): TCP transmit counters                           */
 /*                                                                      */
 /************************************************************************/
 #ifndef _NETWORK_DEIP_H_
@@ -326,7 +330,8 @@ typedef struct IPSTACK_T
             bool                        fFreePayloadToAdp   : 1;    // the payload was allocated seperately from the IPStack
             unsigned                    headerOrder         : 1;    // network (Big Endian) or machine order (?? Endian)
             unsigned                    ipss                : 4;    // IPStack Parsing Status
-            unsigned                                        : 4;    // bits for the adaptor to use
+            bool                        fPayloadSummed      : 1;    // sumPayload holds the sum of the payload, taken when it was copied in
+            unsigned                                        : 3;    // bits for the adaptor to use
          };
         uint16_t                        ipsFlags;                   // make it easy to clear flags
     };
@@ -361,7 +366,7 @@ typedef struct IPSTACK_T
     }; 
 
     // Payload data
-    uint16_t                            padPL;
+    uint16_t                            sumPayload;                 // ones complement sum of the payload as CopyAndSum returns it; only if fPayloadSummed
     uint16_t                            cbPayload;
     union
     {
@@ -515,11 +520,27 @@ uint32_t TCPPeekIdx(HSOCKET hSocket, uint32_t index, void * pv, uint32_t cb, IPS
 #define TCPPeek(_hSocket, _pv, _cb, _pStatus) TCPPeekIdx(_hSocket, 0, _pv, _cb, _pStatus)
 uint32_t TCPRead(HSOCKET hSocket, void * pv, uint32_t cb, IPSTATUS * pStatus);
 uint32_t TCPWrite(HSOCKET hSocket, const void * pv, uint32_t cbReq, IPSTATUS * pStatus);
+uint32_t TCPWriteExternal(HSOCKET hSocket, const void * pv, uint32_t cbReq, IPSTATUS * pStatus);
+uint32_t TCPExternalUnacked(HSOCKET hSocket);
 void TCPDiscard(HSOCKET hSocket);
 void TCPFlush(HSOCKET hSocket);
+void TCPSetNoDelay(HSOCKET hSocket, bool fNoDelay);
+void TCPSetDelayedAck(HSOCKET hSocket, uint32_t msDelay);
+void TCPSetSendWindow(HSOCKET hSocket, uint32_t cSegments);
 void TCPAbort(HSOCKET hSocket);
 void TCPAbortAllSockets(void);
 
+// TCP transmit counters so send throughput can be measured on the device; clear them to start a measurement
+typedef struct TCPTXSTATS_T
+{
+    uint32_t    cbPayload;          // data bytes put on the wire, retransmits included
+    uint32_t    cSegments;          // data segments put on the wire
+    uint32_t    cRetransmit;        // retransmit timeouts
+    uint32_t    cFastRetransmit;    // fast retransmits on duplicate ACKs
+    uint32_t    tBuild;             // GetSysTick() ticks spent building data segments; the copy out of the socket and the checksum
+} TCPTXSTATS;
+extern TCPTXSTATS g_tcpTxStats;
+
 // DHCP RFC1531, RFC 2131, RFC 1533
 #define DHCPMemSize (sizeof(DHCPMEM))
 bool DHCPInit(const LLADP * pLLAdp, void * rgbDHCPMem, uint32_t cbDHCPMem, HPMGR hPMGR, IPSTATUS * pStatus);
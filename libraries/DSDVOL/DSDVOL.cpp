@@ -106,6 +106,7 @@ int DSDVOL::rcvr_datablock (	/* 1:OK, 0:Failed */
 	UINT btr			/* Byte count (must be multiple of 4) */
 ) {
 	BYTE token;
+	int fOK;
 
 
 	tmsSetTimer(1) = 100;
@@ -118,12 +119,12 @@ int DSDVOL::rcvr_datablock (	/* 1:OK, 0:Failed */
 		return 0;					// If not valid data token, return with error
 	}
 
-	rcvr_spi_multi(buff, btr);		// Read the data block into the buffer
+	fOK = rcvr_spi_multi(buff, btr);	// Read the data block into the buffer
 
 	xchg_spi(0xFF);					// Discard CRC
 	xchg_spi(0xFF);
 
-	return 1;						// Return with success
+	return fOK;						// Return with success, unless the DMA overflowed
 }
 
 /*-----------------------------------------------------------------------*/
@@ -136,6 +137,7 @@ int DSDVOL::xmit_datablock (	/* 1:OK, 0:Failed */
 	BYTE token			/* Data token */
 ) {
 	BYTE resp;
+	int fOK;
 
 
 	if (!wait_ready()) {
@@ -145,11 +147,11 @@ int DSDVOL::xmit_datablock (	/* 1:OK, 0:Failed */
 	xchg_spi(token);					// Xmit the token
 
 	if (token != 0xFD) {				// Not StopTran token
-		xmit_spi_multi(buff, 512);		// Xmit the data block to the MMC
+		fOK = xmit_spi_multi(buff, 512);	// Xmit the data block to the MMC
 		xchg_spi(0xFF);					// CRC (Dummy)
 		xchg_spi(0xFF);
 		resp = xchg_spi(0xFF);			// Receive a data response
-		if ((resp & 0x1F) != 0x05)		// If not accepted, return with error
+		if (!fOK || (resp & 0x1F) != 0x05)	// If not accepted, return with error
 			return 0;
 	}
 
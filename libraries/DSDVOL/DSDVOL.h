@@ -42,6 +42,7 @@
 /*  Revision History:                                                   */
 /*                                                                      */
 /*    10/19/2015(KeithV): Created                                       */
+/*    10/19/2026(KeithV): Block transfers are DMA driven when available */
 /************************************************************************/
 #ifndef _DSDVOL_INCLUDE_
 #define _DSDVOL_INCLUDE_
@@ -120,6 +121,7 @@ class DSDVOL : public DFSVOL
         uint32_t            CardType;
         uint32_t            tBusyStart;         // Diagnostic
         uint32_t            cBusyInARow;        // Diagnostic
+        void                (* pfnYield)(void); // called while a block DMA is in progress
         tmsDefineTimer(1);
         tmsDefineTimer(2);
 
@@ -142,13 +144,22 @@ class DSDVOL : public DFSVOL
         {
             return(dSDspi.transfer(bSnd));
         }
-        void xmit_spi_multi (const uint8_t* buff,	UINT cnt)
+        int wait_dma (void)
         {
+            while(!dSDspi.isDMADone()) if(pfnYield != NULL) pfnYield();
+            return(!dSDspi.isDMAError());
+        }
+        int xmit_spi_multi (const uint8_t* buff,	UINT cnt)
+        {
+            if(dSDspi.dmaTransfer(cnt, (uint8_t *) buff)) return(wait_dma());
             dSDspi.transfer(cnt, (uint8_t *) buff);
+            return(1);
         }
-        void rcvr_spi_multi (uint8_t* buff, uint32_t cnt)
+        int rcvr_spi_multi (uint8_t* buff, uint32_t cnt)
         {
+            if(dSDspi.dmaTransfer(cnt, 0xFF, (uint8_t *) buff)) return(wait_dma());
             dSDspi.transfer(cnt, 0xFF, (uint8_t *) buff);
+            return(1);
         }
         int wait_ready (void);
         void deselect (void);
@@ -162,7 +173,10 @@ class DSDVOL : public DFSVOL
         uint32_t tBusyMax;  // Diagnostics, the maximum busy time, could be as high as 500ms
         uint32_t maxBusyInARow;  // Diagnostics, the maximum in a row busy count
 
-        DSDVOL(DGSPI& dspi) : DFSVOL(0,1), dSDspi(dspi), Stat(STA_NOINIT), tBusyStart(0), cBusyInARow(0), tBusyMax(0), maxBusyInARow(0) {}
+        DSDVOL(DGSPI& dspi) : DFSVOL(0,1), dSDspi(dspi), Stat(STA_NOINIT), tBusyStart(0), cBusyInARow(0), pfnYield(NULL), tBusyMax(0), maxBusyInARow(0) {}
+
+        // while the SPI DMA moves a block, let other work run; it must not touch this volume
+        void setYield(void (* pfn)(void)) { pfnYield = pfn; }
 
         DSTATUS disk_initialize (void);
         DSTATUS disk_status (void);
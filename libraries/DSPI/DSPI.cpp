@@ -19,6 +19,7 @@
 /*	05/27/2013(Claudia Goga) : Added PPS support for PIC32MX1/2			*/
 /*	12/14/2016(Keith Vogel): Digilent owned relicensing                 */
 /*	12/14/2016(Keith Vogel): Modified for the OpenScope                 */
+/*	10/19/2026(Keith Vogel): Added DMA driven asynchronous transfers     */
 /*																		*/
 /************************************************************************/
 
@@ -26,6 +27,8 @@
 /* ------------------------------------------------------------ */
 /*				Include File Definitions						*/
 /* ------------------------------------------------------------ */
+#include	<string.h>
+#include	<sys/kmem.h>
 #include	"DSPI.h"
 
 #if defined(_SPI1CON_ENHBUF_POSITION)
@@ -142,6 +145,7 @@ bool DSPI::begin() {
 void
 DSPI::end() {
 
+	cancelDMATransfer();
 	spi.sxCon.reg = 0;	
 	cbCur = 0;
 }
@@ -703,6 +707,327 @@ DSPI::intTransfer(uint16_t cbReq, uint8_t bPadT, uint8_t * pbRcv) {
 
 }
 
+/* ------------------------------------------------------------ */
+/*					DMA Driven I/O Functions					*/
+/* ------------------------------------------------------------ */
+/***	DSPI::setDMA
+**
+**	Parameters:
+**		pDMATx		- DMA channel to feed the transmit buffer, i.e. &DCH1CON
+**		pDMARx		- DMA channel to drain the receive buffer, i.e. &DCH2CON
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Assigns the DMA channels used by dmaTransfer. Passing NULL
+**		for either channel disables DMA transfers. The transmit
+**		channel may be shared with another peripheral, it is only
+**		taken when it is not enabled.
+*/
+
+void
+DSPI::setDMA(volatile void * pDMATx, volatile void * pDMARx) {
+
+	cancelDMATransfer();
+	pdmaTx = (DMA *) pDMATx;
+	pdmaRx = (DMA *) pDMARx;
+}
+
+/* ------------------------------------------------------------ */
+/***	DSPI::dmaTransfer
+**
+**	Parameters:
+**		cbReq		- number of bytes to transfer
+**		pbSnd		- pointer to buffer of bytes to transmit
+**		pbRcv		- pointer to buffer to receive return bytes
+**
+**	Return Value:
+**		true if the DMA transfer was started, false if the caller
+**		must do a blocking transfer instead
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Starts a DMA transfer and returns immediately. Completion
+**		is polled with isDMADone; pbRcv is not valid until then.
+**		Both DMA channels work out of the bounce buffer, the transmit
+**		channel reading byte n before the receive channel writes it.
+*/
+
+bool
+DSPI::dmaTransfer(uint16_t cbReq, uint8_t * pbSnd, uint8_t * pbRcv) {
+
+	if (!isDMADone() || !_dmaReady(cbReq)) {
+		return(false);
+	}
+
+	memcpy(pbDMA, pbSnd, cbReq);
+	_dmaStart(cbReq, pbRcv);
+
+	return(true);
+}
+
+/* ------------------------------------------------------------ */
+/***	DSPI::dmaTransfer
+**
+**	Parameters:
+**		cbReq		- number of bytes to transfer
+**		pbSnd		- pointer to buffer of bytes to transmit
+**
+**	Return Value:
+**		true if the DMA transfer was started
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Starts a DMA transfer where the received bytes are discarded.
+**		pbSnd is copied, so it may be reused as soon as this returns.
+*/
+
+bool
+DSPI::dmaTransfer(uint16_t cbReq, uint8_t * pbSnd) {
+
+	if (!isDMADone() || !_dmaReady(cbReq)) {
+		return(false);
+	}
+
+	memcpy(pbDMA, pbSnd, cbReq);
+	_dmaStart(cbReq, NULL);
+
+	return(true);
+}
+
+/* ------------------------------------------------------------ */
+/***	DSPI::dmaTransfer
+**
+**	Parameters:
+**		cbReq		- number of bytes to receive
+**		bPadT		- pad byte to send to the slave device
+**		pbRcv		- pointer to buffer to receive returned bytes
+**
+**	Return Value:
+**		true if the DMA transfer was started
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Starts a DMA transfer where the pad byte is sent to the
+**		slave to clock in the returned bytes.
+*/
+
+bool
+DSPI::dmaTransfer(uint16_t cbReq, uint8_t bPadT, uint8_t * pbRcv) {
+
+	if (!isDMADone() || !_dmaReady(cbReq)) {
+		return(false);
+	}
+
+	memset(pbDMA, bPadT, cbReq);
+	_dmaStart(cbReq, pbRcv);
+
+	return(true);
+}
+
+/* ------------------------------------------------------------ */
+/***	DSPI::isDMADone
+**
+**	Parameters:
+**		none
+**
+**	Return Value:
+**		true if no DMA transfer is in progress
+**
+**	Errors:
+**		isDMAError is set if the receive buffer overflowed
+**
+**	Description:
+**		Polls for DMA completion; this is intended to be called
+**		from the main loop. When the receive channel has moved
+**		the last byte, the bounce buffer is copied to the caller's
+**		receive buffer and the SPI is returned to blocking use.
+*/
+
+bool
+DSPI::isDMADone() {
+
+	if (cbDMA == 0) {
+		return(true);
+	}
+
+	/* The Rx channel disables itself on block completion, and
+	** it always finishes after the Tx channel.
+	*/
+	if (pdmaRx->con.CHEN) {
+		return(false);
+	}
+
+	if ((spi.sxStat.reg & _SPI2STAT_SPIROV_MASK) != 0) {
+		fDMAErr = 1;
+		spi.sxStat.clr = _SPI2STAT_SPIROV_MASK;
+	}
+
+	if (pbDMARcv != NULL) {
+		memcpy(pbDMARcv, pbDMA, cbDMA);
+	}
+
+	regIF.clr = bitRx + bitTx;
+	cbDMA = 0;
+
+	return(true);
+}
+
+/* ------------------------------------------------------------ */
+/***	DSPI::cancelDMATransfer
+**
+**	Parameters:
+**		none
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Aborts a DMA transfer in progress. The receive buffer is
+**		not updated. It is still the caller's responsibility to drive
+**		SS high to release the slave device.
+*/
+
+void
+DSPI::cancelDMATransfer() {
+
+	volatile uint8_t		bTmp;   // volatile to make sure optimizer does not remove instruction
+
+	if (cbDMA == 0) {
+		return;
+	}
+
+	pdmaTx->conClr = _DCH0CON_CHEN_MASK;
+	pdmaRx->conClr = _DCH0CON_CHEN_MASK;
+	while (pdmaTx->con.CHBUSY || pdmaRx->con.CHBUSY) {
+	}
+
+	/* Let the last byte shift out, then clear the receive buffer.
+	*/
+	while ((spi.sxStat.reg & _SPI2STAT_SPIBUSY_MASK) != 0) {
+	}
+	bTmp = spi.sxBuf.reg;
+    (void) bTmp;    // suppress unused variable complier warning
+
+	spi.sxStat.clr = _SPI2STAT_SPIROV_MASK;
+	regIF.clr = bitErr + bitRx + bitTx;
+	cbDMA = 0;
+}
+
+/* ------------------------------------------------------------ */
+/***	DSPI::_dmaReady
+**
+**	Parameters:
+**		cbReq		- number of bytes to transfer
+**
+**	Return Value:
+**		true if a DMA transfer of cbReq bytes can be started
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		We need both channels, the transfer must fit in the bounce
+**		buffer, and since the Tx channel may be shared we only take
+**		it if nobody else has it enabled.
+*/
+
+bool
+DSPI::_dmaReady(uint16_t cbReq) {
+
+	return(pdmaTx != NULL && pdmaRx != NULL && cbReq > 0 && cbReq <= cbDMAMax &&
+		   !pdmaTx->con.CHEN && !pdmaRx->con.CHEN);
+}
+
+/* ------------------------------------------------------------ */
+/***	DSPI::_dmaStart
+**
+**	Parameters:
+**		cbReq		- number of bytes to transfer, already in the bounce buffer
+**		pbRcv		- where to copy the received bytes, NULL to discard
+**
+**	Return Value:
+**		none
+**
+**	Errors:
+**		none
+**
+**	Description:
+**		Programs both DMA channels off of the SPI IRQs and lets
+**		them run. The SPI must be in standard (non-enhanced) buffer
+**		mode so the Tx IRQ fires on an empty transmit buffer and
+**		the Rx IRQ on a full receive buffer.
+*/
+
+void
+DSPI::_dmaStart(uint16_t cbReq, uint8_t * pbRcv) {
+
+	volatile uint8_t		bTmp;   // volatile to make sure optimizer does not remove instruction
+
+	cbDMA		= cbReq;
+	pbDMARcv	= pbRcv;
+	fDMAErr		= 0;
+
+	/* Start with an empty receive buffer and no stale IRQs.
+	*/
+#ifdef ENH_BUFFER
+	spi.sxCon.clr = 1<<ENH_BUFFER;
+#endif
+	bTmp = spi.sxBuf.reg;
+    (void) bTmp;    // suppress unused variable complier warning
+	spi.sxStat.clr = _SPI2STAT_SPIROV_MASK;
+	regIF.clr = bitErr + bitRx + bitTx;
+
+	/* The Rx channel drains SPIxBUF into the bounce buffer. It runs
+	** at a higher priority than the Tx channel so it can never
+	** fall behind and overflow the receive buffer.
+	*/
+	pdmaRx->conClr		= 0xFFFFFFFF;
+	pdmaRx->econClr		= 0xFFFFFFFF;
+	pdmaRx->intrClr		= 0xFFFFFFFF;
+	pdmaRx->con.CHPRI	= 1;
+	pdmaRx->econ.CHSIRQ	= irqRx;
+	pdmaRx->econ.SIRQEN	= 1;
+	pdmaRx->ssa			= _KVA2PA((void *) &spi.sxBuf.reg);
+	pdmaRx->ssiz		= 1;
+	pdmaRx->dsa			= _KVA2PA(pbDMA);
+	pdmaRx->dsiz		= cbReq;
+	pdmaRx->csiz		= 1;
+
+	/* The Tx channel feeds SPIxBUF from the bounce buffer.
+	*/
+	pdmaTx->conClr		= 0xFFFFFFFF;
+	pdmaTx->econClr		= 0xFFFFFFFF;
+	pdmaTx->intrClr		= 0xFFFFFFFF;
+	pdmaTx->con.CHPRI	= 0;
+	pdmaTx->econ.CHSIRQ	= irqTx;
+	pdmaTx->econ.SIRQEN	= 1;
+	pdmaTx->ssa			= _KVA2PA(pbDMA);
+	pdmaTx->ssiz		= cbReq;
+	pdmaTx->dsa			= _KVA2PA((void *) &spi.sxBuf.reg);
+	pdmaTx->dsiz		= 1;
+	pdmaTx->csiz		= 1;
+
+	/* Receive first so it is ready for the first byte, the empty
+	** transmit buffer will then trigger the Tx channel.
+	*/
+	pdmaRx->con.CHEN	= 1;
+	pdmaTx->con.CHEN	= 1;
+}
+
 /* ------------------------------------------------------------ */
 /***	DSPI::isr
 **
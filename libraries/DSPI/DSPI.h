@@ -12,6 +12,7 @@
 /*	05/27/2013(ClaudiaGoga): added PPS support for PIC32MX1 and PIC32MX2*/
 /*	12/14/2016(Keith Vogel): Digilent owned relicensing                 */
 /*	12/14/2016(Keith Vogel): Modified for the OpenScope                 */
+/*	10/19/2026(Keith Vogel): Added DMA driven asynchronous transfers     */
 /*																		*/
 /************************************************************************/
 
@@ -132,6 +133,14 @@ class DGSPI
         virtual void        transfer(uint16_t cbReq, uint8_t * pbSnd, uint8_t * pbRcv) = 0;
         virtual void        transfer(uint16_t cbReq, uint8_t * pbSnd) = 0;
         virtual void        transfer(uint16_t cbReq, uint8_t bPad, uint8_t * pbRcv) = 0;
+
+        // DMA transfer functions; by default there is no DMA and the
+        // caller is expected to fall back to the blocking transfers
+        virtual bool        dmaTransfer(uint16_t cbReq, uint8_t * pbSnd, uint8_t * pbRcv) { return(false); }
+        virtual bool        dmaTransfer(uint16_t cbReq, uint8_t * pbSnd) { return(false); }
+        virtual bool        dmaTransfer(uint16_t cbReq, uint8_t bPad, uint8_t * pbRcv) { return(false); }
+        virtual bool        isDMADone() { return(true); }
+        virtual bool        isDMAError() { return(false); }
 };
 
 
@@ -166,6 +175,69 @@ private:
         volatile REG sxBrg;
     } SPI;
 
+    typedef struct _DMA
+    {
+        volatile __DCH0CONbits_t con;
+        volatile uint32_t conClr;
+        volatile uint32_t conSet;
+        volatile uint32_t conInv;
+
+        volatile __DCH0ECONbits_t econ;
+        volatile uint32_t econClr;
+        volatile uint32_t econSet;
+        volatile uint32_t econInv;
+
+        volatile __DCH0INTbits_t intr;
+        volatile uint32_t intrClr;
+        volatile uint32_t intrSet;
+        volatile uint32_t intrInv;
+
+        volatile uint32_t ssa;
+        volatile uint32_t ssaClr;
+        volatile uint32_t ssaSet;
+        volatile uint32_t ssaInv;
+
+        volatile uint32_t dsa;
+        volatile uint32_t dsaClr;
+        volatile uint32_t dsaSet;
+        volatile uint32_t dsaInv;
+
+        volatile uint32_t ssiz;
+        volatile uint32_t ssizClr;
+        volatile uint32_t ssizSet;
+        volatile uint32_t ssizInv;
+
+        volatile uint32_t dsiz;
+        volatile uint32_t dsizClr;
+        volatile uint32_t dsizSet;
+        volatile uint32_t dsizInv;
+
+        volatile uint32_t sptr;
+        volatile uint32_t sptrClr;
+        volatile uint32_t sptrSet;
+        volatile uint32_t sptrInv;
+
+        volatile uint32_t dptr;
+        volatile uint32_t dptrClr;
+        volatile uint32_t dptrSet;
+        volatile uint32_t dptrInv;
+
+        volatile uint32_t csiz;
+        volatile uint32_t csizClr;
+        volatile uint32_t csizSet;
+        volatile uint32_t csizInv;
+
+        volatile uint32_t cptr;
+        volatile uint32_t cptrClr;
+        volatile uint32_t cptrSet;
+        volatile uint32_t cptrInv;
+
+        volatile uint32_t dat;
+        volatile uint32_t datClr;
+        volatile uint32_t datSet;
+        volatile uint32_t datInv;
+    } DMA;
+
     typedef union _IPC {
         struct {
         unsigned subPriority:2;
@@ -197,6 +269,24 @@ private:
     uint32_t            storedBrg;  // Previous baud rate before a setSpeed
     uint32_t            storedMode; // Previous mode before a setMode
 
+    // DMA transfers; the DMA runs out of a non-cached bounce buffer
+    // so the caller's buffer may live anywhere, including the stack.
+    static uint32_t const cbDMAMax = 512;   // one SD sector, largest DMA transfer
+    uint8_t const       irqRx;      // SPI receive IRQ, triggers the Rx DMA
+    uint8_t const       irqTx;      // SPI transmit IRQ, triggers the Tx DMA
+    volatile DMA *      pdmaTx;     // Tx DMA channel, may be shared, only used when idle
+    volatile DMA *      pdmaRx;     // Rx DMA channel
+    uint8_t *           pbDMARcv;   // where to copy the received bytes on completion
+    uint16_t            cbDMA;      // size of the DMA transfer in progress, 0 if none
+    uint8_t				fDMAErr;	// receive overflow during the DMA transfer
+    // cache line aligned so no cached member shares a line with it; a write back of
+    // such a line would overwrite what the DMA just put in the buffer
+    uint8_t             __attribute__((aligned(16), coherent)) _rgbDMA[cbDMAMax];  // bounce buffer, only accessed thru pbDMA
+    uint8_t *           pbDMA;      // KSEG1 (non-cached) pointer to the bounce buffer
+
+    bool        _dmaReady(uint16_t cbReq);
+    void        _dmaStart(uint16_t cbReq, uint8_t * pbRcv);
+
     // this are really #defines in the name space of the class
     static int const high = 1;
     static int const low = 0;
@@ -220,7 +310,9 @@ public:
         vecFault(vecErr), vecPri(pri),
         regIE(*(((REG *) &IEC0) + (irqErr / 32))),
         regIF(*(((REG *) &IFS0) + (irqErr / 32))),
-        bitErr(1 << (irqErr % 32)), bitRx(bitErr << 1), bitTx(bitErr << 2)
+        bitErr(1 << (irqErr % 32)), bitRx(bitErr << 1), bitTx(bitErr << 2),
+        irqRx(irqErr + 1), irqTx(irqErr + 2), pdmaTx(NULL), pdmaRx(NULL), pbDMARcv(NULL), cbDMA(0), fDMAErr(0),
+        pbDMA((uint8_t *) (((uint32_t) _rgbDMA) | 0xA0000000))
     {
     }
 
@@ -253,6 +345,15 @@ public:
     int			isOverflow() { return fRov; };
     void		clearOverflow() { fRov = 0; };
 
+    // DMA driven asynchronous I/O functions
+    void        setDMA(volatile void * pDMATx, volatile void * pDMARx);
+    bool        dmaTransfer(uint16_t cbReq, uint8_t * pbSnd, uint8_t * pbRcv);
+    bool        dmaTransfer(uint16_t cbReq, uint8_t * pbSnd);
+    bool        dmaTransfer(uint16_t cbReq, uint8_t bPadT, uint8_t * pbRcv);
+    bool        isDMADone();
+    bool        isDMAError() { return(fDMAErr != 0); };
+    void        cancelDMATransfer();
+
     // the ISR routine
 	void	isr();
 };
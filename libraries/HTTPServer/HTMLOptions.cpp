@@ -52,7 +52,9 @@ static const char szOptions[] =
 "HTTP/1.1 200 OK\r\n\
 Access-Control-Allow-Origin: *\r\n\
 Access-Control-Allow-Headers: Content-Type\r\n\
-Access-Control-Max-Age: 86400\r\n\r\n\
+Access-Control-Max-Age: 86400\r\n\
+Content-Length: 52\r\n\
+Connection: keep-alive\r\n\r\n\
 <body>\r\n\
 Options Response Successful\r\n\
 <br>\r\n\
@@ -66,7 +68,7 @@ Options Response Successful\r\n\
  *    Return Values:
  *          GCMD::ACTION    - GCMD::CONTINUE, just return with no outside action
  *                          - GCMD::READ, non-blocking read of input data into the rgbIn buffer appended to the end of cbRead
- *                          - GCMD::GETLINE, blocking read until a line of input is read or until the rgbIn buffer is full, always the line starts at the beginnig of the rgbIn
+ *                          - GCMD::GETLINE, blocking read until a line of input is read or until the rgbIn buffer is full, the line is at szLine
  *                          - GCMD::WRITE, loop writing until all cbWrite bytes are written from the pbOut buffer
  *                          - GCMD::DONE, we are done processing and the connection can be closed
  *
@@ -84,6 +86,7 @@ GCMD::ACTION ComposeHTMLOptions(CLIENTINFO * pClientInfo)
             pClientInfo->cbWrite = sizeof(szOptions)-1;
             pClientInfo->pbOut = (uint8_t * const) szOptions;
             pClientInfo->htmlState = HTTPDISCONNECT;
+            pClientInfo->fKeepAlive = true;
             return(GCMD::WRITE);
             break;
 
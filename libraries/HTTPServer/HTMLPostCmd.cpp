@@ -11,6 +11,11 @@
 /************************************************************************/
 /*  Revision History:                                                   */
 /*    7/24/2013(KeithV): Created                                         */
+/*    10/19/2026(KeithV): Refill binary uploads straight from the socket */
+/*    10/19/2026(KeithV): Each client gets its own parser               */
+/*    10/19/2026(KeithV): Lex the body in place after the header        */
+/*    10/19/2026(KeithV): Pin locked instrument buffers for output      */
+/*    10/19/2026(KeithV): Leave a pipelined request after the body      */
 /************************************************************************/
 #include <OpenScope.h>
 
@@ -19,13 +24,23 @@
 /************************************************************************/
 static const char szContentLength[] = "Content-Length: ";
 
+// while binary is streaming, how many socket reads we take in one pass
+#define CBINARYREFILLS      16
+
 /************************************************************************/
 /*    Static local variables                                            */
 /************************************************************************/
-static CLIENTINFO *     pClientMutex        = NULL;
-static uint32_t         cbTotal             = 0;
-static uint32_t         cbContentLength     = 0;
-static bool             fFirstWrite         = true;
+// one per parser; a client holds one from HTTPSTART until it disconnects
+typedef struct
+{
+    CLIENTINFO *    pClientInfo;
+    OSPAR *         pOSPar;
+    uint32_t        cbTotal;
+    uint32_t        cbContentLength;
+    bool            fFirstWrite;
+} POSTCTX;
+
+static POSTCTX          rgPostCtx[COSPAR];
 
 /************************************************************************/
 /*    State machine states                                              */
@@ -49,7 +64,7 @@ typedef enum {
  *    Return Values:
  *          GCMD::ACTION    - GCMD::CONTINUE, just return with no outside action
  *                          - GCMD::READ, non-blocking read of input data into the rgbIn buffer appended to the end of cbRead
- *                          - GCMD::GETLINE, blocking read until a line of input is read or until the rgbIn buffer is full, always the line starts at the beginnig of the rgbIn
+ *                          - GCMD::GETLINE, blocking read until a line of input is read or until the rgbIn buffer is full, the line is at szLine
  *                          - GCMD::WRITE, loop writing until all cbWrite bytes are written from the pbOut buffer
  *                          - GCMD::DONE, we are done processing and the connection can be closed
  *
@@ -60,21 +75,50 @@ typedef enum {
  * ------------------------------------------------------------ */
 GCMD::ACTION ComposeHTMLPostCmd(CLIENTINFO * pClientInfo)
 {
-   GCMD::ACTION retCMD = GCMD::CONTINUE;
+    GCMD::ACTION    retCMD  = GCMD::CONTINUE;
+    POSTCTX *       pCtx    = NULL;
+    OSPAR *         pOSPar  = NULL;
+
+    // find our parser, if we have one
+    for(uint32_t i = 0; i < COSPAR; i++)
+    {
+        if(rgPostCtx[i].pClientInfo == pClientInfo)
+        {
+            pCtx    = &rgPostCtx[i];
+            pOSPar  = pCtx->pOSPar;
+            break;
+        }
+    }
 
     switch(pClientInfo->htmlState)
     {
          case HTTPSTART:
                          
-            // absolutely critical that we don't process 2 JSON commands concurrently
-            // so much interaction between the states and the datastructures that new
-            // information can not be added inbetween the states.
-            if(pClientMutex != NULL || oslex.fLocked)
+            // each client gets its own parser, the parsers take turns in ParseToken.
+            // Take the last free one, the serial port only uses the first
+            for(int32_t i = COSPAR-1; i >= 0 && pCtx == NULL; i--)
+            {
+                if(!rgOSPar[i].fLocked)
+                {
+                    for(uint32_t j = 0; j < COSPAR; j++)
+                    {
+                        if(rgPostCtx[j].pClientInfo == NULL)
+                        {
+                            pCtx                = &rgPostCtx[j];
+                            pCtx->pClientInfo   = pClientInfo;
+                            pCtx->pOSPar        = &rgOSPar[i];
+                            pCtx->pOSPar->fLocked = true;
+                            break;
+                        }
+                    }
+                }
+            }
+
+            // all parsers are busy, wait for one
+            if(pCtx == NULL)
             {
                 break;
             }
-            pClientMutex = pClientInfo;
-            oslex.fLocked = true;
 
             Serial.println("JSON Post Detected");
             pClientInfo->htmlState = CONTLEN;
@@ -93,16 +137,16 @@ GCMD::ACTION ComposeHTMLPostCmd(CLIENTINFO * pClientInfo)
             // File not found is probably the wrong error, but it does get out out
             // Fortunately all major browsers put in the content lenght, so this
             // will almost never fail.
-            if(strlen((char *) pClientInfo->rgbIn) == 0)    // cbRead may be longer than just the line, so do a strlen()
+            if(pClientInfo->szLine[0] == '\0')
             {
                 pClientInfo->htmlState = JMPFILENOTFOUND;
                 retCMD = GCMD::CONTINUE;
             }
 
             // found the content lengths
-            else if(strncasecmp(szContentLength, (char *) pClientInfo->rgbIn, sizeof(szContentLength)-1) == 0)
+            else if(strncasecmp(szContentLength, pClientInfo->szLine, sizeof(szContentLength)-1) == 0)
             {
-                cbContentLength = atoi((char *) &pClientInfo->rgbIn[sizeof(szContentLength)-1]);
+                pCtx->cbContentLength = atoi(&pClientInfo->szLine[sizeof(szContentLength)-1]);
                 pClientInfo->htmlState = ENDHDR;
             }
             break;
@@ -111,25 +155,20 @@ GCMD::ACTION ComposeHTMLPostCmd(CLIENTINFO * pClientInfo)
 
             // the header is ended with a double \r\n\r\n, so I will get
             // a zero length line. Just keep reading lines until we get to the blank line
-            if(strlen((char *) pClientInfo->rgbIn) == 0)    // cbRead may be longer than just the line, so do a strlen()
+            if(pClientInfo->szLine[0] == '\0')
             {
-                uint32_t i = 0;
-
-                // go to beyond the \0
-                for(i = 0; i < pClientInfo->cbRead && pClientInfo->rgbIn[i] == '\0'; i++);
+                // the body starts right after the blank line, at cbParsed; it is lexed from there
 
-                // move the buffer to the front
-                pClientInfo->cbRead -= i;
-                if(pClientInfo->cbRead > 0)
+                // if there is nothing left in the buffer, read some in
+                if(pClientInfo->cbParsed == pClientInfo->cbRead)
                 {
-                    memcpy(pClientInfo->rgbIn, &pClientInfo->rgbIn[i], pClientInfo->cbRead);
+                    pClientInfo->cbRead     = 0;
+                    pClientInfo->cbParsed   = 0;
+                    retCMD = GCMD::READ;
                 }
 
-                // if there is nothing left in the buffer, read some in
-                else retCMD = GCMD::READ;
-
                 // no content, just exit
-                if(cbContentLength == 0)
+                if(pCtx->cbContentLength == 0)
                 {
                     pClientInfo->htmlState = HTTPDISCONNECT;
                 }
@@ -137,10 +176,9 @@ GCMD::ACTION ComposeHTMLPostCmd(CLIENTINFO * pClientInfo)
                 else
                 {
                     // get ready for lexing
-                    oslex.Init(OSPAR::ICDStart);
-                    oslex.fLocked = true;
-                    cbTotal = 0;
-                    fFirstWrite = true;
+                    pOSPar->Init(OSPAR::ICDStart);
+                    pCtx->cbTotal = 0;
+                    pCtx->fFirstWrite = true;
                     pClientInfo->cbWrite = 0;
                     pClientInfo->htmlState = JSONLEX;
                 }
@@ -152,69 +190,95 @@ GCMD::ACTION ComposeHTMLPostCmd(CLIENTINFO * pClientInfo)
             break;
 
         case JSONLEX:
-
-            switch(oslex.StreamOS((const char *) pClientInfo->rgbIn, pClientInfo->cbRead))
             {
+                GCMD::ACTION    action  = GCMD::CONTINUE;
+                uint32_t        cRefill = 0;
+                uint32_t        cbLex   = 0;
 
-                case GCMD::READ:
-
-                    // add this to the total processed
-                    cbTotal += pClientInfo->cbRead;
+                // only the body goes to the lexer, a pipelined request after it is left in rgbIn for the next pass
+                // once the whole body is in, the lexer gets 0 bytes telling it there is no more
+                if(pCtx->cbTotal < pCtx->cbContentLength)
+                {
+                    cbLex = min(pClientInfo->cbRead - pClientInfo->cbParsed, pCtx->cbContentLength - pCtx->cbTotal);
+                }
 
-                    // is this all we are going to get
-                    if(cbTotal >= cbContentLength) 
-                    {
-                        // setting this to 0 will tell the lexer there is no more
-                        pClientInfo->cbRead = 0;
-                    }
+                // while the binary part of an upload is streaming to its writer, refill from the socket right here
+                // rather than going through READINPUT and around the main loop for every buffer full
+                while((action = pOSPar->StreamOS((const char *) &pClientInfo->rgbIn[pClientInfo->cbParsed], cbLex)) == GCMD::READ &&
+                        pOSPar->IsReadingBinary()                                                                       &&
+                        cRefill < CBINARYREFILLS                                                                        &&
+                        (pCtx->cbTotal + cbLex) < pCtx->cbContentLength                                                 &&
+                        pClientInfo->pTCPClient->available() > 0                                                        )
+                {
+                    pCtx->cbTotal += cbLex;
+                    pClientInfo->cbRead = pClientInfo->pTCPClient->readStream(pClientInfo->rgbIn, sizeof(pClientInfo->rgbIn));
+                    pClientInfo->cbParsed = 0;
+                    cbLex = min(pClientInfo->cbRead, pCtx->cbContentLength - pCtx->cbTotal);
+                    cRefill++;
+                }
 
-                    // otherwise get some more
-                    else
-                    {
-                        pClientInfo->cbRead = 0;
-                        retCMD = GCMD::READ;
-                    }
-                    break;
+                switch(action)
+                {
 
-                case GCMD::WRITE:
-                    if(fFirstWrite)
-                    {
-                        fFirstWrite = false;
-                        pClientInfo->htmlState = WRITEHTTP;
+                    case GCMD::READ:
+
+                        // add this to the total processed
+                        pCtx->cbTotal += cbLex;
+                        pClientInfo->cbParsed += cbLex;
+
+                        // if there is more body, get some more
+                        // otherwise anything after the body stays in rgbIn
+                        if(pCtx->cbTotal < pCtx->cbContentLength) 
+                        {
+                            pClientInfo->cbRead = 0;
+                            pClientInfo->cbParsed = 0;
+                            retCMD = GCMD::READ;
+                        }
+                        break;
+
+                    case GCMD::WRITE:
+                        if(pCtx->fFirstWrite)
+                        {
+                            pCtx->fFirstWrite = false;
+                            pClientInfo->htmlState = WRITEHTTP;
+                            retCMD = GCMD::CONTINUE;
+                        }
+                        else
+                        {
+                            pClientInfo->cbWrite    = pOSPar->cbOutput;
+                            pClientInfo->pbOut      = pOSPar->pbOutput;
+                            pClientInfo->fPinOut    = pOSPar->IsOutputPinned();
+                            retCMD = GCMD::WRITE;
+                        }
+
+                        break;
+
+                    case GCMD::DONE:
+                        // we are done, go put out the response
+                        // everything went out with a content length, so the connection can be reused
+                        pClientInfo->fKeepAlive = true;
+                        pCtx->fFirstWrite = true;
+                        pClientInfo->htmlState = HTTPDISCONNECT;
                         retCMD = GCMD::CONTINUE;
-                    }
-                    else
-                    {
-                        pClientInfo->cbWrite    = oslex.cbOutput;
-                        pClientInfo->pbOut      = oslex.pbOutput;
-                        retCMD = GCMD::WRITE;
-                    }
-
-                    break;
+                        break;
 
-                case GCMD::DONE:
-                    // we are done, go put out the response
-                    fFirstWrite = true;
-                    pClientInfo->htmlState = HTTPDISCONNECT;
-                    retCMD = GCMD::CONTINUE;
-                    break;
-
-                case GCMD::CONTINUE:
-                    retCMD = GCMD::CONTINUE;
-                    break;
+                    case GCMD::CONTINUE:
+                        retCMD = GCMD::CONTINUE;
+                        break;
 
-                // never should get this
-                default:
-                    ASSERT(NEVER_SHOULD_GET_HERE); 
-                    break;
+                    // never should get this
+                    default:
+                        ASSERT(NEVER_SHOULD_GET_HERE); 
+                        break;
 
+                }
             }
             break;
 
         case WRITEHTTP:
 
             // if there is binary to write out.
-            if(oslex.cOData > 1)
+            if(pOSPar->cOData > 1)
             {
                 uint32_t cbT = 0;
                 uint32_t cb = 0;
@@ -225,11 +289,11 @@ GCMD::ACTION ComposeHTMLPostCmd(CLIENTINFO * pClientInfo)
                 // the chunk sizes (in hex), plus \r\n
 
                 // sum up all of the blocks
-                for(i=0; i<oslex.cOData; i++) cbT += oslex.odata[i].cb;
+                for(i=0; i<pOSPar->cOData; i++) cbT += pOSPar->odata[i].cb;
 
                 // The first chunk is the JSON, the second chunk is the rest of the binary
                 // do the binary first, because cbT has the sum of all parts
-                cb = cbT -  oslex.odata[0].cb;
+                cb = cbT -  pOSPar->odata[0].cb;
 
                 // now see how many digits it has, base 16
                 for(i=0; cb>0; i++,cb>>=4);
@@ -237,7 +301,7 @@ GCMD::ACTION ComposeHTMLPostCmd(CLIENTINFO * pClientInfo)
                 cbT += i;
 
                 // now do for the first chunk, the JSON chunk
-                cb = oslex.odata[0].cb;
+                cb = pOSPar->odata[0].cb;
                 for(i=0; cb>0; i++,cb>>=4);
                 if(i==0) i = 1; // this should never happen
                 cbT += i;
@@ -250,7 +314,7 @@ GCMD::ACTION ComposeHTMLPostCmd(CLIENTINFO * pClientInfo)
                 cbT += 13;
 
                 // create the header
-                pClientInfo->cbWrite  = BuildHTTPOKStr(true, cbT, ".osjb", (char *) pClientInfo->rgbScratch, sizeof(pClientInfo->rgbScratch));
+                pClientInfo->cbWrite  = BuildHTTPOKStr(true, true, cbT, ".osjb", (char *) pClientInfo->rgbScratch, sizeof(pClientInfo->rgbScratch));
 
                 // push this out on the network the header and JSON count
                 pClientInfo->pbOut = pClientInfo->rgbScratch;
@@ -259,7 +323,7 @@ GCMD::ACTION ComposeHTMLPostCmd(CLIENTINFO * pClientInfo)
             // no binary, just JSON
             else
             {
-                pClientInfo->cbWrite = BuildHTTPOKStr(true, oslex.odata[0].cb, ".json", (char *) pClientInfo->rgbScratch, sizeof(pClientInfo->rgbScratch));
+                pClientInfo->cbWrite = BuildHTTPOKStr(true, true, pOSPar->odata[0].cb, ".json", (char *) pClientInfo->rgbScratch, sizeof(pClientInfo->rgbScratch));
                 pClientInfo->pbOut = pClientInfo->rgbScratch;
             }
 
@@ -270,8 +334,8 @@ GCMD::ACTION ComposeHTMLPostCmd(CLIENTINFO * pClientInfo)
         case WRITEJSON:
 
             // Put out what came back for LEX and return there 
-            pClientInfo->cbWrite    = oslex.cbOutput;
-            pClientInfo->pbOut      = oslex.pbOutput;
+            pClientInfo->cbWrite    = pOSPar->cbOutput;
+            pClientInfo->pbOut      = pOSPar->pbOutput;
             retCMD = GCMD::WRITE;
 
             pClientInfo->htmlState = JSONLEX;
@@ -283,8 +347,8 @@ GCMD::ACTION ComposeHTMLPostCmd(CLIENTINFO * pClientInfo)
         case JMPFILENOTFOUND:
 
             Serial.println("Jumping to HTTP File Not Found page");
-            pClientMutex = NULL;
-            oslex.Init(OSPAR::ICDEnd);
+            pOSPar->Init(OSPAR::ICDEnd);
+            pCtx->pClientInfo = NULL;
             return(JumpToComposeHTMLPage(pClientInfo, ComposeHTTP404Error));
             break;
 
@@ -296,28 +360,28 @@ GCMD::ACTION ComposeHTMLPostCmd(CLIENTINFO * pClientInfo)
 
         case HTTPDISCONNECT:
 
-            if(pClientMutex == pClientInfo)
+            if(pCtx != NULL)
             {
                 int32_t i;
                 
-                for(i=0; i<oslex.cOData; i++)
+                for(i=0; i<pOSPar->cOData; i++)
                 {
-                    if(oslex.odata[i].pLockState != NULL && *oslex.odata[i].pLockState == LOCKOutput)
+                    if(pOSPar->odata[i].pLockState != NULL && *pOSPar->odata[i].pLockState == LOCKOutput)
                     {
-                        *oslex.odata[i].pLockState = LOCKAvailable;
+                        *pOSPar->odata[i].pLockState = LOCKAvailable;
                     }
                 }
 
-                // we are no longer parsing JSON
-                oslex.Init(OSPAR::ICDEnd);
+                // we are no longer parsing JSON, this frees the parser
+                pOSPar->Init(OSPAR::ICDEnd);
 
                 if(pjcmd.trigger.state.parsing == JSPARTrgRead) 
                 {
                     pjcmd.trigger.state.parsing = JSPARTrgTriggered;
                 }
                 Serial.print("Closing Client ID: 0x");
-                Serial.println((uint32_t) pClientMutex, 16);
-                pClientMutex = NULL;
+                Serial.println((uint32_t) pClientInfo, 16);
+                pCtx->pClientInfo = NULL;
             }
             // fall thru Done
 
@@ -73,7 +73,7 @@ typedef enum {
  *    Return Values:
  *          GCMD::ACTION    - GCMD::CONTINUE, just return with no outside action
  *                          - GCMD::READ, non-blocking read of input data into the rgbIn buffer appended to the end of cbRead
- *                          - GCMD::GETLINE, blocking read until a line of input is read or until the rgbIn buffer is full, always the line starts at the beginnig of the rgbIn
+ *                          - GCMD::GETLINE, blocking read until a line of input is read or until the rgbIn buffer is full, the line is at szLine
  *                          - GCMD::WRITE, loop writing until all cbWrite bytes are written from the pbOut buffer
  *                          - GCMD::DONE, we are done processing and the connection can be closed
  *
@@ -91,7 +91,7 @@ GCMD::ACTION ComposeHTMLRebootPage(CLIENTINFO * pClientInfo)
     {
          case HTTPSTART:
             Serial.println("Reboot Request Detected");
-            pClientInfo->cbWrite = BuildHTTPOKStr(true, sizeof(szReboot)-1, ".htm", (char *) pClientInfo->rgbScratch, sizeof(pClientInfo->rgbScratch));
+            pClientInfo->cbWrite = BuildHTTPOKStr(true, false, sizeof(szReboot)-1, ".htm", (char *) pClientInfo->rgbScratch, sizeof(pClientInfo->rgbScratch));
             pClientInfo->pbOut = pClientInfo->rgbScratch;
             pClientInfo->htmlState = WRITECONTENT;
             break;
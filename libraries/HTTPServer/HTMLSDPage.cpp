@@ -43,29 +43,54 @@
 /************************************************************************/
 /*  Revision History:                                                   */
 /*    7/19/2013(KeithV): Created                                         */
+/*    10/19/2026(KeithV): Serve .gz siblings, ETag and 304 Not Modified */
 /************************************************************************/
 #include <OpenScope.h>
 
 extern GCMD::ACTION ComposeHTMLRedirectPage(CLIENTINFO * pClientInfo);
 
+#define CBETAG              32      // room for "dateTime-size-gz" in hex
+#define CBHTTPDATE          32      // "Sun, 06 Nov 1994 08:49:37 GMT"
+
 static DFILE    dFile;              // Create a File handle to use to open files with
 static const char * szFileName      = NULL;
 static CLIENTINFO * pClientMutex    = NULL;
 static uint32_t     cbSent          = 0;
 static uint32_t     tStart          = 0;
+static bool         fAcceptGzip     = false;    // the client sent Accept-Encoding: gzip
+static bool         fGzip           = false;    // we opened the .gz sibling
+static char         szFile[MAX_PATH+4];         // the file name, with room to put .gz on the end
+static char         szIfNoneMatch[CBETAG+16];   // what the client sent in If-None-Match, empty if nothing
+static char         szETag[CBETAG];
+static char         szLastModified[CBHTTPDATE];
 
 /************************************************************************/
 /*    HTML Strings                                                      */
 /************************************************************************/
 static const char szEndOfURL[] = " HTTP";
 static const char szGET[] = "GET /";
+static const char szGzExt[] = ".gz";
+static const char szAcceptEncoding[] = "Accept-Encoding:";
+static const char szGzip[] = "gzip";
+static const char szIfNoneMatchHdr[] = "If-None-Match:";
+static const char szHTTPNotModified[] = "HTTP/1.1 304 Not Modified\r\nConnection: keep-alive\r\nCache-Control: no-cache\r\n";
+static const char szContentEncodingGzip[] = "Content-Encoding: gzip\r\n";
+static const char szVaryAcceptEncoding[] = "Vary: Accept-Encoding\r\n";
+static const char szETagHdr[] = "ETag: ";
+static const char szLastModifiedHdr[] = "Last-Modified: ";
+static const char szCRLF[] = "\r\n";
+static const char * const rgszDays[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+static const char * const rgszMonths[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
 
 /************************************************************************/
 /*    State machine states                                              */
 /************************************************************************/
 typedef enum {
     PARSEFILENAME,
+    PARSEHEADER,
+    OPENFILE,
     BUILDHTTP,
+    BUILDNOTMODIFIED,
     EXIT,
     SENDFILE,
     JMPFILENOTFOUND,
@@ -94,6 +119,71 @@ uint32_t SDRead(DFILE& dFile, uint8_t * pbRead, uint32_t cbRead)
     return(cbRead);
  }
 
+/***    uint32_t FATDateToHTTPDate(uint16_t fdate, uint16_t ftime, char * sz)
+ *
+ *    Parameters:
+ *          fdate:  FatFs date, bits 15:9 year from 1980, 8:5 month, 4:0 day
+ *          ftime:  FatFs time, bits 15:11 hour, 10:5 minute, 4:0 seconds/2
+ *          sz:     buffer of at least CBHTTPDATE to receive the date
+ *              
+ *    Return Values:
+ *          The length of the date string
+ *
+ *    Description: 
+ *    
+ *      Formats the file time as an RFC 7231 IMF-fixdate, "Sun, 06 Nov 1994 08:49:37 GMT".
+ *      The SD card has no time zone, so the file time is taken as GMT; it only
+ *      needs to be the same every time we serve the file.
+ * ------------------------------------------------------------ */
+static uint32_t FATDateToHTTPDate(uint16_t fdate, uint16_t ftime, char * sz)
+{
+    static const uint8_t rgMonthOffset[] = {0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4};
+    uint32_t year   = 1980 + (fdate >> 9);
+    uint32_t month  = max(1, min(12, (fdate >> 5) & 0xF));
+    uint32_t day    = fdate & 0x1F;
+    uint32_t y      = year - (month < 3);
+    uint32_t wday   = (y + y/4 - y/100 + y/400 + rgMonthOffset[month-1] + day) % 7;
+    uint32_t i      = 0;
+
+    memcpy(&sz[i], rgszDays[wday], 3);                  i += 3;
+    sz[i++] = ','; sz[i++] = ' ';
+    sz[i++] = '0' + day / 10;   sz[i++] = '0' + day % 10;   sz[i++] = ' ';
+    memcpy(&sz[i], rgszMonths[month-1], 3);             i += 3;
+    sz[i++] = ' ';
+    itoa(year, &sz[i], 10);                             i += 4;
+    sz[i++] = ' ';
+    sz[i++] = '0' + (ftime >> 11) / 10;                 sz[i++] = '0' + (ftime >> 11) % 10;                 sz[i++] = ':';
+    sz[i++] = '0' + ((ftime >> 5) & 0x3F) / 10;         sz[i++] = '0' + ((ftime >> 5) & 0x3F) % 10;         sz[i++] = ':';
+    sz[i++] = '0' + ((ftime & 0x1F) * 2) / 10;          sz[i++] = '0' + ((ftime & 0x1F) * 2) % 10;
+    memcpy(&sz[i], " GMT", 5);                          i += 4;
+
+    return(i);
+}
+
+/***    char const * SkipToHeaderValue(char const * szLine, char const * szHeader, uint32_t cbHeader)
+ *
+ *    Parameters:
+ *          szLine:     a request header line
+ *          szHeader:   the header name with the colon, "Accept-Encoding:"
+ *          cbHeader:   length of szHeader
+ *              
+ *    Return Values:
+ *          The start of the value if this is the header, NULL otherwise
+ *
+ *    Description: 
+ *    
+ *      Header names are case insensitive.
+ * ------------------------------------------------------------ */
+static char const * SkipToHeaderValue(char const * szLine, char const * szHeader, uint32_t cbHeader)
+{
+    if(strncasecmp(szLine, szHeader, cbHeader) != 0) return(NULL);
+
+    szLine += cbHeader;
+    while(*szLine == ' ') szLine++;
+
+    return(szLine);
+}
+
 /***    GCMD::ACTION ComposeHTMLSDPage(CLIENTINFO * pClientInfo)
  *
  *    Parameters:
@@ -102,7 +192,7 @@ uint32_t SDRead(DFILE& dFile, uint8_t * pbRead, uint32_t cbRead)
  *    Return Values:
  *          GCMD::ACTION    - GCMD::CONTINUE, just return with no outside action
  *                          - GCMD::READ, non-blocking read of input data into the rgbIn buffer appended to the end of cbRead
- *                          - GCMD::GETLINE, blocking read until a line of input is read or until the rgbIn buffer is full, always the line starts at the beginnig of the rgbIn
+ *                          - GCMD::GETLINE, blocking read until a line of input is read or until the rgbIn buffer is full, the line is at szLine
  *                          - GCMD::WRITE, loop writing until all cbWrite bytes are written from the pbOut buffer
  *                          - GCMD::DONE, we are done processing and the connection can be closed
  *
@@ -112,6 +202,11 @@ uint32_t SDRead(DFILE& dFile, uint8_t * pbRead, uint32_t cbRead)
  *      .htm, .html, .jpeg, .png, .txt and more may be rendered
  *      The file extension on the filename determine the MIME type
  *      returned to the client.
+ *
+ *      If the client takes gzip and there is a file.gz next to the file,
+ *      the .gz is sent as is with Content-Encoding: gzip. The response carries
+ *      an ETag from the file date, time and size; when If-None-Match has it
+ *      we answer 304 and send nothing off the SD card.
  *    
  * ------------------------------------------------------------ */
 GCMD::ACTION ComposeHTMLSDPage(CLIENTINFO * pClientInfo)
@@ -144,10 +239,10 @@ GCMD::ACTION ComposeHTMLSDPage(CLIENTINFO * pClientInfo)
             // the assumption is that the file name will be on the first line of the command
             // there is a bunch of other stuff on the line we don't care about, but it is at the
             // end of the line.
-            Serial.println((char *) pClientInfo->rgbIn);
+            Serial.println(pClientInfo->szLine);
 
             // find the begining of the file name
-            szFileName = strstr((const char *) pClientInfo->rgbIn, szGET);
+            szFileName = strstr(pClientInfo->szLine, szGET);
             if(szFileName == NULL)
             {
                 pClientInfo->htmlState = JMPFILENOTFOUND;
@@ -170,30 +265,148 @@ GCMD::ACTION ComposeHTMLSDPage(CLIENTINFO * pClientInfo)
                 pClientMutex = NULL;
                 return(JumpToComposeHTMLPage(pClientInfo, ComposeHTMLRedirectPage));
             }
-            else
+            else if((uint32_t) (pFileNameEnd - szFileName) > MAX_PATH)
             {
-                *pFileNameEnd = '\0';
+                pClientInfo->htmlState = JMPFILENOTFOUND;
+                break;
             }
 
+            // rgbIn is reused as the rest of the header comes in, so keep our own copy
+            memcpy(szFile, szFileName, pFileNameEnd - szFileName);
+            szFile[pFileNameEnd - szFileName] = '\0';
+            szFileName = szFile;
+
             Serial.print("SD FileName:");
             Serial.print(szFileName);
             Serial.print(" on socket: 0x");
             Serial.println((uint32_t) pClientMutex, 16);
 
-            if( (DFATFS::fschdrive(DFATFS::szFatFsVols[VOLSD]) != FR_OK)    ||
-                (DFATFS::fschdir(DFATFS::szRoot) != FR_OK)                  ||
-                (dFile.fsopen(szFileName, FA_READ) != FR_OK)                )
+            fAcceptGzip         = false;
+            fGzip               = false;
+            szIfNoneMatch[0]    = '\0';
+
+            pClientInfo->htmlState = PARSEHEADER;
+            retCMD = GCMD::GETLINE;
+            break;
+
+        // look for the headers that pick what we send
+        case PARSEHEADER:
             {
-                Serial.print("Unable to find HTML page:");
-                Serial.println(szFileName);
-                pClientInfo->htmlState = JMPFILENOTFOUND;
+                char const * szValue;
+
+                // end of the header
+                if(pClientInfo->szLine[0] == '\0')
+                {
+                    pClientInfo->htmlState = OPENFILE;
+                    break;
+                }
+
+                else if((szValue = SkipToHeaderValue(pClientInfo->szLine, szAcceptEncoding, sizeof(szAcceptEncoding)-1)) != NULL)
+                {
+                    fAcceptGzip = (strstr(szValue, szGzip) != NULL);
+                }
+
+                else if((szValue = SkipToHeaderValue(pClientInfo->szLine, szIfNoneMatchHdr, sizeof(szIfNoneMatchHdr)-1)) != NULL)
+                {
+                    strncpy(szIfNoneMatch, szValue, sizeof(szIfNoneMatch)-1);
+                    szIfNoneMatch[sizeof(szIfNoneMatch)-1] = '\0';
+                }
+
+                retCMD = GCMD::GETLINE;
             }
-            else
+            break;
+
+        case OPENFILE:
             {
+                uint32_t cbFile = strlen(szFile);
+
+                if( (DFATFS::fschdrive(DFATFS::szFatFsVols[VOLSD]) != FR_OK)    ||
+                    (DFATFS::fschdir(DFATFS::szRoot) != FR_OK)                  )
+                {
+                    Serial.println("Unable to get to the SD root");
+                    pClientInfo->htmlState = JMPFILENOTFOUND;
+                    break;
+                }
+
+                // prefer the compressed copy if the client can take it
+                if(fAcceptGzip)
+                {
+                    memcpy(&szFile[cbFile], szGzExt, sizeof(szGzExt));
+                    fGzip = (dFile.fsopen(szFile, FA_READ) == FR_OK);
+                }
+
+                if(!fGzip)
+                {
+                    szFile[cbFile] = '\0';
+                    if(dFile.fsopen(szFile, FA_READ) != FR_OK)
+                    {
+                        Serial.print("Unable to find HTML page:");
+                        Serial.println(szFileName);
+                        pClientInfo->htmlState = JMPFILENOTFOUND;
+                        break;
+                    }
+                }
+
+                // the validators come from the file we actually send
+                if(DDIRINFO::fsstat(szFile) == FR_OK)
+                {
+                    uint32_t cb = 0;
+
+                    szETag[cb++] = '"';
+                    utoa((((uint32_t) DDIRINFO::fsgetDate()) << 16) | DDIRINFO::fsgetTime(), &szETag[cb], 16);
+                    cb += strlen(&szETag[cb]);
+                    szETag[cb++] = '-';
+                    utoa(dFile.fssize(), &szETag[cb], 16);
+                    cb += strlen(&szETag[cb]);
+                    if(fGzip)
+                    {
+                        memcpy(&szETag[cb], "-gz", 3);
+                        cb += 3;
+                    }
+                    szETag[cb++] = '"';
+                    szETag[cb] = '\0';
+
+                    FATDateToHTTPDate(DDIRINFO::fsgetDate(), DDIRINFO::fsgetTime(), szLastModified);
+                }
+                else
+                {
+                    szETag[0]           = '\0';
+                    szLastModified[0]   = '\0';
+                }
+
+                // put the name back so the content type comes from the real extension
+                szFile[cbFile] = '\0';
+
                 Serial.print("HTML page:");
                 Serial.print(szFileName);
-                Serial.println(" exists!");
-                pClientInfo->htmlState = BUILDHTTP;
+                Serial.println(fGzip ? " exists as .gz!" : " exists!");
+
+                if(szETag[0] != '\0' && strstr(szIfNoneMatch, szETag) != NULL) pClientInfo->htmlState = BUILDNOTMODIFIED;
+                else pClientInfo->htmlState = BUILDHTTP;
+            }
+            break;
+
+        // the client already has it
+        case BUILDNOTMODIFIED:
+            {
+                char *      sz = (char *) pClientInfo->rgbScratch;
+                uint32_t    cb = sizeof(szHTTPNotModified) - 1;
+
+                memcpy(sz, szHTTPNotModified, cb);
+                memcpy(&sz[cb], szETagHdr, sizeof(szETagHdr) - 1);          cb += sizeof(szETagHdr) - 1;
+                strcpy(&sz[cb], szETag);                                    cb += strlen(szETag);
+                memcpy(&sz[cb], szCRLF, sizeof(szCRLF) - 1);                cb += sizeof(szCRLF) - 1;
+                memcpy(&sz[cb], szCRLF, sizeof(szCRLF));                    cb += sizeof(szCRLF) - 1;
+
+                Serial.print("Not modified:");
+                Serial.println(szFileName);
+
+                // no body, so the connection can always be kept
+                pClientInfo->fKeepAlive = true;
+                pClientInfo->pbOut      = pClientInfo->rgbScratch;
+                pClientInfo->cbWrite    = cb;
+                pClientInfo->htmlState  = HTTPDISCONNECT;
+                retCMD = GCMD::WRITE;
             }
             break;
 
@@ -202,9 +415,32 @@ GCMD::ACTION ComposeHTMLSDPage(CLIENTINFO * pClientInfo)
 
             if(dFile && (dFile.fslseek(0) == FR_OK))
             {
-                pClientInfo->cbWrite = BuildHTTPOKStr(false, dFile.fssize(), szFileName, (char *) pClientInfo->rgbScratch, sizeof(pClientInfo->rgbScratch));
-                if(pClientInfo->cbWrite > 0)
+                // no-cache means the browser keeps it but asks with If-None-Match before using it
+                pClientInfo->cbWrite = BuildHTTPOKStr(true, true, dFile.fssize(), szFileName, (char *) pClientInfo->rgbScratch, sizeof(pClientInfo->rgbScratch));
+
+                // take off the blank line, put in our headers and then end it again
+                if(pClientInfo->cbWrite > 0 && (pClientInfo->cbWrite + 128 + CBETAG + CBHTTPDATE) < sizeof(pClientInfo->rgbScratch))
                 {
+                    char *      sz = (char *) pClientInfo->rgbScratch;
+                    uint32_t    cb = pClientInfo->cbWrite - (sizeof(szCRLF) - 1);
+
+                    if(fGzip)
+                    {
+                        memcpy(&sz[cb], szContentEncodingGzip, sizeof(szContentEncodingGzip) - 1);  cb += sizeof(szContentEncodingGzip) - 1;
+                    }
+                    memcpy(&sz[cb], szVaryAcceptEncoding, sizeof(szVaryAcceptEncoding) - 1);        cb += sizeof(szVaryAcceptEncoding) - 1;
+                    if(szETag[0] != '\0')
+                    {
+                        memcpy(&sz[cb], szETagHdr, sizeof(szETagHdr) - 1);                          cb += sizeof(szETagHdr) - 1;
+                        strcpy(&sz[cb], szETag);                                                    cb += strlen(szETag);
+                        memcpy(&sz[cb], szCRLF, sizeof(szCRLF) - 1);                                cb += sizeof(szCRLF) - 1;
+                        memcpy(&sz[cb], szLastModifiedHdr, sizeof(szLastModifiedHdr) - 1);          cb += sizeof(szLastModifiedHdr) - 1;
+                        strcpy(&sz[cb], szLastModified);                                            cb += strlen(szLastModified);
+                        memcpy(&sz[cb], szCRLF, sizeof(szCRLF) - 1);                                cb += sizeof(szCRLF) - 1;
+                    }
+                    memcpy(&sz[cb], szCRLF, sizeof(szCRLF));                                        cb += sizeof(szCRLF) - 1;
+                    pClientInfo->cbWrite = cb;
+
                     pClientInfo->pbOut = pClientInfo->rgbScratch;
                     retCMD = GCMD::WRITE;
                     pClientInfo->htmlState = SENDFILE;
@@ -271,6 +507,9 @@ GCMD::ACTION ComposeHTMLSDPage(CLIENTINFO * pClientInfo)
          case EXIT:
             Serial.print("Wrote page cleanly on socket: 0x");
             Serial.println((uint32_t) pClientMutex, 16);
+
+            // an empty file had no content length, so the close ends it
+            pClientInfo->fKeepAlive = (dFile.fssize() > 0);
             pClientInfo->htmlState = HTTPDISCONNECT;
             break;
 
@@ -0,0 +1,734 @@
+/************************************************************************/
+/*                                                                      */
+/*    HTMLWebSocket.cpp                                                 */
+/*                                                                      */
+/*    Upgrades a GET to a WebSocket (RFC 6455) and pushes acquisition   */
+/*    data to the client as binary frames as soon as it is ready        */
+/*                                                                      */
+/************************************************************************/
+/*    Author:     Keith Vogel                                           */
+/*    Copyright 2026, Digilent Inc.                                     */
+/************************************************************************/
+/*
+*
+* Copyright (c) 2013-2026, Digilent <www.digilentinc.com>
+* Contact Digilent for the latest version.
+*
+* This program is free software; distributed under the terms of
+* BSD 3-clause license ("Revised BSD License", "New BSD License", or "Modified BSD License")
+*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* 1.    Redistributions of source code must retain the above copyright notice, this
+*        list of conditions and the following disclaimer.
+* 2.    Redistributions in binary form must reproduce the above copyright notice,
+*        this list of conditions and the following disclaimer in the documentation
+*        and/or other materials provided with the distribution.
+* 3.    Neither the name(s) of the above-listed copyright holder(s) nor the names
+*        of its contributors may be used to endorse or promote products derived
+*        from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+* IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+* OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+* OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/************************************************************************/
+/*  Revision History:                                                   */
+/*    10/19/2026(KeithV): Created                                       */
+/*    10/19/2026(KeithV): Copy and convert logger frames from the ring  */
+/*    10/19/2026(KeithV): Read fields in the header, buffered control   */
+/*                        frames, ping a quiet client                   */
+/************************************************************************/
+#include <OpenScope.h>
+
+/************************************************************************/
+/*    HTML Strings                                                      */
+/************************************************************************/
+static const char szWSKey[]         = "Sec-WebSocket-Key:";
+static const char szWSUpgrade[]     = "Upgrade:";
+static const char szWSWebSocket[]   = "websocket";
+static const char szWSGUID[]        = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+static const char szWSSwitching[]   = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: ";
+static const char szBase64[]        = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+#define CWSCLIENTS          2                   // how many push connections we allow at once
+#define CBWSKEY             32                  // the key is 24 base64 characters
+#define WSLOGBATCH          256                 // push log samples once we have this many
+#define WSLOGMAXTICKS       (100 * CORE_TMR_TICKS_PER_MSEC) // or once they are this old
+#define WSLOGMAXBEHIND      (LOGDMASIZE / 2)    // if the client falls further behind than this, skip ahead
+#define WSLOGMAXFRAME       512                 // most log samples in one frame, they are copied out of the DMA ring
+#define WSPINGMSEC          15000               // ping a client that has sent nothing for this long
+#define WSPEERMSEC          45000               // and hang up if it still sends nothing
+
+// WebSocket opcodes
+#define WSOPCLOSE           0x8
+#define WSOPPING            0x9
+#define WSOPPONG            0xA
+#define WSFIN               0x80
+#define WSMASK              0x80
+#define WSOPBINARY          0x2
+#define WSOPCONTROL         0x8                 // opcodes with this bit set are control frames
+#define WSMAXCONTROL        125                 // longest control frame payload, RFC 6455 5.5
+
+// the push sources, in round robin order
+typedef enum {
+    WSSRCOSC1,
+    WSSRCOSC2,
+    WSSRCLA,
+    WSSRCLOG1,
+    WSSRCLOG2,
+    WSSRCEND
+} WSSRC;
+
+// every binary frame starts with this, little endian, then the samples
+// osc and logger samples are in mV, la samples are the raw port bits
+// the fields after iSample are what osc, la and log read return for the same buffer
+typedef struct
+{
+    uint32_t        id;                 // INSTR_ID of the instrument
+    uint32_t        acqCount;           // acquisition count for osc and la, 0 for the logger
+    int64_t         iSample;            // index of the first sample for the logger, 0 for osc and la
+    uint64_t        xsps;               // actualSampleFreq
+    int64_t         psDelay;            // actualTriggerDelay, 0 for the logger
+    int32_t         iTrg;               // triggerIndex, 0 for the logger
+    uint32_t        iPOI;               // pointOfInterest, 0 for the logger
+    int32_t         mvOffset;           // actualVOffset for osc and the logger, 0 for la
+    uint32_t        bitMask;            // the la bitmask, 0 for osc and the logger
+} __attribute__((packed)) WSPUSHHDR;
+
+// a client holds one from HTTPSTART until it disconnects
+typedef struct
+{
+    CLIENTINFO *    pClientInfo;
+    STATE *         pLockState;                 // the buffer locked for the frame going out, NULL if none
+    uint8_t const * pbData;                     // the samples of the frame going out
+    uint32_t        cbData;
+    uint32_t        iSrc;                       // where the round robin starts next time
+    uint32_t        rgAcqCount[WSSRCLOG1];      // last acquisition pushed for osc1, osc2 and la
+    int64_t         rgcLogPushed[2];            // samples pushed for each analog logger, -1 if it was not running
+    uint32_t        rgtLogPushed[2];            // when we last pushed log samples
+    int16_t         rgLogFrame[WSLOGMAXFRAME];  // log samples copied out of the DMA ring for the frame going out
+    uint64_t        cbSkip;                     // payload of a client data frame still to throw away
+    uint32_t        tPeer;                      // when the client last sent anything, in msec
+    bool            fPinged;                    // we pinged the client since then
+    bool            fUpgrade;
+    char            szKey[CBWSKEY];
+} WSCTX;
+
+static WSCTX rgWSCtx[CWSCLIENTS];
+
+/************************************************************************/
+/*    State machine states                                              */
+/************************************************************************/
+typedef enum {
+    WSHDR,
+    WSACCEPT,
+    WSPUSH,
+    WSFRAMEDATA,
+    JMPFILENOTFOUND,
+    DONE
+} HSTATE;
+
+/************************************************************************/
+/*    SHA-1 (FIPS 180-4), only for the handshake                        */
+/************************************************************************/
+#define SHA1ROTL(_x, _n) (((_x) << (_n)) | ((_x) >> (32 - (_n))))
+
+static void SHA1Block(uint32_t rgH[5], uint8_t const rgb[64])
+{
+    uint32_t    rgW[80];
+    uint32_t    a = rgH[0], b = rgH[1], c = rgH[2], d = rgH[3], e = rgH[4];
+    uint32_t    i;
+
+    for(i = 0; i < 16; i++) rgW[i] = (rgb[4*i] << 24) | (rgb[4*i+1] << 16) | (rgb[4*i+2] << 8) | rgb[4*i+3];
+    for( ; i < 80; i++) rgW[i] = SHA1ROTL(rgW[i-3] ^ rgW[i-8] ^ rgW[i-14] ^ rgW[i-16], 1);
+
+    for(i = 0; i < 80; i++)
+    {
+        uint32_t f, k, t;
+
+        if(i < 20)      { f = (b & c) | (~b & d);           k = 0x5A827999; }
+        else if(i < 40) { f = b ^ c ^ d;                    k = 0x6ED9EBA1; }
+        else if(i < 60) { f = (b & c) | (b & d) | (c & d);  k = 0x8F1BBCDC; }
+        else            { f = b ^ c ^ d;                    k = 0xCA62C1D6; }
+
+        t = SHA1ROTL(a, 5) + f + e + k + rgW[i];
+        e = d;
+        d = c;
+        c = SHA1ROTL(b, 30);
+        b = a;
+        a = t;
+    }
+
+    rgH[0] += a; rgH[1] += b; rgH[2] += c; rgH[3] += d; rgH[4] += e;
+}
+
+// hash the key followed by the GUID
+static void SHA1KeyGUID(char const * szKey, uint32_t cbKey, uint8_t rgbHash[20])
+{
+    uint32_t    rgH[5]  = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    uint8_t     rgb[128];
+    uint32_t    cb      = cbKey + sizeof(szWSGUID) - 1;
+    uint32_t    cbPad   = (cb + 9 + 63) & ~63;
+    uint64_t    cBits   = ((uint64_t) cb) * 8;
+    uint32_t    i;
+
+    ASSERT(cbPad <= sizeof(rgb));
+
+    memset(rgb, 0, sizeof(rgb));
+    memcpy(rgb, szKey, cbKey);
+    memcpy(&rgb[cbKey], szWSGUID, sizeof(szWSGUID) - 1);
+    rgb[cb] = 0x80;
+    for(i = 0; i < 8; i++) rgb[cbPad - 1 - i] = (uint8_t) (cBits >> (8 * i));
+
+    for(i = 0; i < cbPad; i += 64) SHA1Block(rgH, &rgb[i]);
+
+    for(i = 0; i < 20; i++) rgbHash[i] = (uint8_t) (rgH[i/4] >> (24 - 8 * (i % 4)));
+}
+
+// base64 encode, returns the number of characters written
+static uint32_t Base64(uint8_t const * pb, uint32_t cb, char * sz)
+{
+    uint32_t i  = 0;
+    uint32_t j  = 0;
+
+    for(i = 0; i + 2 < cb; i += 3)
+    {
+        sz[j++] = szBase64[pb[i] >> 2];
+        sz[j++] = szBase64[((pb[i] & 0x03) << 4) | (pb[i+1] >> 4)];
+        sz[j++] = szBase64[((pb[i+1] & 0x0F) << 2) | (pb[i+2] >> 6)];
+        sz[j++] = szBase64[pb[i+2] & 0x3F];
+    }
+
+    if(i < cb)
+    {
+        sz[j++] = szBase64[pb[i] >> 2];
+        if(i + 1 < cb)
+        {
+            sz[j++] = szBase64[((pb[i] & 0x03) << 4) | (pb[i+1] >> 4)];
+            sz[j++] = szBase64[(pb[i+1] & 0x0F) << 2];
+        }
+        else
+        {
+            sz[j++] = szBase64[(pb[i] & 0x03) << 4];
+            sz[j++] = '=';
+        }
+        sz[j++] = '=';
+    }
+
+    return(j);
+}
+
+/************************************************************************/
+/*    Push helpers                                                      */
+/************************************************************************/
+
+// put a server frame header (never masked) in pb, returns its length
+static uint32_t WSFrameHdr(uint8_t * pb, uint8_t opcode, uint64_t cbPayload)
+{
+    uint32_t cb = 0;
+
+    pb[cb++] = WSFIN | opcode;
+    if(cbPayload < 126)
+    {
+        pb[cb++] = (uint8_t) cbPayload;
+    }
+    else if(cbPayload < 0x10000)
+    {
+        pb[cb++] = 126;
+        pb[cb++] = (uint8_t) (cbPayload >> 8);
+        pb[cb++] = (uint8_t) cbPayload;
+    }
+    else
+    {
+        pb[cb++] = 127;
+        for(int32_t i = 7; i >= 0; i--) pb[cb++] = (uint8_t) (cbPayload >> (8 * i));
+    }
+
+    return(cb);
+}
+
+// see if this source has something new; if so lock it and fill in the push header and data
+static bool WSNextPush(WSCTX& ctx, uint32_t iSrc, WSPUSHHDR& hdr)
+{
+    switch(iSrc)
+    {
+        case WSSRCOSC1:
+        case WSSRCOSC2:
+            {
+                IOSC& iosc = (iSrc == WSSRCOSC1) ? pjcmd.ioscCh1 : pjcmd.ioscCh2;
+
+                if(iosc.state.processing == Triggered && iosc.buffLock == LOCKAvailable && iosc.acqCount != ctx.rgAcqCount[iSrc])
+                {
+                    iosc.buffLock           = LOCKOutput;
+                    ctx.pLockState          = &iosc.buffLock;
+                    ctx.pbData              = (uint8_t const *) iosc.pBuff;
+                    ctx.cbData              = iosc.bidx.cBuff * sizeof(int16_t);
+                    ctx.rgAcqCount[iSrc]    = iosc.acqCount;
+                    hdr.id                  = iosc.id;
+                    hdr.acqCount            = iosc.acqCount;
+                    hdr.xsps                = iosc.bidx.xsps;
+                    hdr.psDelay             = iosc.bidx.psDelay;
+                    hdr.iTrg                = iosc.bidx.iTrg;
+                    hdr.iPOI                = iosc.bidx.iPOI;
+                    hdr.mvOffset            = OSCVinFromDadcGainOffset(((OSC *) rgInstr[iosc.id]),  0, (iosc.gain-1), iosc.mvOffset);
+                    return(true);
+                }
+            }
+            break;
+
+        case WSSRCLA:
+            if(pjcmd.ila.state.processing == Triggered && pjcmd.ila.buffLock == LOCKAvailable && pjcmd.ila.acqCount != ctx.rgAcqCount[iSrc])
+            {
+                pjcmd.ila.buffLock      = LOCKOutput;
+                ctx.pLockState          = &pjcmd.ila.buffLock;
+                ctx.pbData              = (uint8_t const *) pjcmd.ila.pBuff;
+                ctx.cbData              = pjcmd.ila.bidx.cBuff * sizeof(uint16_t);
+                ctx.rgAcqCount[iSrc]    = pjcmd.ila.acqCount;
+                hdr.id                  = LOGIC1_ID;
+                hdr.acqCount            = pjcmd.ila.acqCount;
+                hdr.xsps                = pjcmd.ila.bidx.xsps;
+                hdr.psDelay             = pjcmd.ila.bidx.psDelay;
+                hdr.iTrg                = pjcmd.ila.bidx.iTrg;
+                hdr.iPOI                = pjcmd.ila.bidx.iPOI;
+                hdr.bitMask             = pjcmd.ila.bitMask;
+                return(true);
+            }
+            break;
+
+        case WSSRCLOG1:
+        case WSSRCLOG2:
+            {
+                IALOG&      ialog   = (iSrc == WSSRCLOG1) ? pjcmd.iALog1 : pjcmd.iALog2;
+                int64_t&    cPushed = ctx.rgcLogPushed[iSrc - WSSRCLOG1];
+                uint32_t&   tPushed = ctx.rgtLogPushed[iSrc - WSSRCLOG1];
+                const OSC&  osc     = *((ALOG *) rgInstr[ialog.id])->posc;
+                int64_t     cTotal;
+                int32_t     iDMA;
+                int32_t     clDMA;
+                uint32_t    iBuff;
+                uint32_t    cSamples;
+
+                if(ialog.state.processing != Running)
+                {
+                    cPushed = -1;
+                    break;
+                }
+
+                // get a good dma location, ISR is running
+                do
+                {
+                    clDMA   = ialog.bidx.cDMARoll;
+                    iDMA    = osc.pDMAch2->DCHxDPTR;
+                } while(ialog.bidx.cDMARoll != clDMA);
+                cTotal = ((int64_t) clDMA) * LOGDMASIZE + iDMA / sizeof(uint16_t);
+
+                // only push what comes in after we started looking
+                if(cPushed < 0)
+                {
+                    cPushed = cTotal;
+                    tPushed = ReadCoreTimer();
+                    break;
+                }
+
+                // the DMA is about to write over what we have not pushed, skip ahead
+                if(cTotal - cPushed > WSLOGMAXBEHIND) cPushed = cTotal - WSLOGMAXBEHIND;
+
+                // push in batches, not a frame per sample
+                if(cTotal == cPushed || ((cTotal - cPushed) < WSLOGBATCH && (ReadCoreTimer() - tPushed) < WSLOGMAXTICKS))
+                {
+                    break;
+                }
+
+                // only up to the end of the circular buffer, the rest goes in the next frame
+                iBuff       = (uint32_t) (cPushed % LOGDMASIZE);
+                cSamples    = (uint32_t) min(min(cTotal - cPushed, (int64_t) (LOGDMASIZE - iBuff)), (int64_t) WSLOGMAXFRAME);
+
+                // the DMA keeps writing the ring while the frame is in the socket, so copy it out
+                memcpy(ctx.rgLogFrame, &ialog.pBuff[iBuff], cSamples * sizeof(int16_t));
+
+                // make sure the DMA did not come around and write over them while we copied
+                do
+                {
+                    clDMA   = ialog.bidx.cDMARoll;
+                    iDMA    = osc.pDMAch2->DCHxDPTR;
+                } while(ialog.bidx.cDMARoll != clDMA);
+                cTotal = ((int64_t) clDMA) * LOGDMASIZE + iDMA / sizeof(uint16_t);
+
+                if(cTotal - cPushed >= LOGDMASIZE)
+                {
+                    cPushed = cTotal - WSLOGMAXBEHIND;
+                    break;
+                }
+
+                // convert to mV just as the log file is
+                OSCVinFromDadcArray((HINSTR) &osc, ctx.rgLogFrame, cSamples);
+
+                ctx.pLockState  = NULL;
+                ctx.pbData      = (uint8_t const *) ctx.rgLogFrame;
+                ctx.cbData      = cSamples * sizeof(int16_t);
+                hdr.id          = ialog.id;
+                hdr.iSample     = cPushed;
+                hdr.xsps        = ialog.bidx.xsps;
+                hdr.mvOffset    = ialog.mvOffset;
+
+                cPushed         += cSamples;
+                tPushed         = ReadCoreTimer();
+                return(true);
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return(false);
+}
+
+// drop cb bytes off the front of what the client sent, the rest moves up
+static void WSConsume(CLIENTINFO * pClientInfo, uint32_t cb)
+{
+    pClientInfo->cbRead -= cb;
+    memmove(pClientInfo->rgbIn, &pClientInfo->rgbIn[cb], pClientInfo->cbRead);
+}
+
+// unlock the buffer we were pushing
+static void WSReleaseBuffer(WSCTX& ctx)
+{
+    if(ctx.pLockState != NULL && *ctx.pLockState == LOCKOutput)
+    {
+        *ctx.pLockState = LOCKAvailable;
+    }
+    ctx.pLockState = NULL;
+}
+
+/***    GCMD::ACTION ComposeHTMLWebSocket(CLIENTINFO * pClientInfo)
+ *
+ *    Parameters:
+ *          pClientInfo - the client info representing this connection and web page
+ *
+ *    Return Values:
+ *          GCMD::ACTION    - GCMD::CONTINUE, just return with no outside action
+ *                          - GCMD::READ, non-blocking read of input data into the rgbIn buffer appended to the end of cbRead
+ *                          - GCMD::GETLINE, blocking read until a line of input is read or until the rgbIn buffer is full, the line is at szLine
+ *                          - GCMD::WRITE, loop writing until all cbWrite bytes are written from the pbOut buffer
+ *                          - GCMD::DONE, we are done processing and the connection can be closed
+ *
+ *    Description:
+ *
+ *      Answers the WebSocket upgrade and then stays on the connection pushing
+ *      every new osc and la acquisition, and the analog logger samples as they come in.
+ *      Each binary frame is a WSPUSHHDR followed by the samples; osc and
+ *      logger samples are in mV, la samples are the port bits. Logger samples
+ *      are copied out of the DMA ring and converted, the osc and la buffers
+ *      are locked and sent in place.
+ *
+ *      There is no queue; a frame is only built once the last one is completely
+ *      written to the socket, so a slow client gets the newest acquisition and
+ *      skips the ones it could not take. The client is only expected to send
+ *      control frames; they are gathered in rgbIn until all of a frame is in,
+ *      and data frames are read and thrown away.
+ *
+ *      The connection is held with fPush so the server's idle timeout does not
+ *      close it while there is nothing to push. Instead a client that sends
+ *      nothing for WSPINGMSEC is pinged, and one that still sends nothing
+ *      by WSPEERMSEC is closed.
+ *
+ * ------------------------------------------------------------ */
+GCMD::ACTION ComposeHTMLWebSocket(CLIENTINFO * pClientInfo)
+{
+    GCMD::ACTION    retCMD  = GCMD::CONTINUE;
+    WSCTX *         pCtx    = NULL;
+
+    // find our context, if we have one
+    for(uint32_t i = 0; i < CWSCLIENTS; i++)
+    {
+        if(rgWSCtx[i].pClientInfo == pClientInfo)
+        {
+            pCtx = &rgWSCtx[i];
+            break;
+        }
+    }
+
+    switch(pClientInfo->htmlState)
+    {
+        case HTTPSTART:
+
+            for(uint32_t i = 0; i < CWSCLIENTS && pCtx == NULL; i++)
+            {
+                if(rgWSCtx[i].pClientInfo == NULL)
+                {
+                    pCtx = &rgWSCtx[i];
+                    memset(pCtx, 0, sizeof(WSCTX));
+                    pCtx->pClientInfo       = pClientInfo;
+                    pCtx->rgcLogPushed[0]   = -1;
+                    pCtx->rgcLogPushed[1]   = -1;
+                }
+            }
+
+            // too many push clients already
+            if(pCtx == NULL)
+            {
+                pClientInfo->htmlState = JMPFILENOTFOUND;
+                break;
+            }
+
+            Serial.println("WebSocket Upgrade Detected");
+            pClientInfo->htmlState = WSHDR;
+
+            // read off the GET line
+            retCMD = GCMD::GETLINE;
+            break;
+
+        case WSHDR:
+
+            // end of the header
+            if(strlen(pClientInfo->szLine) == 0)
+            {
+                // the client sends nothing more until it sees our answer
+                pClientInfo->cbRead     = 0;
+                pClientInfo->cbParsed   = 0;
+
+                if(pCtx->fUpgrade && pCtx->szKey[0] != '\0') pClientInfo->htmlState = WSACCEPT;
+                else pClientInfo->htmlState = JMPFILENOTFOUND;
+                break;
+            }
+
+            else if(strncasecmp(szWSKey, pClientInfo->szLine, sizeof(szWSKey)-1) == 0)
+            {
+                char const *    sz = &pClientInfo->szLine[sizeof(szWSKey)-1];
+                uint32_t        cb = 0;
+
+                while(*sz == ' ') sz++;
+                while(cb < sizeof(pCtx->szKey)-1 && sz[cb] != '\0' && sz[cb] != ' ') cb++;
+                memcpy(pCtx->szKey, sz, cb);
+                pCtx->szKey[cb] = '\0';
+            }
+
+            else if(strncasecmp(szWSUpgrade, pClientInfo->szLine, sizeof(szWSUpgrade)-1) == 0)
+            {
+                char const * sz = &pClientInfo->szLine[sizeof(szWSUpgrade)-1];
+
+                while(*sz == ' ') sz++;
+                pCtx->fUpgrade = (strncasecmp(sz, szWSWebSocket, sizeof(szWSWebSocket)-1) == 0);
+            }
+
+            retCMD = GCMD::GETLINE;
+            break;
+
+        case WSACCEPT:
+            {
+                uint8_t     rgbHash[20];
+                char *      sz = (char *) pClientInfo->rgbScratch;
+                uint32_t    cb = sizeof(szWSSwitching)-1;
+
+                SHA1KeyGUID(pCtx->szKey, strlen(pCtx->szKey), rgbHash);
+
+                memcpy(sz, szWSSwitching, cb);
+                cb += Base64(rgbHash, sizeof(rgbHash), &sz[cb]);
+                memcpy(&sz[cb], "\r\n\r\n", 4);
+                cb += 4;
+
+                pClientInfo->pbOut      = pClientInfo->rgbScratch;
+                pClientInfo->cbWrite    = cb;
+                pClientInfo->htmlState  = WSPUSH;
+                pClientInfo->fPush      = true;
+                pCtx->tPeer             = SYSGetMilliSecond();
+                retCMD = GCMD::WRITE;
+            }
+            break;
+
+        case WSPUSH:
+            {
+                WSPUSHHDR   hdr;
+                uint8_t *   pb      = pClientInfo->rgbScratch;
+                uint32_t    tCur    = SYSGetMilliSecond();
+
+                // the last frame is out, give its buffer back
+                WSReleaseBuffer(*pCtx);
+
+                // add on what the client sent, a frame may take more than one read to come in
+                if(pClientInfo->cbRead < sizeof(pClientInfo->rgbIn) && pClientInfo->pTCPClient->available() > 0)
+                {
+                    pClientInfo->cbRead += pClientInfo->pTCPClient->readStream(&pClientInfo->rgbIn[pClientInfo->cbRead], sizeof(pClientInfo->rgbIn) - pClientInfo->cbRead);
+                    pCtx->tPeer     = tCur;
+                    pCtx->fPinged   = false;
+                }
+
+                // we take no data from the client, throw away the payload of a data frame
+                if(pCtx->cbSkip > 0 && pClientInfo->cbRead > 0)
+                {
+                    uint32_t cb = (uint32_t) min(pCtx->cbSkip, (uint64_t) pClientInfo->cbRead);
+
+                    WSConsume(pClientInfo, cb);
+                    pCtx->cbSkip -= cb;
+                }
+
+                // see if we have a whole frame header
+                if(pCtx->cbSkip == 0 && pClientInfo->cbRead >= 2)
+                {
+                    uint8_t     opcode      = pClientInfo->rgbIn[0] & 0x0F;
+                    bool        fMask       = (pClientInfo->rgbIn[1] & WSMASK) != 0;
+                    uint32_t    cbLen       = pClientInfo->rgbIn[1] & 0x7F;
+                    uint32_t    cbHdr       = 2 + ((cbLen == 126) ? 2 : (cbLen == 127) ? 8 : 0) + (fMask ? 4 : 0);
+                    uint64_t    cbPayload   = cbLen;
+
+                    if(pClientInfo->cbRead >= cbHdr)
+                    {
+                        uint8_t const * pbPayload   = &pClientInfo->rgbIn[cbHdr];
+                        uint8_t const * pbMask      = pbPayload - 4;    // only if fMask
+
+                        if(cbLen == 126)
+                        {
+                            cbPayload = (((uint32_t) pClientInfo->rgbIn[2]) << 8) | pClientInfo->rgbIn[3];
+                        }
+                        else if(cbLen == 127)
+                        {
+                            cbPayload = 0;
+                            for(uint32_t i = 0; i < 8; i++) cbPayload = (cbPayload << 8) | pClientInfo->rgbIn[2 + i];
+                        }
+
+                        // a data frame, drop the header and skip the payload as it comes in
+                        if((opcode & WSOPCONTROL) == 0)
+                        {
+                            WSConsume(pClientInfo, cbHdr);
+                            pCtx->cbSkip = cbPayload;
+                        }
+
+                        // a control frame this long is not legal, and would not fit in rgbIn; hang up
+                        else if(cbPayload > WSMAXCONTROL)
+                        {
+                            pClientInfo->pbOut      = pb;
+                            pClientInfo->cbWrite    = WSFrameHdr(pb, WSOPCLOSE, 0);
+                            pClientInfo->htmlState  = DONE;
+                            pClientInfo->cbRead     = 0;
+                            retCMD = GCMD::WRITE;
+                            break;
+                        }
+
+                        // all of the control frame is in
+                        else if(pClientInfo->cbRead >= cbHdr + cbPayload)
+                        {
+                            uint32_t cb = (uint32_t) cbPayload;
+
+                            // close, echo the close and hang up
+                            if(opcode == WSOPCLOSE)
+                            {
+                                pClientInfo->pbOut      = pb;
+                                pClientInfo->cbWrite    = WSFrameHdr(pb, WSOPCLOSE, 0);
+                                pClientInfo->htmlState  = DONE;
+                                pClientInfo->cbRead     = 0;
+                                retCMD = GCMD::WRITE;
+                                break;
+                            }
+
+                            // ping, answer with a pong of the unmasked payload
+                            else if(opcode == WSOPPING)
+                            {
+                                uint32_t cbHdrPong = WSFrameHdr(pb, WSOPPONG, cb);
+
+                                for(uint32_t i = 0; i < cb; i++) pb[cbHdrPong + i] = fMask ? (pbPayload[i] ^ pbMask[i % 4]) : pbPayload[i];
+
+                                WSConsume(pClientInfo, cbHdr + cb);
+                                pClientInfo->pbOut      = pb;
+                                pClientInfo->cbWrite    = cbHdrPong + cb;
+                                retCMD = GCMD::WRITE;
+                                break;
+                            }
+
+                            // a pong, or a control frame we do not know, it only tells us the client is there
+                            WSConsume(pClientInfo, cbHdr + cb);
+                        }
+                    }
+                }
+
+                // the client has gone quiet, ping it; if that gets no answer either, hang up
+                if((tCur - pCtx->tPeer) >= WSPEERMSEC)
+                {
+                    Serial.println("WebSocket client stopped answering, closing");
+                    pClientInfo->pbOut      = pb;
+                    pClientInfo->cbWrite    = WSFrameHdr(pb, WSOPCLOSE, 0);
+                    pClientInfo->htmlState  = DONE;
+                    retCMD = GCMD::WRITE;
+                    break;
+                }
+                else if(!pCtx->fPinged && (tCur - pCtx->tPeer) >= WSPINGMSEC)
+                {
+                    pClientInfo->pbOut      = pb;
+                    pClientInfo->cbWrite    = WSFrameHdr(pb, WSOPPING, 0);
+                    pCtx->fPinged           = true;
+                    retCMD = GCMD::WRITE;
+                    break;
+                }
+
+                // round robin, so a busy osc does not starve the la or the logger
+                memset(&hdr, 0, sizeof(hdr));
+                for(uint32_t i = 0; i < WSSRCEND; i++)
+                {
+                    uint32_t iSrc = (pCtx->iSrc + i) % WSSRCEND;
+
+                    if(WSNextPush(*pCtx, iSrc, hdr))
+                    {
+                        uint32_t cb = WSFrameHdr(pb, WSOPBINARY, sizeof(WSPUSHHDR) + pCtx->cbData);
+
+                        memcpy(&pb[cb], &hdr, sizeof(WSPUSHHDR));
+
+                        pClientInfo->pbOut      = pb;
+                        pClientInfo->cbWrite    = cb + sizeof(WSPUSHHDR);
+                        pClientInfo->htmlState  = WSFRAMEDATA;
+                        pCtx->iSrc              = iSrc + 1;
+                        retCMD = GCMD::WRITE;
+                        break;
+                    }
+                }
+            }
+            break;
+
+        case WSFRAMEDATA:
+            pClientInfo->pbOut      = pCtx->pbData;
+            pClientInfo->cbWrite    = pCtx->cbData;
+            pClientInfo->fPinOut    = (pCtx->pLockState != NULL);       // a locked buffer stays put until we release it on the next push
+            pClientInfo->htmlState  = WSPUSH;
+            retCMD = (pCtx->cbData > 0) ? GCMD::WRITE : GCMD::CONTINUE;
+            break;
+
+        case JMPFILENOTFOUND:
+            Serial.println("Jumping to HTTP File Not Found page");
+            if(pCtx != NULL) pCtx->pClientInfo = NULL;
+            return(JumpToComposeHTMLPage(pClientInfo, ComposeHTTP404Error));
+            break;
+
+        case HTTPTIMEOUT:
+            Serial.println("Timeout error occurred, closing the WebSocket");
+
+            // fall thru to close
+
+        case HTTPDISCONNECT:
+            if(pCtx != NULL)
+            {
+                WSReleaseBuffer(*pCtx);
+                pCtx->pClientInfo = NULL;
+
+                Serial.print("Closing WebSocket ID: 0x");
+                Serial.println((uint32_t) pClientInfo, 16);
+            }
+            // fall thru Done
+
+        case DONE:
+        default:
+            pClientInfo->cbWrite    = 0;
+            pClientInfo->fPush      = false;
+            retCMD                  = GCMD::DONE;
+            break;
+    }
+
+    return(retCMD);
+}
@@ -43,6 +43,8 @@
 /*  Revision History:                                                   */
 /*    2/1/2013(KeithV): Created                                         */
 /*    7/22/2013(KeithV): Modified for generic WebServer operations      */
+/*    10/19/2026(KeithV): Keep-alive when the content length is known   */
+/*    10/19/2026(KeithV): Keep-alive only when the page keeps it        */
 /************************************************************************/
 #include <OpenScope.h>
 
@@ -53,6 +55,7 @@ static const char szHTTP404Error[] = "HTTP/1.1 404 Not Found\r\n\r\n";
 static const char szHTTPOK[] = "HTTP/1.1 200 OK\r\n";
 static const char szNoCache[] = "Cache-Control: no-cache\r\n";
 static const char szConnection[] = "Connection: close\r\n";
+static const char szConnectionKeepAlive[] = "Connection: keep-alive\r\n";
 static const char szContentType[] = "Content-Type: ";
 static const char szContentLength[] = "Content-Length: ";
 static const char szTransferEncodingChunked[] = "Transfer-Encoding: chunked\r\n";
@@ -78,7 +81,7 @@ static CLIENTINFO * pClientMutex = NULL;
  *    Return Values:
  *          GCMD::ACTION    - GCMD::CONTINUE, just return with no outside action
  *                          - GCMD::READ, non-blocking read of input data into the rgbIn buffer appended to the end of cbRead
- *                          - GCMD::GETLINE, blocking read until a line of input is read or until the rgbIn buffer is full, always the line starts at the beginnig of the rgbIn
+ *                          - GCMD::GETLINE, blocking read until a line of input is read or until the rgbIn buffer is full, the line is at szLine
  *                          - GCMD::WRITE, loop writing until all cbWrite bytes are written from the pbOut buffer
  *                          - GCMD::DONE, we are done processing and the connection can be closed
  *
@@ -220,10 +223,11 @@ const char * FindExtLocation(const char * szFile)
     return(NULL);
 }
 
-/***    uint32_t BuildHTTPOKStr(bool fNoCache, uint32_t cbContentLen, const char * szFile, char * szHTTPOK, uint32_t cbHTTPOK)
+/***    uint32_t BuildHTTPOKStr(bool fNoCache, bool fKeepAlive, uint32_t cbContentLen, const char * szFile, char * szHTTPOK, uint32_t cbHTTPOK)
  *
  *    Parameters:
  *          fNoCache:       - true if you want the HTTP header to specify that the HTML page should not be cached by the browser
+ *          fKeepAlive:     - true if the page sets fKeepAlive when the response is out; only then, and with a content length, is keep-alive sent
  *          cbContentLen:   - The length of the content, specify zero if you do not want this tag in there.
  *          szFile          - The full file name with extension. The content type will be derived from the file extension, 
  *                              if no extension a text content type is assumed
@@ -240,7 +244,7 @@ const char * FindExtLocation(const char * szFile)
  *      This builds an HTTP OK directive. szHTTPOK must be large enough to hold the whole directive or zero will be returned
  *    
  * ------------------------------------------------------------ */
-uint32_t BuildHTTPOKStr(bool fNoCache, uint32_t cbContentLen, const char * szFile, char * szHTTPOKStr, uint32_t cbHTTPOK)
+uint32_t BuildHTTPOKStr(bool fNoCache, bool fKeepAlive, uint32_t cbContentLen, const char * szFile, char * szHTTPOKStr, uint32_t cbHTTPOK)
 {
     uint32_t i = 0;
     const char * szExt = FindExtLocation(szFile);
@@ -263,7 +267,17 @@ uint32_t BuildHTTPOKStr(bool fNoCache, uint32_t cbContentLen, const char * szFil
         cb += sizeof(szNoCache) - 1;
     }
 
-    cb += sizeof(szConnection) - 1;
+    // only if the page will keep the connection and the content length is known 
+    // can the client find the end of the response without a close
+    fKeepAlive = fKeepAlive && cbContentLen > 0;
+    if(fKeepAlive)
+    {
+        cb += sizeof(szConnectionKeepAlive) - 1;
+    }
+    else
+    {
+        cb += sizeof(szConnection) - 1;
+    }
 
     if(szContentTypeStr == NULL)
     {
@@ -307,8 +321,16 @@ uint32_t BuildHTTPOKStr(bool fNoCache, uint32_t cbContentLen, const char * szFil
     }
 
     // put in the connection type
-    memcpy(&szHTTPOKStr[i], szConnection, sizeof(szConnection) - 1);
-    i += sizeof(szConnection) - 1;
+    if(fKeepAlive)
+    {
+        memcpy(&szHTTPOKStr[i], szConnectionKeepAlive, sizeof(szConnectionKeepAlive) - 1);
+        i += sizeof(szConnectionKeepAlive) - 1;
+    }
+    else
+    {
+        memcpy(&szHTTPOKStr[i], szConnection, sizeof(szConnection) - 1);
+        i += sizeof(szConnection) - 1;
+    }
 
     // put in the content type
     if(szContentTypeStr != NULL)
@@ -45,6 +45,11 @@
 /************************************************************************/
 /*  Revision History:                                                   */
 /*    2/1/2013(KeithV): Created                                         */
+/*    10/19/2026(KeithV): HTTP/1.1 keep-alive                           */
+/*    10/19/2026(KeithV): Segment sized input, lines indexed in place   */
+/*    10/19/2026(KeithV): Pinned output sent without a copy             */
+/*    10/19/2026(KeithV): No delay and a wider send window for clients  */
+/*    10/19/2026(KeithV): fPush, push connections skip the idle timeout */
 /************************************************************************/
 #if !defined(_WEBSERVER_H)
 #define	_WEBSERVER_H
@@ -53,8 +58,11 @@
 
 #define CNTHTTPCMD          10      // The Max number of unique HTML pages we vector off of. This must be at least 1. 
 #define secClientTO         1000      // time in seconds to wait for a response before aborting a client connection.
-#define CBCLILENTINPUTBUFF  256     // The max size of the TCP read buffer, this typically only has to be as large as the URL up to the HTTP tag in the GET line
+#define secKeepAliveTO      30        // time in seconds a kept alive connection waits for its next request; much less than secClientTO so idle sockets go back to the server
+#define CBCLILENTINPUTBUFF  1536    // The max size of the TCP read buffer; a full TCP segment so a whole browser request header comes in with one read
 #define CBCLILENTSCRATCH    512     // This is scratch output buffer space to generate out going HTML strings it, it is optional if not needed can be set as small as 4;
+#define CBPINNEDWRITE       2048    // a pinned write at least this big is sent straight out of pbOut rather than copied into the socket
+#define CNTCLIENTSENDWINDOW 8       // segments a client connection may have in flight; enough for a fast retransmit on a lost one
 
 // these are predefine HTML state machine states, HTTPINIT "must" be implemented, the others can be processed under case default if not needed.
 #define HTTPSTART           10000   // This is a predefine state for the rendering HTML page to initialize the state machine 
@@ -104,13 +112,21 @@ typedef struct CLIENTINFO_T
     uint32_t        nextClientState;                // a delayed state variable for process client to use (state specific)
     uint32_t        tStartClient;                   // a timer value used for timeout
     uint32_t        cbRead;                         // number of valid bytes in rgbIn, 
+    uint32_t        cbParsed;                       // bytes at the front of rgbIn already handed out as lines, the unparsed input starts here
+    char *          szLine;                         // on GCMD::GETLINE, the null terminated line; it points into rgbIn, nothing is copied
     uint8_t            rgbIn[CBCLILENTINPUTBUFF];      // The input buffer, this is where the /GET and URL will be
     uint8_t            rgbOverflow[4];                 // some overflow space to put characters in while parsing; typically not used.
+    bool            fKeepAlive;                     // set by the HTML page when its response was completely sent with a Content-Length, the connection can take another request
+    bool            fIdle;                          // a kept alive connection waiting for its next request
+    bool            fEndOfHdr;                      // the blank line ending the request header has been handed out as a line
+    bool            fPush;                          // set by the HTML page while it holds the connection open to push data; secClientTO does not apply while the page has control, the page watches the peer itself
 
     // HTML processing variables
     uint32_t        htmlState;                      // a state variable for the HTML web page state machine to use; each page is different
     uint32_t        cbWrite;                        // number of bytes to write out when GCMD::WRITE is returned
     uint32_t        cbWritten;                      // a variable for process client to use to know how many bytes have been written
+    bool            fPinOut;                        // set by the HTML page with GCMD::WRITE when pbOut stays put until the page is called again; it is then sent without a copy
+    uint32_t        cbUnacked;                      // externalUnacked() when WRITEBUFFER last looked; when it goes down the client is ACKing and the write is not idle
 
     union
     {
@@ -150,7 +166,7 @@ void ServerSetup(void);
 void ProcessServer(void);
 
 // HTTP helper functions
-uint32_t BuildHTTPOKStr(bool fNoCache, uint32_t cbContentLen, const char * szFile, char * szHTTPOKStr, uint32_t cbHTTPOK);
+uint32_t BuildHTTPOKStr(bool fNoCache, bool fKeepAlive, uint32_t cbContentLen, const char * szFile, char * szHTTPOKStr, uint32_t cbHTTPOK);
 
 // Generic Helper functions
 int GetDayAndTime(unsigned int epochTimeT, char * szDateTime);
@@ -44,6 +44,11 @@
 /************************************************************************/
 /*  Revision History:                                                   */
 /*    2/1/2013(KeithV): Created                                         */
+/*    10/19/2026(KeithV): HTTP/1.1 keep-alive                           */
+/*    10/19/2026(KeithV): Index request lines in place, no copying      */
+/*    10/19/2026(KeithV): Send pinned output straight from pbOut        */
+/*    10/19/2026(KeithV): Keep pipelined requests across keep-alive     */
+/*    10/19/2026(KeithV): Push connections skip the idle timeout        */
 /************************************************************************/
 #include <OpenScope.h>
 
@@ -68,6 +73,7 @@ typedef enum
     DISPLAYTIME,
     PROCESSHTML,
     WRITEBUFFER,
+    KEEPALIVE,      // the response is out, wait for the next request on the same connection
     STOPCLIENT,     // any state after the connection is lost must be placed below here 
     EXIT,           // just finishing up the client processing
     RESTART,        // want to restart the server
@@ -108,13 +114,22 @@ GCMD::ACTION ProcessClient(CLIENTINFO * pClientInfo)
     GCMD::ACTION    action = GCMD::CONTINUE;
     IPSTATUS        status = ipsSuccess;
     uint32_t        tCur = SYSGetMilliSecond();
+    bool            fLineStart;
 
     // timeout occured, get out
-    if(pClientInfo->clientState != START && (tCur - pClientInfo->tStartClient)  >= (secClientTO * 1000))
+    // a push page may go any time between frames, it pings the client itself; but a write the client never ACKs still times out
+    if(pClientInfo->clientState != START && (!pClientInfo->fPush || pClientInfo->clientState == WRITEBUFFER) && (tCur - pClientInfo->tStartClient)  >= ((pClientInfo->fIdle ? secKeepAliveTO : secClientTO) * 1000))
     {
         Serial.print("Timeout on client: 0x");
         Serial.println((uint32_t) pClientInfo, 16);
         pClientInfo->nextClientState    =   EXIT;
+        pClientInfo->fKeepAlive         =   false;
+
+        // the socket may still be sending out of the page's buffer, drop the connection before the page lets go of it
+        if(pClientInfo->pTCPClient->externalUnacked() > 0)
+        {
+            pClientInfo->pTCPClient->close();
+        }
  
         // if no data came in at all, then just close the connection
         if(pClientInfo->cbRead == 0)
@@ -165,6 +180,7 @@ GCMD::ACTION ProcessClient(CLIENTINFO * pClientInfo)
                 {                        
                     pClientInfo->cbRead += pClientInfo->pTCPClient->readStream(&pClientInfo->rgbIn[pClientInfo->cbRead], sizeof(pClientInfo->rgbIn) - pClientInfo->cbRead);
                 }
+                pClientInfo->fIdle = false;
                 pClientInfo->clientState = pClientInfo->nextClientState;
             }
             break;
@@ -250,6 +266,9 @@ GCMD::ACTION ProcessClient(CLIENTINFO * pClientInfo)
 
         case PROCESSHTML:
 
+            // the page says with each write if pbOut is pinned
+            pClientInfo->fPinOut = false;
+
             // process the HTML page
             switch((action = pClientInfo->ComposeHTMLPage(pClientInfo)))
             {
@@ -271,9 +290,10 @@ GCMD::ACTION ProcessClient(CLIENTINFO * pClientInfo)
                     break;
 
                 // Done processing the client, close the client and get out
+                // unless the whole response went out with a length, then wait for the next request
                 case GCMD::DONE:
                     pClientInfo->nextClientState    = EXIT;         // we are done!
-                    pClientInfo->clientState        = STOPCLIENT;
+                    pClientInfo->clientState        = pClientInfo->fKeepAlive ? KEEPALIVE : STOPCLIENT;
                     break;
 
                 case GCMD::RESTART:
@@ -309,74 +329,54 @@ GCMD::ACTION ProcessClient(CLIENTINFO * pClientInfo)
 
         case PARSENEXTLINE:
             {
-                uint32_t    i                   = 0;
-                bool        fFoundNewLine       = false;
-                bool        fNullTerminator     = false;
- 
-                // we are looking for either a /r/n or a /0.
-                // if we find the /r/n first, than replace the /r/n with /0 and that is our first line
-                // otherwise if we find the /0, go find the next /r/n
-                for(i = 0; i < pClientInfo->cbRead; i++)
+                uint8_t * pbEOL;
+
+                // put back the byte we borrowed to terminate an overlong line
+                if(pClientInfo->rgbOverflow[0] != '\0')
                 {
-                    if( (fFoundNewLine = pClientInfo->rgbIn[i] == '\n')  ||
-                        (fNullTerminator = pClientInfo->rgbIn[i] == '\0')                                   )
-                    {
-                         break;
-                    }
+                    pClientInfo->rgbIn[pClientInfo->cbParsed] = pClientInfo->rgbOverflow[0];
+                    pClientInfo->rgbOverflow[0] = '\0';
                 }
 
+                // lines are handed out where they sit in rgbIn, cbParsed moves past each one
+                pbEOL = (uint8_t *) memchr(&pClientInfo->rgbIn[pClientInfo->cbParsed], '\n', pClientInfo->cbRead - pClientInfo->cbParsed);
+
                 // found the line end, terminate it and return.
-                if(fFoundNewLine)
+                if(pbEOL != NULL)
                 {
-                    pClientInfo->rgbIn[i] = '\0';
-                    if(i > 0 && pClientInfo->rgbIn[i-1] == '\r')
+                    *pbEOL = '\0';
+                    if(pbEOL > &pClientInfo->rgbIn[pClientInfo->cbParsed] && pbEOL[-1] == '\r')
                     {
-                        pClientInfo->rgbIn[i-1] = '\0';
+                        pbEOL[-1] = '\0';
                     }
+                    pClientInfo->szLine     = (char *) &pClientInfo->rgbIn[pClientInfo->cbParsed];
+                    pClientInfo->cbParsed   = (pbEOL - pClientInfo->rgbIn) + 1;
+                    pClientInfo->fEndOfHdr |= (pClientInfo->szLine[0] == '\0');
                     pClientInfo->clientState = PROCESSHTML; 
                 }
 
-                else if(fNullTerminator)
-                {
-                    // go to beyond the \0
-                    for( ; i < pClientInfo->cbRead && pClientInfo->rgbIn[i] == '\0'; i++);
- 
-                    if(i == pClientInfo->cbRead)
-                    {
-                        // nothing left in the buffer to read, so we can reset it.
-                        pClientInfo->cbRead             = 0;
-                        pClientInfo->clientState        = READINPUT;
-                        pClientInfo->nextClientState    = PARSENEXTLINE;
-                        if(pClientInfo->rgbOverflow[0] != '\0')
-                        {
-                            pClientInfo->rgbIn[0] = pClientInfo->rgbOverflow[0];
-                            pClientInfo->rgbOverflow[0] = '\0';
-                            pClientInfo->cbRead = 1;
-                        }
-                    }
-
-                    // copy the end of the buffer to the front of the buffer
-                    // memcpy should be a safe overlapping copy.
-                    else
-                    {
-                        pClientInfo->cbRead -= i;
-                        memcpy(pClientInfo->rgbIn, &pClientInfo->rgbIn[i], pClientInfo->cbRead);
-                        // stay at this state to go find the end of line
-                    }
-                }
-
                 // this is a hard condition, our input buffer is full, and it doesn't even contain a full line.
-                else if(i == sizeof(pClientInfo->rgbIn))
+                else if(pClientInfo->cbParsed == 0 && pClientInfo->cbRead == sizeof(pClientInfo->rgbIn))
                 {
                     // save away the last byte and return it as a line, even though there is a line break.
                     pClientInfo->rgbOverflow[0] = pClientInfo->rgbIn[sizeof(pClientInfo->rgbIn)-1];
                     pClientInfo->rgbIn[sizeof(pClientInfo->rgbIn)-1] = '\0';
+                    pClientInfo->szLine     = (char *) pClientInfo->rgbIn;
+                    pClientInfo->cbParsed   = sizeof(pClientInfo->rgbIn)-1;
                     pClientInfo->clientState = PROCESSHTML; 
                 }
 
                 // we need to read more data.
                 else
                 {
+                    // only when we run out of room move the partial line to the front
+                    if(pClientInfo->cbRead == sizeof(pClientInfo->rgbIn))
+                    {
+                        pClientInfo->cbRead -= pClientInfo->cbParsed;
+                        memmove(pClientInfo->rgbIn, &pClientInfo->rgbIn[pClientInfo->cbParsed], pClientInfo->cbRead);
+                        pClientInfo->cbParsed = 0;
+                    }
+
                     pClientInfo->clientState        = READINPUT;
                     pClientInfo->nextClientState    = PARSENEXTLINE;
                 }
@@ -386,6 +386,20 @@ GCMD::ACTION ProcessClient(CLIENTINFO * pClientInfo)
 
         case WRITEBUFFER:
 
+            // the socket is sending straight out of pbOut, we can't give it back to the page until it is all ACKed
+            if(pClientInfo->pTCPClient->externalUnacked() > 0)
+            {
+                uint32_t cbUnacked = pClientInfo->pTCPClient->externalUnacked();
+
+                // as long as the ACKs keep coming the write is not idle
+                if(cbUnacked < pClientInfo->cbUnacked)
+                {
+                    pClientInfo->tStartClient = tCur;
+                }
+                pClientInfo->cbUnacked = cbUnacked;
+                break;
+            }
+
             // see if we are done
             if(pClientInfo->cbWritten == pClientInfo->cbWrite)
             {
@@ -394,8 +408,17 @@ GCMD::ACTION ProcessClient(CLIENTINFO * pClientInfo)
                 break;
             }
 
-            // otherwise we have data to write
-            pClientInfo->cbWritten += pClientInfo->pTCPClient->writeStream(&pClientInfo->pbOut[pClientInfo->cbWritten], pClientInfo->cbWrite - pClientInfo->cbWritten, &status);
+            // a big pinned buffer goes out without copying it into the socket
+            if(pClientInfo->fPinOut && (pClientInfo->cbWrite - pClientInfo->cbWritten) >= CBPINNEDWRITE)
+            {
+                pClientInfo->cbWritten += pClientInfo->pTCPClient->writeStreamExternal(&pClientInfo->pbOut[pClientInfo->cbWritten], pClientInfo->cbWrite - pClientInfo->cbWritten, &status);
+            }
+
+            // otherwise we copy what we can into the socket
+            else
+            {
+                pClientInfo->cbWritten += pClientInfo->pTCPClient->writeStream(&pClientInfo->pbOut[pClientInfo->cbWritten], pClientInfo->cbWrite - pClientInfo->cbWritten, &status);
+            }
 
             // got an error, terminate the connection
             if(IsIPStatusAnError(status))
@@ -404,8 +427,8 @@ GCMD::ACTION ProcessClient(CLIENTINFO * pClientInfo)
                 pClientInfo->nextClientState    = EXIT;
             }
 
-            // or we are done now after the write
-            else if(pClientInfo->cbWritten == pClientInfo->cbWrite)
+            // or we are done now after the write, and nothing is left to be ACKed out of pbOut
+            else if(pClientInfo->cbWritten == pClientInfo->cbWrite && pClientInfo->pTCPClient->externalUnacked() == 0)
             {
                 pClientInfo->clientState        = pClientInfo->nextClientState;
                 pClientInfo->nextClientState    = STOPCLIENT;
@@ -414,6 +437,75 @@ GCMD::ACTION ProcessClient(CLIENTINFO * pClientInfo)
             pClientInfo->tStartClient = tCur;
             break;
 
+        case KEEPALIVE:
+            Serial.print("Keeping connection for client: 0x");
+            Serial.println((uint32_t) pClientInfo, 16);
+
+            // the page cleans up just as if we closed
+            pClientInfo->htmlState = HTTPDISCONNECT;
+            pClientInfo->ComposeHTMLPage(pClientInfo);
+
+            // unless an overlong line was cut, cbParsed is at the start of a line
+            fLineStart = (pClientInfo->rgbOverflow[0] == '\0');
+
+            // put back the byte we borrowed to terminate an overlong line
+            if(pClientInfo->rgbOverflow[0] != '\0')
+            {
+                pClientInfo->rgbIn[pClientInfo->cbParsed] = pClientInfo->rgbOverflow[0];
+                pClientInfo->rgbOverflow[0] = '\0';
+            }
+
+            // if the page did not read the header, skip the rest of it
+            if(!pClientInfo->fEndOfHdr)
+            {
+                uint8_t const * pbEnd = &pClientInfo->rgbIn[pClientInfo->cbRead];
+                uint8_t const * pb    = &pClientInfo->rgbIn[pClientInfo->cbParsed];
+
+                // the \n before a line start was overwritten when that line was terminated, so the
+                // scan below can't see a blank line right here, as in a request with no header lines
+                if(fLineStart && pb < pbEnd && (*pb == '\n' || (pb + 1 < pbEnd && pb[0] == '\r' && pb[1] == '\n')))
+                {
+                    pClientInfo->cbParsed += (*pb == '\n') ? 1 : 2;
+                    pb = NULL;
+                }
+
+                for(; pb != NULL && pb < pbEnd; pb++)
+                {
+                    if(*pb == '\n' && ((pb + 1 < pbEnd && pb[1] == '\n') || (pb + 2 < pbEnd && pb[1] == '\r' && pb[2] == '\n')))
+                    {
+                        pClientInfo->cbParsed = (pb - pClientInfo->rgbIn) + ((pb[1] == '\n') ? 2 : 3);
+                        break;
+                    }
+                }
+
+                // the end of the header has not come in, we can't tell where the next request starts
+                if(pb == pbEnd)
+                {
+                    pClientInfo->nextClientState    =   EXIT;
+                    pClientInfo->clientState        =   STOPCLIENT;
+                    break;
+                }
+            }
+
+            // a pipelined request may already be in rgbIn after the one we answered, move it to the front
+            pClientInfo->cbRead -= pClientInfo->cbParsed;
+            memmove(pClientInfo->rgbIn, &pClientInfo->rgbIn[pClientInfo->cbParsed], pClientInfo->cbRead);
+
+            // and then start over on the same socket
+            pClientInfo->ComposeHTMLPage    =   NULL;
+            pClientInfo->pbOut              =   pClientInfo->rgbScratch;
+            pClientInfo->htmlState          =   HTTPSTART;
+            pClientInfo->cbParsed           =   0;
+            pClientInfo->cbWrite            =   0;
+            pClientInfo->cbWritten          =   0;
+            pClientInfo->fKeepAlive         =   false;
+            pClientInfo->fEndOfHdr          =   false;
+            pClientInfo->fIdle              =   (pClientInfo->cbRead == 0);
+            pClientInfo->tStartClient       =   tCur;
+            pClientInfo->clientState        =   (pClientInfo->cbRead == 0) ? READINPUT : WAITCMD;
+            pClientInfo->nextClientState    =   WAITCMD;
+            break;
+
          case STOPCLIENT:  
             Serial.print("Closing connection for client: 0x");
             Serial.println((uint32_t) pClientInfo, 16);
@@ -43,6 +43,7 @@
 /************************************************************************/
 /*  Revision History:                                                   */
 /*    2/1/2013(KeithV): Created                                         */
+/*    10/19/2026(KeithV): Client send options                           */
 /************************************************************************/
 #define INCLUDE_SERVER_DATA
 #include    <OpenScope.h>
@@ -637,6 +638,11 @@ void ProcessServer(void)
                     {                        
                         Serial.print("Got a client: 0x");
                         Serial.println((uint32_t) &rgClient[i], 16);
+
+                        // responses are written whole, so don't hold their tail back
+                        // and keep more of a big instrument read in flight
+                        rgClient[i].pTCPClient->setNoDelay(true);
+                        rgClient[i].pTCPClient->setSendWindow(CNTCLIENTSENDWINDOW);
  
                         // set the timer so if something bad happens with the client
                         // we won't hang, also we don't need to check errors on the client
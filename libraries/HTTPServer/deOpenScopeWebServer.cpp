@@ -12,6 +12,7 @@
 /*  Revision History:                                                   */
 /*                                                                      */
 /*    3/9/2017(KeithV): Created                                        */
+/*    10/19/2026(KeithV): Added the WebSocket push page                 */
 /************************************************************************/
 // if building in MPLABX we need to get all of
 // the variables need to be defined
@@ -36,12 +37,14 @@
 static const char szHTMLPostCmd[]       = "POST / ";
 static const char szHTMLOptions[]       = "OPTIONS / ";
 static const char szHTMLReboot[]        = "GET /Reboot ";
+static const char szHTMLWebSocket[]     = "GET /ws ";
 static const char szHTMLFavicon[]       = "GET /favicon.ico ";
 static const char szHTMLRedirect[]      = "GET /index.html ";
 
 // here is our sample/example dynamically created HTML page
 GCMD::ACTION ComposeHTMLPostCmd(CLIENTINFO * pClientInfo);
 GCMD::ACTION ComposeHTMLOptions(CLIENTINFO * pClientInfo);
+GCMD::ACTION ComposeHTMLWebSocket(CLIENTINFO * pClientInfo);
 GCMD::ACTION ComposeHTMLRedirectPage(CLIENTINFO * pClientInfo);
 
 // get rid of as much of the heap as we can, the SD library requires some heap
@@ -79,6 +82,9 @@ STATE HTTPSetup(void)
             // the Options page
             AddHTMLPage(szHTMLOptions,       ComposeHTMLOptions);
 
+            // WebSocket, pushes acquisitions and log samples as they come in
+            AddHTMLPage(szHTMLWebSocket,     ComposeHTMLWebSocket);
+
             // Redirects to Waveformslive page
             // AddHTMLPage(szHTMLRedirect,       ComposeHTMLRedirectPage);
 